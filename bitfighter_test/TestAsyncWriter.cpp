@@ -0,0 +1,175 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "tnlAsyncWriter.h"
+#include "tnlVector.h"
+
+#include <string>
+
+#ifndef TNL_OS_WIN32
+#  include <unistd.h>
+#  include <sys/wait.h>
+#endif
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+static const char *TestFile = "asyncwriter_test.tmp";
+
+
+static Vector<U8> readTestFile()
+{
+   Vector<U8> contents;
+
+   FILE *f = fopen(TestFile, "rb");
+   if(!f)
+      return contents;
+
+   U8 buf[1024];
+   size_t size;
+   while((size = fread(buf, 1, sizeof(buf), f)) > 0)
+      for(size_t i = 0; i < size; i++)
+         contents.push_back(buf[i]);
+
+   fclose(f);
+   remove(TestFile);
+   return contents;
+}
+
+
+TEST(AsyncWriterTest, GrowKeepsEverythingInOrder)
+{
+   Vector<U8> expected;
+
+   {
+      AsyncWriteStream stream(fopen(TestFile, "wb"), AsyncWriteStream::GrowWhenFull, 16, 64 * 1024);
+
+      // Uneven sizes, so writes wrap around the ring at odd places while it's growing
+      for(S32 i = 0; i < 2000; i++)
+      {
+         U8 data[37];
+         U32 size = i % 37 + 1;
+         for(U32 j = 0; j < size; j++)
+         {
+            data[j] = U8(i + j);
+            expected.push_back(data[j]);
+         }
+
+         ASSERT_TRUE(stream.write(data, size));
+      }
+
+      EXPECT_EQ(0, stream.getDroppedBytes());
+      EXPECT_LE(stream.getPeakQueuedBytes(), 64U * 1024);
+   }     // Destructor waits for the writer thread to finish
+
+   Vector<U8> contents = readTestFile();
+   ASSERT_EQ(expected.size(), contents.size());
+   for(S32 i = 0; i < expected.size(); i++)
+      ASSERT_EQ(expected[i], contents[i]);
+}
+
+
+TEST(AsyncWriterTest, WritesThatCanNeverFitAreDroppedWhole)
+{
+   U8 data[100];
+   for(U32 i = 0; i < sizeof(data); i++)
+      data[i] = U8(i);
+
+   {
+      AsyncWriteStream stream(fopen(TestFile, "wb"), AsyncWriteStream::BlockWhenFull, 64, 0, 10);
+
+      EXPECT_TRUE(stream.write(data, 10));
+      EXPECT_FALSE(stream.write(data, sizeof(data)));      // Bigger than the ring; no point waiting
+      EXPECT_TRUE(stream.write(data + 10, 10));
+
+      EXPECT_EQ(sizeof(data), stream.getDroppedBytes());
+   }
+
+   {
+      AsyncWriteStream stream(fopen(TestFile, "ab"), AsyncWriteStream::GrowWhenFull, 16, 64);
+      EXPECT_FALSE(stream.write(data, sizeof(data)));      // Past the most it may grow to
+      EXPECT_EQ(sizeof(data), stream.getDroppedBytes());
+   }
+
+   Vector<U8> contents = readTestFile();
+   ASSERT_EQ(20, contents.size());
+   for(S32 i = 0; i < contents.size(); i++)
+      EXPECT_EQ(i, contents[i]);
+}
+
+
+// Fatal error log lines rely on this to reach the disk before a crash can take them with it
+TEST(AsyncWriterTest, FlushWaitsUntilTheFileHasEverything)
+{
+   U8 data[100];
+   for(U32 i = 0; i < sizeof(data); i++)
+      data[i] = U8(i);
+
+   {
+      AsyncWriteStream stream(fopen(TestFile, "wb"), AsyncWriteStream::GrowWhenFull, 16, 1024);
+
+      for(S32 i = 0; i < 10; i++)
+         ASSERT_TRUE(stream.write(data, sizeof(data)));
+
+      EXPECT_TRUE(stream.flush());
+      EXPECT_EQ(0, stream.getQueuedBytes());
+
+      // Look while the stream is still open
+      FILE *f = fopen(TestFile, "rb");
+      ASSERT_TRUE(f != NULL);
+      fseek(f, 0, SEEK_END);
+      EXPECT_EQ(10 * sizeof(data), (size_t)ftell(f));
+      fclose(f);
+   }
+
+   EXPECT_EQ(10 * sizeof(data), (size_t)readTestFile().size());
+}
+
+
+#ifndef TNL_OS_WIN32
+
+// replaystats forks workers after the log is open.  A child only gets the thread that forked it, so the streams
+// have to be writing for themselves by then.
+TEST(AsyncWriterTest, StreamsKeepWorkingInAForkedChild)
+{
+   {
+      AsyncWriteStream stream(fopen(TestFile, "wb"), AsyncWriteStream::GrowWhenFull, 16, 1024);
+
+      ASSERT_TRUE(stream.write("one ", 4));
+      AsyncWriteStream::stopWriterThread();
+      EXPECT_EQ(0, stream.getQueuedBytes());
+
+      pid_t pid = fork();
+      if(pid == 0)
+      {
+         bool ok = stream.write("two ", 4) && stream.flush();
+         _exit(ok ? 0 : 1);
+      }
+
+      ASSERT_GT(pid, 0);
+
+      int status;
+      ASSERT_EQ(pid, waitpid(pid, &status, 0));
+      EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+      EXPECT_TRUE(stream.write("three", 5));
+   }
+
+   // New streams get a writer thread again
+   {
+      AsyncWriteStream stream(fopen(TestFile, "ab"), AsyncWriteStream::GrowWhenFull, 16, 1024);
+      EXPECT_TRUE(stream.write(" four", 5));
+   }
+
+   Vector<U8> contents = readTestFile();
+   EXPECT_EQ("one two three four", std::string(contents.address(), contents.address() + contents.size()));
+}
+
+#endif
+
+
+}
@@ -0,0 +1,48 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "Compression.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+TEST(CompressionTest, RoundTripThroughChunks)
+{
+   Vector<U8> data;
+   for(S32 i = 0; i < 50000; i++)
+      data.push_back(U8(i % 251));
+
+   Vector<U8> compressed;
+   ASSERT_TRUE(compressBuffer(data.address(), data.size(), compressed));
+   EXPECT_LT(compressed.size(), data.size());
+
+   // Chunks must each fit in a ByteBufferPtr RPC argument
+   Vector<ByteBufferPtr> chunks;
+   splitIntoChunks(compressed, chunks);
+   for(S32 i = 0; i < chunks.size(); i++)
+      EXPECT_LT(chunks[i]->getBufferSize(), 1024U);
+
+   Vector<U8> joined;
+   joinChunks(chunks, joined);
+   ASSERT_EQ(compressed.size(), joined.size());
+
+   Vector<U8> uncompressed;
+   ASSERT_TRUE(uncompressBuffer(joined.address(), joined.size(), data.size(), uncompressed));
+   ASSERT_EQ(data.size(), uncompressed.size());
+   for(S32 i = 0; i < data.size(); i++)
+      ASSERT_EQ(data[i], uncompressed[i]);
+
+   // Refuse anything that would be bigger than the caller allows
+   EXPECT_FALSE(uncompressBuffer(joined.address(), joined.size(), data.size() - 1, uncompressed));
+
+   // And anything that's been damaged
+   joined[joined.size() / 2] ^= 0xFF;
+   EXPECT_FALSE(uncompressBuffer(joined.address(), joined.size(), data.size(), uncompressed));
+}
+
+
+}
@@ -0,0 +1,304 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "dataConnection.h"
+#include "Md5Utils.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+// Stands in for a DataConnection, keeping whatever the sender says instead of sending it
+class TestDataConnection : public NetConnection, public DataSendable
+{
+public:
+   struct Chunk
+   {
+      U32 offset;
+      Vector<U8> data;
+   };
+
+   string checksum;
+   U32 size;
+   U32 compressedSize;
+   Vector<Chunk> chunks;
+
+   TestDataConnection()
+   {
+      size = 0;
+      compressedSize = 0;
+   }
+
+   void s2rBeginTransfer(U8 type, StringPtr checksum, U32 size, U32 compressedSize)
+   {
+      this->checksum = checksum.getString();
+      this->size = size;
+      this->compressedSize = compressedSize;
+   }
+
+   void s2rSendData(U32 offset, ByteBufferPtr data)
+   {
+      chunks.push_back(Chunk());
+      chunks.last().offset = offset;
+      chunks.last().data.resize(data->getBufferSize());
+      memcpy(chunks.last().data.address(), data->getBuffer(), data->getBufferSize());
+   }
+
+   void r2sAcknowledgeData(StringPtr checksum, U32 offset) { }
+
+   NetEvent *s2rBeginTransfer_construct(U8 type, StringPtr checksum, U32 size, U32 compressedSize) { return NULL; }
+   NetEvent *s2rSendData_construct(U32 offset, ByteBufferPtr data)                                 { return NULL; }
+   NetEvent *r2sAcknowledgeData_construct(StringPtr checksum, U32 offset)                          { return NULL; }
+
+   void s2rBeginTransfer_remote(U8 type, StringPtr checksum, U32 size, U32 compressedSize) { }
+   void s2rSendData_remote(U32 offset, ByteBufferPtr data)                                 { }
+   void r2sAcknowledgeData_remote(StringPtr checksum, U32 offset)                          { }
+
+   U32 getSentBytes()
+   {
+      U32 bytes = 0;
+      for(S32 i = 0; i < chunks.size(); i++)
+         bytes += chunks[i].data.size();
+
+      return bytes;
+   }
+};
+
+
+// Doesn't compress, so the transfer is bigger than the sender's window
+static Vector<U8> makeData(U32 size, U32 seed)
+{
+   Vector<U8> data;
+   for(U32 i = 0; i < size; i++)
+   {
+      seed = seed * 1103515245 + 12345;
+      data.push_back(U8(seed >> 16));
+   }
+
+   return data;
+}
+
+
+static bool deliver(DataReceiver &receiver, const TestDataConnection::Chunk &chunk)
+{
+   ByteBuffer buffer((U8 *)chunk.data.address(), chunk.data.size());
+   return receiver.addData(chunk.offset, buffer);
+}
+
+
+// Hands every chunk sent so far to the receiver, passing its acks back to the sender.  Returns true when the
+// sender says everything has arrived.
+static bool deliverAll(TestDataConnection &conn, DataSender &sender, DataReceiver &receiver)
+{
+   bool done = false;
+
+   for(S32 i = 0; i < conn.chunks.size(); i++)
+      if(deliver(receiver, conn.chunks[i]))
+         done = sender.acknowledge(&conn, receiver.getChecksum().c_str(), receiver.getReceivedSize());
+
+   conn.chunks.clear();
+   return done;
+}
+
+
+TEST(DataConnectionTest, WindowAdvancesWithAcks)
+{
+   Vector<U8> data = makeData(100 * 1024, 1);
+
+   TestDataConnection conn;
+   DataSender sender;
+   ASSERT_EQ(STATUS_OK, sender.initialize(&conn, data.address(), data.size(), LEVEL_TYPE));
+   EXPECT_EQ(data.size(), conn.size);
+   ASSERT_GT(conn.compressedSize, DataSender::MinWindowSize * 2);
+
+   // Nothing goes out until the receiver says where to start
+   sender.sendNextChunks();
+   EXPECT_EQ(0, conn.chunks.size());
+
+   DataReceiver receiver;
+   ASSERT_TRUE(receiver.begin(LEVEL_TYPE, conn.checksum, conn.size, conn.compressedSize, 256 * 1024));
+   EXPECT_EQ(0, receiver.getReceivedSize());
+   EXPECT_FALSE(sender.acknowledge(&conn, conn.checksum.c_str(), 0));
+
+   // One window's worth, then nothing more until some of it is acknowledged
+   sender.sendNextChunks();
+   U32 window = conn.getSentBytes();
+   EXPECT_GE(window, U32(DataSender::MinWindowSize));
+   EXPECT_LE(window, U32(DataSender::MaxWindowSize));
+   EXPECT_LT(window, conn.compressedSize);
+   EXPECT_EQ(0, conn.chunks[0].offset);
+
+   sender.sendNextChunks();
+   EXPECT_EQ(window, conn.getSentBytes());
+
+   // Receiver acks every AckInterval bytes, not every chunk
+   S32 acks = 0;
+   for(S32 i = 0; i < conn.chunks.size(); i++)
+      if(deliver(receiver, conn.chunks[i]))
+      {
+         acks++;
+         EXPECT_FALSE(sender.acknowledge(&conn, conn.checksum.c_str(), receiver.getReceivedSize()));
+      }
+
+   EXPECT_EQ(window / DataReceiver::AckInterval, acks);
+   EXPECT_NEAR(F32(window) / conn.compressedSize, sender.getProgress(), 0.1);
+   conn.chunks.clear();
+
+   // The acks open the window back up, and the rest follows
+   F32 progress = sender.getProgress();
+   bool done = false;
+   for(S32 i = 0; i < 100 && !done; i++)
+   {
+      sender.sendNextChunks();
+      ASSERT_GT(conn.chunks.size(), 0);
+      done = deliverAll(conn, sender, receiver);
+
+      EXPECT_TRUE(done || sender.getProgress() > progress);
+      progress = sender.getProgress();
+   }
+
+   ASSERT_TRUE(done);
+   EXPECT_TRUE(sender.isDone());
+
+   Vector<U8> received;
+   ASSERT_TRUE(receiver.finish(received));
+   ASSERT_EQ(data.size(), received.size());
+   EXPECT_EQ(0, memcmp(data.address(), received.address(), data.size()));
+}
+
+
+TEST(DataConnectionTest, IgnoresOutOfOrderAndDuplicateData)
+{
+   Vector<U8> data = makeData(8 * 1024, 2);
+
+   TestDataConnection conn;
+   DataSender sender;
+   ASSERT_EQ(STATUS_OK, sender.initialize(&conn, data.address(), data.size(), LEVEL_TYPE));
+   sender.acknowledge(&conn, conn.checksum.c_str(), 0);
+   sender.sendNextChunks();
+   ASSERT_GE(conn.chunks.size(), 3);
+
+   DataReceiver receiver;
+   ASSERT_TRUE(receiver.begin(LEVEL_TYPE, conn.checksum, conn.size, conn.compressedSize, 256 * 1024));
+
+   deliver(receiver, conn.chunks[0]);
+   U32 received = receiver.getReceivedSize();
+   EXPECT_EQ(conn.chunks[0].data.size(), received);
+
+   // Skipping ahead, or going back over what we already have, changes nothing
+   EXPECT_FALSE(deliver(receiver, conn.chunks[2]));
+   EXPECT_EQ(received, receiver.getReceivedSize());
+   EXPECT_FALSE(deliver(receiver, conn.chunks[0]));
+   EXPECT_EQ(received, receiver.getReceivedSize());
+
+   // And the transfer carries on from where it was
+   for(S32 i = 1; i < conn.chunks.size(); i++)
+      deliver(receiver, conn.chunks[i]);
+
+   ASSERT_TRUE(receiver.isComplete());
+
+   // Once everything is acknowledged the sender is done, and stale acks are ignored
+   EXPECT_TRUE(sender.acknowledge(&conn, conn.checksum.c_str(), receiver.getReceivedSize()));
+   EXPECT_FALSE(sender.acknowledge(&conn, conn.checksum.c_str(), 0));
+
+   Vector<U8> result;
+   ASSERT_TRUE(receiver.finish(result));
+   EXPECT_EQ(data.size(), result.size());
+}
+
+
+TEST(DataConnectionTest, RejectsDataThatDoesNotMatchItsChecksum)
+{
+   Vector<U8> data = makeData(4 * 1024, 3);
+
+   TestDataConnection conn;
+   DataSender sender;
+   ASSERT_EQ(STATUS_OK, sender.initialize(&conn, data.address(), data.size(), LEVEL_TYPE));
+
+   // Acks for some other transfer are ignored
+   EXPECT_FALSE(sender.acknowledge(&conn, "0123456789abcdef0123456789abcdef", 0));
+   sender.sendNextChunks();
+   EXPECT_EQ(0, conn.chunks.size());
+
+   sender.acknowledge(&conn, conn.checksum.c_str(), 0);
+   sender.sendNextChunks();
+
+   // The receiver is told to expect something else
+   string wrongChecksum = Md5::getHashFromString("Something else");
+
+   DataReceiver receiver;
+   ASSERT_TRUE(receiver.begin(LEVEL_TYPE, wrongChecksum, conn.size, conn.compressedSize, 256 * 1024));
+
+   for(S32 i = 0; i < conn.chunks.size(); i++)
+      deliver(receiver, conn.chunks[i]);
+
+   ASSERT_TRUE(receiver.isComplete());
+
+   Vector<U8> result;
+   EXPECT_FALSE(receiver.finish(result));
+   EXPECT_EQ(0, result.size());
+   EXPECT_FALSE(receiver.isActive());
+}
+
+
+// The receiver goes away part way through; when the same data is offered again, only the rest is sent
+TEST(DataConnectionTest, ResumesPartialTransfer)
+{
+   Vector<U8> data = makeData(64 * 1024, 4);
+
+   TestDataConnection conn;
+   U32 receivedBeforeDrop;
+
+   {
+      DataSender sender;
+      ASSERT_EQ(STATUS_OK, sender.initialize(&conn, data.address(), data.size(), LEVEL_TYPE));
+
+      DataReceiver receiver;
+      ASSERT_TRUE(receiver.begin(LEVEL_TYPE, conn.checksum, conn.size, conn.compressedSize, 256 * 1024));
+      sender.acknowledge(&conn, conn.checksum.c_str(), receiver.getReceivedSize());
+      sender.sendNextChunks();
+
+      // Only half of the first window makes it
+      conn.chunks.resize(conn.chunks.size() / 2);
+      deliverAll(conn, sender, receiver);
+
+      receivedBeforeDrop = receiver.getReceivedSize();
+      ASSERT_GT(receivedBeforeDrop, 0);
+      ASSERT_LT(receivedBeforeDrop, conn.compressedSize);
+   }     // Connection drops, taking the receiver with it
+
+   DataSender sender;
+   ASSERT_EQ(STATUS_OK, sender.initialize(&conn, data.address(), data.size(), LEVEL_TYPE));
+
+   DataReceiver receiver;
+   ASSERT_TRUE(receiver.begin(LEVEL_TYPE, conn.checksum, conn.size, conn.compressedSize, 256 * 1024));
+   EXPECT_EQ(receivedBeforeDrop, receiver.getReceivedSize());
+
+   sender.acknowledge(&conn, conn.checksum.c_str(), receiver.getReceivedSize());
+   sender.sendNextChunks();
+   ASSERT_GT(conn.chunks.size(), 0);
+   EXPECT_EQ(receivedBeforeDrop, conn.chunks[0].offset);
+
+   U32 sent = 0;
+   bool done = false;
+   for(S32 i = 0; i < 100 && !done; i++)
+   {
+      sender.sendNextChunks();
+      sent += conn.getSentBytes();
+      done = deliverAll(conn, sender, receiver);
+   }
+
+   ASSERT_TRUE(done);
+   EXPECT_EQ(conn.compressedSize - receivedBeforeDrop, sent);
+
+   Vector<U8> result;
+   ASSERT_TRUE(receiver.finish(result));
+   ASSERT_EQ(data.size(), result.size());
+   EXPECT_EQ(0, memcmp(data.address(), result.address(), data.size()));
+}
+
+
+};
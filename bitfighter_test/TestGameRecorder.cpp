@@ -0,0 +1,258 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "GameRecorder.h"
+#include "GameRecorderPlayback.h"
+#include "ServerGame.h"
+#include "ClientGame.h"
+#include "Level.h"
+#include "moveObject.h"
+#include "stringUtils.h"
+#include "LevelFilesForTesting.h"
+
+#include "TestUtils.h"
+
+#include "gtest/gtest.h"
+
+namespace Zap
+{
+
+static const S32 ItemCount = 6;
+static const U32 RecordingLength = 35000;     // Long enough for a few keyframes
+static const U32 PlaybackStep = 100;
+
+
+// Records a game with some items that change direction every couple of seconds, so playing any part of it back
+// depends on updates from that part.  Returns the recording's path.
+static string recordGame(GamePair &gamePair)
+{
+   Vector<DatabaseObject *> items;
+   gamePair.server->getLevel()->findObjects(ResourceItemTypeNumber, items);
+   EXPECT_EQ(ItemCount, items.size());
+
+   GameRecorderServer *recorder = new GameRecorderServer(gamePair.server);
+   string filename = joindir(gamePair.server->getSettings()->getFolderManager()->getRecordDir(), recorder->mFileName);
+
+   for(U32 time = 0; time < RecordingLength; time += 10)
+   {
+      if(time % 2000 == 0)
+         for(S32 i = 0; i < items.size(); i++)
+            static_cast<MoveItem *>(items[i])->setActualVel(Point((time / 2000 + i) % 2 ? 50 : -50, 0));
+
+      gamePair.idle(10);
+      recorder->idle(10);
+   }
+
+   delete recorder;     // Writes the index and closes the file
+
+   return filename;
+}
+
+
+static string getLevelCode()
+{
+   string code = "Spawn 0 -500 -500\n";
+   for(S32 i = 0; i < ItemCount; i++)
+      code += "ResourceItem " + itos(i * 10) + " " + itos(i * 100) + "\n";
+
+   return getLevelCodeForItemPropagationTests(code);
+}
+
+
+static S32 QSORT_CALLBACK sortByY(Point *a, Point *b)
+{
+   return a->y < b->y ? -1 : (a->y > b->y ? 1 : 0);
+}
+
+
+// The items only move along x, so sorting on y lines them up with the same items elsewhere
+static Vector<Point> getItemPositions(ClientGame *game)
+{
+   Vector<DatabaseObject *> items;
+   game->getLevel()->findObjects(ResourceItemTypeNumber, items);
+
+   Vector<Point> positions;
+   for(S32 i = 0; i < items.size(); i++)
+      positions.push_back(static_cast<MoveItem *>(items[i])->getActualPos());
+
+   positions.sort(sortByY);
+   return positions;
+}
+
+
+static void expectSamePositions(const Vector<Point> &expected, const Vector<Point> &actual)
+{
+   ASSERT_EQ(expected.size(), actual.size());
+
+   for(S32 i = 0; i < expected.size(); i++)
+   {
+      EXPECT_NEAR(expected[i].x, actual[i].x, 1) << "Item " << i;
+      EXPECT_NEAR(expected[i].y, actual[i].y, 1) << "Item " << i;
+   }
+}
+
+
+static GameRecorderPlayback *startPlayback(ClientGame *game, const string &filename)
+{
+   GameRecorderPlayback *playback = new GameRecorderPlayback(game, filename.c_str());
+   game->setConnectionToServer(playback);     // The game deletes it
+
+   return playback;
+}
+
+
+// Copies the first size bytes of a file, returning the copy's name
+static string copyStart(const string &filename, U32 size)
+{
+   string copy = filename + ".part";
+
+   FILE *in = fopen(filename.c_str(), "rb");
+   FILE *out = fopen(copy.c_str(), "wb");
+
+   Vector<U8> data;
+   data.resize(size);
+   EXPECT_EQ(size, fread(data.address(), 1, size, in));
+   fwrite(data.address(), 1, size, out);
+
+   fclose(in);
+   fclose(out);
+
+   return copy;
+}
+
+
+static U32 getFileSize(const string &filename)
+{
+   FILE *f = fopen(filename.c_str(), "rb");
+   fseek(f, 0, SEEK_END);
+   U32 size = ftell(f);
+   fclose(f);
+
+   return size;
+}
+
+
+// Jumping forward over a keyframe, and back to an earlier one, should leave things as they'd be if we'd played
+// straight through to the same spot
+TEST(GameRecorderTest, SeekingMatchesStraightPlayback)
+{
+   GamePair gamePair(getLevelCode(), 1);
+   string filename = recordGame(gamePair);
+
+   ClientGame *straightGame = newClientGame();
+   GameRecorderPlayback *straight = startPlayback(straightGame, filename);
+   ASSERT_TRUE(straight->isValid());
+
+   ASSERT_GE(straight->mBlockOffsets.size(), 3) << "Expected a keyframe every " << GameRecorderServer::KeyframeInterval << "ms";
+   EXPECT_NEAR(RecordingLength, straight->mTotalTime, 1000);
+
+   // Times a little way into the second and third blocks
+   U32 earlyTime = (straight->mBlockStartTimes[1] / PlaybackStep + 5) * PlaybackStep;
+   U32 lateTime  = (straight->mBlockStartTimes[2] / PlaybackStep + 5) * PlaybackStep;
+
+   Vector<Point> early, late;
+   for(U32 time = PlaybackStep; time <= lateTime; time += PlaybackStep)
+   {
+      straight->processMoreData(PlaybackStep);
+
+      if(time == earlyTime)
+         early = getItemPositions(straightGame);
+      if(time == lateTime)
+         late = getItemPositions(straightGame);
+   }
+
+   ASSERT_EQ(ItemCount, early.size());
+   ASSERT_EQ(1, straightGame->getClientInfos()->size());
+
+   ClientGame *seekGame = newClientGame();
+   GameRecorderPlayback *seeker = startPlayback(seekGame, filename);
+   seeker->processMoreData(PlaybackStep);
+
+   // Forward, past the second block's keyframe and into the third block
+   seeker->seek(lateTime);
+   EXPECT_EQ(2, seeker->mCurrentBlock);
+   {
+      SCOPED_TRACE("Seeking forward");
+      expectSamePositions(late, getItemPositions(seekGame));
+   }
+
+   // Players come back from the keyframe's events
+   EXPECT_EQ(straightGame->getClientInfos()->size(), seekGame->getClientInfos()->size());
+
+   // And back again
+   seeker->seek(earlyTime);
+   EXPECT_EQ(1, seeker->mCurrentBlock);
+   {
+      SCOPED_TRACE("Seeking back");
+      expectSamePositions(early, getItemPositions(seekGame));
+   }
+   EXPECT_EQ(straightGame->getClientInfos()->size(), seekGame->getClientInfos()->size());
+
+   delete seekGame;
+   delete straightGame;
+   remove(filename.c_str());
+}
+
+
+// A recording cut off before its index was written can still be played and seeked; the blocks are found by
+// walking through the file, and one that didn't get finished is left out
+TEST(GameRecorderTest, PlaysWithoutIndex)
+{
+   GamePair gamePair(getLevelCode(), 1);
+   string filename = recordGame(gamePair);
+
+   ClientGame *indexedGame = newClientGame();
+   GameRecorderPlayback *indexed = startPlayback(indexedGame, filename);
+   ASSERT_TRUE(indexed->isValid());
+   ASSERT_GE(indexed->mBlockOffsets.size(), 3);
+
+   S32 blocks = indexed->mBlockOffsets.size();
+   U32 indexStart = getFileSize(filename) - GameRecorderServer::IndexTrailerSize - blocks * GameRecorderServer::IndexEntrySize;
+
+   string noIndex = copyStart(filename, indexStart);
+
+   ClientGame *scannedGame = newClientGame();
+   GameRecorderPlayback *scanned = startPlayback(scannedGame, noIndex);
+   ASSERT_TRUE(scanned->isValid());
+
+   ASSERT_EQ(blocks, scanned->mBlockOffsets.size());
+   for(S32 i = 0; i < blocks; i++)
+   {
+      EXPECT_EQ(indexed->mBlockOffsets[i], scanned->mBlockOffsets[i]);
+      EXPECT_EQ(indexed->mBlockStartTimes[i], scanned->mBlockStartTimes[i]);
+   }
+   EXPECT_EQ(indexed->mTotalTime, scanned->mTotalTime);
+
+   U32 time = indexed->mBlockStartTimes[blocks - 1] + 1000;
+
+   indexed->processMoreData(PlaybackStep);
+   indexed->seek(time);
+   scanned->processMoreData(PlaybackStep);
+   scanned->seek(time);
+
+   EXPECT_EQ(blocks - 1, scanned->mCurrentBlock);
+   expectSamePositions(getItemPositions(indexedGame), getItemPositions(scannedGame));
+
+   delete scannedGame;
+   remove(noIndex.c_str());
+
+   // Now stop part way through the last block
+   string cutOff = copyStart(filename, indexed->mBlockOffsets[blocks - 1] + GameRecorderServer::BlockHeaderSize + 10);
+
+   scannedGame = newClientGame();
+   scanned = startPlayback(scannedGame, cutOff);
+   ASSERT_TRUE(scanned->isValid());
+   EXPECT_EQ(blocks - 1, scanned->mBlockOffsets.size());
+   EXPECT_EQ(indexed->mBlockStartTimes[blocks - 1], scanned->mTotalTime);
+
+   delete scannedGame;
+   remove(cutOff.c_str());
+
+   delete indexedGame;
+   remove(filename.c_str());
+}
+
+
+};
@@ -7,9 +7,12 @@
 #include "gameType.h"
 #include "ServerGame.h"
 #include "Level.h"
+#include "LevelCache.h"
 #include "GameManager.h"
 #include "WallItem.h"
 #include "EngineeredItem.h"
+#include "Md5Utils.h"
+#include "stringUtils.h"
 
 
 #include "TestUtils.h"
@@ -17,6 +20,15 @@
 
 #include "gtest/gtest.h"
 
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef TNL_OS_WIN32
+#  include <direct.h>
+#else
+#  include <unistd.h>
+#endif
+
 namespace Zap
 {
 
@@ -105,6 +117,187 @@ TEST(LevelLoaderTest, EngineeredItemMounting2)
          TNLAssert(false, "Bad id!");
    }
 };
+
+
+// Loading a level a few lines at a time should give the same result as loading it all at once
+TEST(LevelLoaderTest, IncrementalLoading)
+{
+   string code = getLevelCodeForEngineeredItemSnapping2();
+
+   Level level(code);
+
+   Level piecewise;
+   size_t pos = 0;
+   Md5::IncrementalHasher md5;
+
+   while(!piecewise.parseLevelLines(code, "", pos, 1, md5))
+      { /* Do nothing */ }
+
+   // As LevelPreloader does it, with the hash worked out separately
+   LevelCache noCache;
+   piecewise.finishWalls(Level::computeHash(code), noCache);
+   piecewise.finishItems();
+
+   EXPECT_EQ(md5.getHash(), piecewise.getHash());
+   EXPECT_EQ(level.getHash(), piecewise.getHash());
+   EXPECT_EQ(level.findObjects_fast()->size(), piecewise.findObjects_fast()->size());
+
+   Vector<DatabaseObject *> turrets;
+   piecewise.findObjects(TurretTypeNumber, turrets);
+   ASSERT_EQ(2, turrets.size());
+   EXPECT_FLOAT_EQ(-128, turrets[0]->getPos().x) << "Turret did not mount!";
+}
+
+
+// Points the LevelCache at a scratch folder in the system temp dir, and cleans it up afterwards, even if the test fails
+class LevelCacheTest : public testing::Test
+{
+protected:
+   string mCacheDir;
+
+   virtual void SetUp()
+   {
+      const char *tempDir = getenv("TMPDIR");
+      if(!tempDir)
+         tempDir = getenv("TEMP");
+
+      mCacheDir = joindir(tempDir ? tempDir : ".", "bitfighter_levelcache_test");
+
+      LevelCache::setCacheDir(mCacheDir);
+      ASSERT_TRUE(LevelCache::isEnabled());
+   }
+
+   virtual void TearDown()
+   {
+      LevelCache::setCacheDir("");
+
+      Vector<string> files;
+      getFilesFromFolder(mCacheDir, files);
+
+      for(S32 i = 0; i < files.size(); i++)
+         remove(joindir(mCacheDir, files[i]).c_str());
+
+#ifdef TNL_OS_WIN32
+      _rmdir(mCacheDir.c_str());
+#else
+      rmdir(mCacheDir.c_str());
+#endif
+   }
+};
+
+
+TEST_F(LevelCacheTest, RoundTrip)
+{
+   Vector<Point> edges;
+   edges.push_back(Point(0, 0));
+   edges.push_back(Point(100, 0.5));
+
+   LevelCache cache;
+   cache.setWallEdges(edges);
+
+   cache.zones.resize(2);
+   cache.zones[0].verts.push_back(Point(0, 0));
+   cache.zones[0].verts.push_back(Point(10, 0));
+   cache.zones[0].verts.push_back(Point(10, 10));
+
+   NeighboringZone neighbor;
+   neighbor.zoneID = 1;
+   neighbor.borderEnd.set(10, 10);
+   neighbor.distTo = 12.5f;
+   cache.zones[0].neighbors.push_back(neighbor);
+   cache.hasZones = true;
+
+   EXPECT_TRUE(cache.write("0123456789abcdef0123456789abcdef"));
+
+   LevelCache loaded;
+   ASSERT_TRUE(loaded.read("0123456789abcdef0123456789abcdef"));
+   EXPECT_FALSE(loaded.read("fedcba9876543210fedcba9876543210"));     // No file for that hash
+   ASSERT_TRUE(loaded.read("0123456789abcdef0123456789abcdef"));
+
+   ASSERT_TRUE(loaded.hasWallEdges);
+   ASSERT_EQ(2, loaded.wallEdgePoints.size());
+   EXPECT_FLOAT_EQ(0.5, loaded.wallEdgePoints[1].y);
+
+   ASSERT_TRUE(loaded.hasZones);
+   ASSERT_EQ(2, loaded.zones.size());
+   EXPECT_EQ(3, loaded.zones[0].verts.size());
+   EXPECT_EQ(0, loaded.zones[1].verts.size());
+   ASSERT_EQ(1, loaded.zones[0].neighbors.size());
+   EXPECT_EQ(1, loaded.zones[0].neighbors[0].zoneID);
+   EXPECT_FLOAT_EQ(10, loaded.zones[0].neighbors[0].borderEnd.y);
+   EXPECT_FLOAT_EQ(12.5, loaded.zones[0].neighbors[0].distTo);
+}
+
+
+// A damaged file could send bots off the end of the zone list
+TEST_F(LevelCacheTest, RejectsNeighborsOutsideTheZoneList)
+{
+   LevelCache cache;
+   cache.setWallEdges(Vector<Point>());      // Something has to be set for write() to bother
+
+   cache.zones.resize(2);
+
+   NeighboringZone neighbor;
+   neighbor.zoneID = 2;
+   cache.zones[1].neighbors.push_back(neighbor);
+   cache.hasZones = true;
+
+   EXPECT_TRUE(cache.write("0123456789abcdef0123456789abcdef"));
+
+   LevelCache loaded;
+   EXPECT_FALSE(loaded.read("0123456789abcdef0123456789abcdef"));
+   EXPECT_FALSE(loaded.hasZones);
+   EXPECT_EQ(0, loaded.zones.size());
+}
+
+
+// The client's hashes come from the server, and go into a file name
+TEST_F(LevelCacheTest, OnlyAcceptsMd5Hashes)
+{
+   EXPECT_TRUE(LevelCache::isValidHash("0123456789abcdefABCDEF0123456789"));
+
+   EXPECT_FALSE(LevelCache::isValidHash(""));
+   EXPECT_FALSE(LevelCache::isValidHash("0123456789abcdef"));
+   EXPECT_FALSE(LevelCache::isValidHash("0123456789abcdef0123456789abcdef0"));
+   EXPECT_FALSE(LevelCache::isValidHash("../../../../../../../../etc/pass"));
+   EXPECT_FALSE(LevelCache::isValidHash("0123456789abcdef0123456789abcdeg"));
+
+   LevelCache cache;
+   cache.setWallGeometry(Vector<U8>());
+   EXPECT_FALSE(cache.write("../0123456789abcdef0123456789abc"));
+   EXPECT_FALSE(cache.read("../0123456789abcdef0123456789abc"));
+}
+
+
+TEST_F(LevelCacheTest, LoadingUsesCachedEdges)
+{
+   string levelCode = getGenericHeader() + "BarrierMaker 50 0 0 1 0\n";
+
+   Level level;
+   level.loadLevelFromString(levelCode);
+
+   Vector<Point> builtEdges;
+   level.getWallEdgeGeometry(builtEdges);
+   ASSERT_TRUE(builtEdges.size() > 0);
+
+   // Stash some made-up edges under the level's hash; loading it again should use them instead of clipping the walls
+   Vector<Point> cachedEdges;
+   cachedEdges.push_back(Point(1, 2));
+   cachedEdges.push_back(Point(3, 4));
+
+   LevelCache cache;
+   cache.setWallEdges(cachedEdges);
+   ASSERT_TRUE(cache.write(level.getHash()));
+
+   Level reloaded;
+   reloaded.loadLevelFromString(levelCode);
+
+   Vector<Point> edges;
+   reloaded.getWallEdgeGeometry(edges);
+   ASSERT_EQ(2, edges.size());
+   EXPECT_EQ(Point(1, 2), edges[0]);
+   EXPECT_EQ(Point(3, 4), edges[1]);
+}
    
 }     // namespace
 
@@ -5,10 +5,13 @@
 
 #include "TestUtils.h"
 
+#include "EventManager.h"
 #include "ServerGame.h"
 #include "gameType.h"
 #include "Level.h"
 #include "luaLevelGenerator.h"
+#include "LuaModule.h"
+#include "robot.h"
 #include "SystemFunctions.h"
 
 #include "gtest/gtest.h"
@@ -162,4 +165,279 @@ TEST_F(LuaEnvironmentTest, findAllObjects)
 }
 
 
+TEST_F(LuaEnvironmentTest, addItems)
+{
+   EXPECT_TRUE(levelgen->runString("items = { ResourceItem.new(), ResourceItem.new(point.new(100, 0)), WallItem.new() }"));
+   EXPECT_TRUE(levelgen->runString("items[3]:setGeom({ point.new(0, 0), point.new(200, 0) })"));
+   EXPECT_TRUE(levelgen->runString("bf:addItems(items)"));
+
+   EXPECT_TRUE(levelgen->runString("assert(#bf:findAllObjects(ObjType.ResourceItem) == 2)"));
+   EXPECT_TRUE(levelgen->runString("assert(#bf:findAllObjects(ObjType.WallItem) == 1)"));
+}
+
+
+
+// Points returned from C++ should be indistinguishable from point.new() points
+TEST_F(LuaEnvironmentTest, nativePoints)
+{
+   EXPECT_TRUE(levelgen->runString("item = ResourceItem.new(point.new(30, 40))"));
+   EXPECT_TRUE(levelgen->runString("p = item:getPos()"));
+
+   EXPECT_TRUE(levelgen->runString("assert(type(p) == 'point')"));
+   EXPECT_TRUE(levelgen->runString("assert(p.x == 30 and p.y == 40)"));
+   EXPECT_TRUE(levelgen->runString("assert(point.length(p) == 50)"));
+   EXPECT_TRUE(levelgen->runString("q = p + point.new(1, 2); assert(q.x == 31 and q.y == 42)"));
+   EXPECT_TRUE(levelgen->runString("q = p * 2; assert(type(q) == 'point' and q.x == 60)"));
+   EXPECT_TRUE(levelgen->runString("assert(tostring(p) == tostring(point.new(30, 40)))"));
+}
+
+
+// How luaPushPoint used to make points, for comparison
+static void pushPointThroughGlobals(lua_State *L, F32 x, F32 y)
+{
+   lua_getglobal(L, "point");
+   lua_getfield(L, -1, "new");
+   lua_pushnumber(L, x);
+   lua_pushnumber(L, y);
+   lua_call(L, 2, 1);
+   lua_remove(L, -2);
+}
+
+
+typedef void (*PushPointFunction)(lua_State *L, F32 x, F32 y);
+
+// Best of a few runs, to keep other things the machine is doing out of it
+static F64 timePushingPoints(lua_State *L, PushPointFunction pushPoint, S32 count)
+{
+   F64 best = F32_MAX;
+
+   for(S32 run = 0; run < 5; run++)
+   {
+      lua_gc(L, LUA_GCCOLLECT, 0);
+      S64 start = Platform::getHighPrecisionTimerValue();
+
+      for(S32 i = 0; i < count; i++)
+      {
+         pushPoint(L, F32(i), F32(i));
+         lua_pop(L, 1);
+      }
+
+      best = min(best, Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start));
+   }
+
+   return best;
+}
+
+
+TEST_F(LuaEnvironmentTest, pushPointSkipsGlobalLookups)
+{
+   const S32 PointCount = 200000;
+
+   // Same kind of point either way
+   luaPushPoint(L, 3, 4);
+   pushPointThroughGlobals(L, 3, 4);
+   ASSERT_TRUE(lua_getmetatable(L, -1));
+   ASSERT_TRUE(lua_getmetatable(L, -3));
+   EXPECT_TRUE(lua_rawequal(L, -1, -2));
+   lua_pop(L, 4);
+
+   // Doesn't go looking for point.new, so it works even with the global gone
+   lua_getglobal(L, "point");
+   lua_pushnil(L);
+   lua_setglobal(L, "point");
+
+   luaPushPoint(L, 3, 4);
+   lua_getfield(L, -1, "x");
+   EXPECT_EQ(3, lua_tonumber(L, -1));
+   lua_pop(L, 2);
+
+   lua_setglobal(L, "point");
+
+   // And it's quicker
+   void (*pushPoint)(lua_State *, F32, F32) = luaPushPoint;
+
+   F64 throughGlobalsTime = timePushingPoints(L, pushPointThroughGlobals, PointCount);
+   F64 pushPointTime      = timePushingPoints(L, pushPoint,               PointCount);
+
+   EXPECT_LT(pushPointTime, throughGlobalsTime) << PointCount << " points took " << pushPointTime << "ms, " <<
+                                                   throughGlobalsTime << "ms looking up point.new each time";
+}
+
+
+// Events fired during a batch go to batch handlers in one call when the batch closes, and right away to everyone else
+TEST_F(LuaEnvironmentTest, batchedEvents)
+{
+   EXPECT_TRUE(levelgen->runString("batches = 0; count = 0"));
+   EXPECT_TRUE(levelgen->runString("function onMsgReceived(msg) count = count + 1 end"));
+   EXPECT_TRUE(levelgen->runString("function onMsgReceivedBatch(events) batches = batches + 1; count = count + #events; last = events[#events][1] end"));
+   EXPECT_TRUE(levelgen->runString("bf:subscribe(Event.MsgReceived)"));
+
+   LuaLevelGenerator *singleEventLevelgen = new LuaLevelGenerator(serverGame);
+   ASSERT_TRUE(singleEventLevelgen->prepareEnvironment());
+   EXPECT_TRUE(singleEventLevelgen->runString("count = 0; function onMsgReceived(msg) count = count + 1; last = msg end"));
+   EXPECT_TRUE(singleEventLevelgen->runString("bf:subscribe(Event.MsgReceived)"));
+
+   EventManager *eventManager = EventManager::get();
+   eventManager->update();    // Activate the subscriptions
+
+   eventManager->beginEventBatch();
+   eventManager->fireEvent(NULL, EventManager::MsgReceivedEvent, "one", NULL, true);
+   eventManager->fireEvent(NULL, EventManager::MsgReceivedEvent, "two", NULL, true);
+   eventManager->fireEvent(singleEventLevelgen, EventManager::MsgReceivedEvent, "three", NULL, true);
+
+   // The batch handler waits for the batch to close; the regular handler doesn't
+   EXPECT_TRUE(levelgen->runString("assert(count == 0)"));
+   EXPECT_TRUE(singleEventLevelgen->runString("assert(count == 2 and last == 'two')"));
+
+   eventManager->endEventBatch();
+
+   EXPECT_TRUE(levelgen->runString("assert(batches == 1 and count == 3 and last == 'three')"));
+   EXPECT_TRUE(singleEventLevelgen->runString("assert(count == 2 and last == 'two')"));   // Doesn't hear its own message
+
+   delete singleEventLevelgen;
+}
+
+
+// A script without batch handlers sees batchable and non-batchable events in the order they were fired
+TEST_F(LuaEnvironmentTest, batchedEventOrder)
+{
+   EXPECT_TRUE(levelgen->runString("log = { }"));
+   EXPECT_TRUE(levelgen->runString("function onMsgReceived(msg) table.insert(log, msg) end"));
+   EXPECT_TRUE(levelgen->runString("function onScoreChanged(score) table.insert(log, 'score ' .. score) end"));
+   EXPECT_TRUE(levelgen->runString("bf:subscribe(Event.MsgReceived); bf:subscribe(Event.ScoreChanged)"));
+
+   // Someone else batches, so the messages really are being queued
+   LuaLevelGenerator *batchLevelgen = new LuaLevelGenerator(serverGame);
+   ASSERT_TRUE(batchLevelgen->prepareEnvironment());
+   EXPECT_TRUE(batchLevelgen->runString("function onMsgReceived(msg) end"));
+   EXPECT_TRUE(batchLevelgen->runString("function onMsgReceivedBatch(events) seen = #events end"));
+   EXPECT_TRUE(batchLevelgen->runString("bf:subscribe(Event.MsgReceived)"));
+
+   EventManager *eventManager = EventManager::get();
+   eventManager->update();
+
+   eventManager->beginEventBatch();
+   eventManager->fireEvent(NULL, EventManager::MsgReceivedEvent, "one", NULL, true);
+   eventManager->fireEvent(EventManager::ScoreChangedEvent, 5, 0, NULL);
+   eventManager->fireEvent(NULL, EventManager::MsgReceivedEvent, "two", NULL, true);
+   eventManager->endEventBatch();
+
+   EXPECT_TRUE(levelgen->runString("assert(table.concat(log, ',') == 'one,score 5,two')"));
+   EXPECT_TRUE(batchLevelgen->runString("assert(seen == 2)"));
+
+   delete batchLevelgen;
+}
+
+
+// Args are rejected by their Lua type before any closer look, so make sure the masks let through everything
+// checkLuaArgs would
+TEST_F(LuaEnvironmentTest, argTypeMasks)
+{
+   EXPECT_TRUE(levelgen->runString("item = ResourceItem.new(point.new(0, 0))"));
+
+   EXPECT_TRUE(levelgen->runString("item:setId(12)"));
+   EXPECT_TRUE(levelgen->runString("item:setId('12')"));       // Numeric strings pass for numbers
+   EXPECT_FALSE(levelgen->runString("item:setId('twelve')"));
+   EXPECT_FALSE(levelgen->runString("item:setId(true)"));
+   EXPECT_FALSE(levelgen->runString("item:setId({ })"));
+
+   EXPECT_TRUE(levelgen->runString("item:setSelected(true)"));
+   EXPECT_FALSE(levelgen->runString("item:setSelected(1)"));
+
+   EXPECT_TRUE(levelgen->runString("item:setPos(point.new(10, 20))"));
+   EXPECT_FALSE(levelgen->runString("item:setPos(10)"));
+   EXPECT_FALSE(levelgen->runString("item:setPos(item)"));
+
+   // Points fall through to the second profile
+   EXPECT_TRUE(levelgen->runString("item:setGeom(point.new(30, 40))"));
+   EXPECT_TRUE(levelgen->runString("item:setGeom({ point.new(50, 60) })"));
+   EXPECT_TRUE(levelgen->runString("p = item:getPos(); assert(p.x == 50 and p.y == 60)"));
+   EXPECT_FALSE(levelgen->runString("item:setGeom('50, 60')"));
+}
+
+
+// A million binding calls' worth of arg checking, timed against finding the profile the way we used to
+TEST_F(LuaEnvironmentTest, argCheckSkipsProfileLookup)
+{
+   const S32 CallCount = 1000000;
+   S32 profiles = 0;    // Sum of the profile indexes returned, which should all be 0
+
+   // Class methods scanned their class's profile table with strcmp
+   S64 start = Platform::getHighPrecisionTimerValue();
+   for(S32 i = 0; i < CallCount; i++)
+   {
+      for(S32 j = 0; Robot::functionArgs[j].functionName != NULL; j++)
+         if(strcmp(Robot::functionArgs[j].functionName, "dropItem") == 0)
+         {
+            profiles += checkArgList(L, Robot::functionArgs[j].functionArgList, "Robot", "dropItem");
+            break;
+         }
+   }
+   F64 scanTime = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   start = Platform::getHighPrecisionTimerValue();
+   for(S32 i = 0; i < CallCount; i++)
+      profiles += checkArgList(L, Robot::functionArgs, "Robot", "dropItem");
+   F64 resolvedTime = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   EXPECT_LT(resolvedTime, scanTime) << CallCount << " calls took " << resolvedTime << "ms, " << scanTime << "ms scanning";
+
+   // Module functions copied the whole profile map, then searched it
+   lua_newtable(L);
+
+   start = Platform::getHighPrecisionTimerValue();
+   for(S32 i = 0; i < CallCount; i++)
+   {
+      ProfileMap profileMap = LuaModuleRegistrarBase::getModuleProfiles();
+      vector<LuaStaticFunctionProfile> &geomProfiles = profileMap.find("Geom")->second;
+
+      for(U32 j = 0; j < geomProfiles.size(); j++)
+         if(strcmp(geomProfiles[j].functionName, "triangulate") == 0)
+         {
+            profiles += checkArgList(L, geomProfiles[j].functionArgList, "Geom", "triangulate");
+            break;
+         }
+   }
+   scanTime = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   start = Platform::getHighPrecisionTimerValue();
+   for(S32 i = 0; i < CallCount; i++)
+      profiles += checkArgList(L, "Geom", "triangulate");
+   resolvedTime = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - start);
+
+   lua_pop(L, 1);
+
+   EXPECT_EQ(0, profiles);
+
+   EXPECT_LT(resolvedTime, scanTime) << CallCount << " module calls took " << resolvedTime << "ms, " <<
+                                     scanTime << "ms copying the profiles";
+}
+
+
+// Each batch handler gets its own tables, so one script can't change what the next one sees
+TEST_F(LuaEnvironmentTest, batchedEventsAreCopied)
+{
+   EXPECT_TRUE(levelgen->runString("function onMsgReceived(msg) end"));
+   EXPECT_TRUE(levelgen->runString("function onMsgReceivedBatch(events) events[1][1] = 'changed'; table.remove(events) end"));
+   EXPECT_TRUE(levelgen->runString("bf:subscribe(Event.MsgReceived)"));
+
+   LuaLevelGenerator *otherLevelgen = new LuaLevelGenerator(serverGame);
+   ASSERT_TRUE(otherLevelgen->prepareEnvironment());
+   EXPECT_TRUE(otherLevelgen->runString("function onMsgReceived(msg) end"));
+   EXPECT_TRUE(otherLevelgen->runString("function onMsgReceivedBatch(events) seen = #events; first = events[1][1] end"));
+   EXPECT_TRUE(otherLevelgen->runString("bf:subscribe(Event.MsgReceived)"));
+
+   EventManager *eventManager = EventManager::get();
+   eventManager->update();
+
+   eventManager->beginEventBatch();
+   eventManager->fireEvent(NULL, EventManager::MsgReceivedEvent, "one", NULL, true);
+   eventManager->fireEvent(NULL, EventManager::MsgReceivedEvent, "two", NULL, true);
+   eventManager->endEventBatch();
+
+   EXPECT_TRUE(otherLevelgen->runString("assert(seen == 2 and first == 'one')"));
+
+   delete otherLevelgen;
+}
+
 };
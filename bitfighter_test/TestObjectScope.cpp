@@ -13,6 +13,8 @@
 #include "ServerGame.h"
 #include "ClientGame.h"
 #include "Level.h"
+#include "gridDB.h"
+#include "moveObject.h"
 #include "LevelFilesForTesting.h"
 
 #include "Colors.h"
@@ -40,15 +42,15 @@ struct TestInfo {
 };
 
 
-TestInfo itemsToTestArr[] =
-{     //                                                                      start      item to red |item to blue|plyrs on red|plyrs on blue |neut. items |host. items 
-   {"RepairItem 0 76.5 20",                             RepairItemTypeNumber, {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1}},
-   {"TextItem 0 -127.5 0 127.5 0 57.845 \"Blue text\"", TextItemTypeNumber,   {1, 1, 0},   {1, 0, 1},   {1, 1, 0},   {1, 1, 1},   {1, 0, 0},   {1, 1, 1},   {1, 0, 0}},
-   {"LineItem 0 2 Global -127.5 229.5 0 153",           LineTypeNumber,       {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1}},   // Global -- visible on every team
-   {"LineItem 0 2 -127.5 229.5 0 153 127.5 204",        LineTypeNumber,       {1, 1, 0},   {1, 0, 1},   {1, 1, 0},   {1, 1, 1},   {1, 0, 0},   {1, 1, 1},   {1, 0, 0}},   // Not global -- visible to own team only
-   {"Zone 178.5 51 178.5 127.5 408 127.5 408 51",       ZoneTypeNumber,       {1, 0, 0},   {1, 0, 0},   {1, 0, 0},   {1, 0, 0},   {1, 0, 0},   {1, 0, 0},   {1, 0, 0}},
-   //{"Mine 0 5 5",                                       MineTypeNumber,       {1, 1, 0},   {1, 0, 1},   {1, 1, 0},   {1, 1, 1},   {1, 0, 0},   {1, 1, 1},   {1, 0, 0}},
-};
+TestInfo itemsToTestArr[] =
+{     //                                                                      start      item to red |item to blue|plyrs on red|plyrs on blue |neut. items |host. items 
+   {"RepairItem 0 76.5 20",                             RepairItemTypeNumber, {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1}},
+   {"TextItem 0 -127.5 0 127.5 0 57.845 \"Blue text\"", TextItemTypeNumber,   {1, 1, 0},   {1, 0, 1},   {1, 1, 0},   {1, 1, 1},   {1, 0, 0},   {1, 1, 1},   {1, 0, 0}},
+   {"LineItem 0 2 Global -127.5 229.5 0 153",           LineTypeNumber,       {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1},   {1, 1, 1}},   // Global -- visible on every team
+   {"LineItem 0 2 -127.5 229.5 0 153 127.5 204",        LineTypeNumber,       {1, 1, 0},   {1, 0, 1},   {1, 1, 0},   {1, 1, 1},   {1, 0, 0},   {1, 1, 1},   {1, 0, 0}},   // Not global -- visible to own team only
+   {"Zone 178.5 51 178.5 127.5 408 127.5 408 51",       ZoneTypeNumber,       {1, 0, 0},   {1, 0, 0},   {1, 0, 0},   {1, 0, 0},   {1, 0, 0},   {1, 0, 0},   {1, 0, 0}},
+   //{"Mine 0 5 5",                                       MineTypeNumber,       {1, 1, 0},   {1, 0, 1},   {1, 1, 0},   {1, 1, 1},   {1, 0, 0},   {1, 1, 1},   {1, 0, 0}},
+};
 
 
 void testObjectTransmission(S32 objTypeNumber, ServerGame *serverGame, S32 severCount,
@@ -208,4 +210,167 @@ TEST(ObjectScopeTest, TestItemPropagation)
 }
 
 
+// Objects far from the player's ship are sent with coarse positions while they move.  Once they stop, the client
+// needs the exact spot, or it will be wrong when the player gets close enough to see it.
+TEST(ObjectScopeTest, RestingObjectsAreSentExactly)
+{
+   // A neutral spy bug puts the item, which is way off screen, in scope
+   GamePair gamePair(getLevelCodeForItemPropagationTests("Spawn 0 0 0\nSpyBug -1 3000 0\nResourceItem 3003 3"), 1);
+   ClientGame *client = gamePair.getClient(0);
+   gamePair.idle(10, 5);
+
+   Vector<DatabaseObject *> fillVector;
+   gamePair.server->getLevel()->findObjects(ResourceItemTypeNumber, fillVector);
+   ASSERT_EQ(1, fillVector.size());
+   MoveItem *serverItem = static_cast<MoveItem *>(fillVector[0]);
+
+   serverItem->setActualVel(Point(117, 0));
+   gamePair.idle(10, 20);
+
+   serverItem->setActualVel(Point(0, 0));
+   gamePair.idle(10, 20);
+
+   fillVector.clear();
+   client->getLevel()->findObjects(ResourceItemTypeNumber, fillVector);
+   ASSERT_EQ(1, fillVector.size());
+   MoveItem *clientItem = static_cast<MoveItem *>(fillVector[0]);
+
+   EXPECT_NEAR(serverItem->getActualPos().x, clientItem->getActualPos().x, 0.5);
+   EXPECT_NEAR(serverItem->getActualPos().y, clientItem->getActualPos().y, 0.5);
+}
+
+
+// Same moving items, seen up close by one client and only through a spy bug by the other.  The near client gets
+// every update, with exact positions, which is what every client got before interest tiers; the far one should get
+// a good deal less.
+TEST(ObjectScopeTest, FarObjectsCostLessBandwidth)
+{
+   string items = "Spawn 0 0 0\nSpawn 1 3000 0\nSpyBug -1 3000 0\n";
+   for(S32 i = 0; i < 8; i++)
+      items += "ResourceItem " + itos(2900 + i * 25) + " " + itos(i * 20 - 80) + "\n";
+
+   GamePair gamePair(getLevelCodeForItemPropagationTests(items), 2);
+   ServerGame *serverGame = gamePair.server;
+   gamePair.idle(10, 10);
+
+   ASSERT_EQ(2, serverGame->getClientInfos()->size());
+   GameConnection *nearConn = serverGame->getClientInfos()->get(0)->getConnection();
+   GameConnection *farConn  = serverGame->getClientInfos()->get(1)->getConnection();
+   if(serverGame->getClientInfos()->get(0)->getTeamIndex() == 0)
+      swap(nearConn, farConn);
+
+   Vector<DatabaseObject *> fillVector;
+   serverGame->getLevel()->findObjects(ResourceItemTypeNumber, fillVector);
+   ASSERT_EQ(8, fillVector.size());
+
+   U32 nearStart = nearConn->mPacketSendBytesTotal;
+   U32 farStart  = farConn->mPacketSendBytesTotal;
+
+   // Keep the items changing direction, so they need an update every tick
+   for(S32 tick = 0; tick < 100; tick++)
+   {
+      for(S32 i = 0; i < fillVector.size(); i++)
+         static_cast<MoveItem *>(fillVector[i])->setActualVel(Point((i + tick) % 2 ? 40 : -40, (i + tick) % 3 ? 30 : -30));
+
+      gamePair.idle(10, 1);
+   }
+
+   MoveItem *item = static_cast<MoveItem *>(fillVector[0]);
+   ASSERT_EQ(BfObject::InterestNear, item->getInterestTier(nearConn));
+   ASSERT_EQ(BfObject::InterestFar,  item->getInterestTier(farConn));
+
+   U32 nearBytes = nearConn->mPacketSendBytesTotal - nearStart;
+   U32 farBytes  = farConn->mPacketSendBytesTotal  - farStart;
+
+   EXPECT_LT(farBytes, nearBytes / 2);
+}
+
+
+// Teammates share what the team can see: scope-always objects, spy bug views, and the commander's map.  That should
+// be gathered once per team each tick, not once per connection, and each connection should only need its own ship's
+// query on top.
+TEST(ObjectScopeTest, TeamScopeIsGatheredOncePerTick)
+{
+   string items = "Spawn 0 0 0\nSpawn 1 400 0\nSpyBug -1 200 1500\n";
+   for(S32 i = 0; i < 10; i++)
+      items += "ResourceItem " + itos(i * 40) + " " + itos(i % 2 ? 100 : 1500) + "\n";
+
+   const S32 Clients = 8;
+   GamePair gamePair(getLevelCodeForItemPropagationTests(items), Clients);
+   ServerGame *serverGame = gamePair.server;
+   GameType *gameType = serverGame->getGameType();
+   ASSERT_TRUE(gameType->isTeamGame());
+
+   for(S32 i = 0; i < Clients; i++)
+      gamePair.getClient(i)->setUsingCommandersMap(true);
+
+   gamePair.idle(10, 10);
+
+   ASSERT_EQ(Clients, serverGame->getClientInfos()->size());
+
+   Vector<GameConnection *> conns;
+   bool teamHasPlayers[2] = { false, false };
+   for(S32 i = 0; i < Clients; i++)
+   {
+      ClientInfo *clientInfo = serverGame->getClientInfos()->get(i);
+      GameConnection *conn = clientInfo->getConnection();
+
+      ASSERT_TRUE(conn->isReadyForRegularGhosts());
+      ASSERT_TRUE(conn->isInCommanderMap());
+      ASSERT_TRUE(clientInfo->getShip());
+      ASSERT_TRUE(clientInfo->getTeamIndex() == 0 || clientInfo->getTeamIndex() == 1);
+
+      teamHasPlayers[clientInfo->getTeamIndex()] = true;
+      conns.push_back(conn);
+   }
+
+   S32 teams = (teamHasPlayers[0] ? 1 : 0) + (teamHasPlayers[1] ? 1 : 0);
+
+   // Every connection, as in one tick.  The scope was last gathered during the idle above, so throw it away first.
+   for(S32 i = 0; i < gameType->mTeamScopes.size(); i++)
+      gameType->mTeamScopes[i].valid = false;
+
+   U32 start = GridDatabase::mQueryId;
+   for(S32 i = 0; i < conns.size(); i++)
+      gameType->performScopeQuery(conns[i]);
+
+   U32 sharedQueries = GridDatabase::mQueryId - start;
+
+   // What each connection would cost if it gathered the team's scope for itself
+   start = GridDatabase::mQueryId;
+   for(S32 i = 0; i < conns.size(); i++)
+   {
+      for(S32 j = 0; j < gameType->mTeamScopes.size(); j++)
+         gameType->mTeamScopes[j].valid = false;
+
+      gameType->performScopeQuery(conns[i]);
+   }
+
+   U32 unsharedQueries = GridDatabase::mQueryId - start;
+
+   // Own ship's view for each connection, plus the spy bug view and commander view for each team
+   EXPECT_EQ(U32(Clients + 2 * teams), sharedQueries);
+   EXPECT_EQ(U32(3 * Clients), unsharedQueries);
+
+   // The team's lists hold nothing twice, and nothing in both
+   for(S32 i = 0; i < gameType->mTeamScopes.size(); i++)
+   {
+      const GameType::TeamScope &teamScope = gameType->mTeamScopes[i];
+      ASSERT_TRUE(teamScope.commanderViewValid);
+      EXPECT_GT(teamScope.objects.size(), 0);
+      EXPECT_GT(teamScope.commanderView.size(), 0);
+
+      Vector<S32> serials;
+      for(S32 j = 0; j < teamScope.objects.size(); j++)
+         serials.push_back(teamScope.objects[j]->getSerialNumber());
+      for(S32 j = 0; j < teamScope.commanderView.size(); j++)
+         serials.push_back(teamScope.commanderView[j]->getSerialNumber());
+
+      for(S32 j = 0; j < serials.size(); j++)
+         for(S32 k = j + 1; k < serials.size(); k++)
+            EXPECT_NE(serials[j], serials[k]) << "Team " << i;
+   }
+}
+
+
 }; // namespace Zap
@@ -183,6 +183,47 @@ TEST_F(ObjectTest, GhostingSanity)
 
 
 
+/**
+ * Values coded against a baseline must come out the same whether they go as small deltas, large
+ * deltas, or whole, and the reader must end up holding the same baseline as the writer.
+ */
+TEST_F(ObjectTest, BaselineValueRoundTrip)
+{
+   const S32 values[] = { 0, 5, -20, 400, -400, 30000, -70000, 2000000000 };
+   const U8 deltaBits = 10;
+
+   U8 buffer[1024];
+   BitStream writeStream(buffer, sizeof(buffer));
+
+   GhostBaseline writeBaseline, readBaseline;
+   writeBaseline.set(0, 100);
+   readBaseline.set(0, 100);
+
+   // Each value is coded against the one before, in slot 0; slot 1 starts out empty, so it's always whole
+   for(U32 i = 0; i < ARRAYSIZE(values); i++)
+   {
+      BfObject::writeBaselineValue(&writeStream, writeBaseline, 0, values[i], deltaBits);
+      BfObject::writeBaselineValue(&writeStream, writeBaseline, 1, values[i], deltaBits);
+   }
+
+   BitStream readStream(buffer, writeStream.getBytePosition());
+   for(U32 i = 0; i < ARRAYSIZE(values); i++)
+   {
+      EXPECT_EQ(values[i], BfObject::readBaselineValue(&readStream, readBaseline, 0, deltaBits));
+      EXPECT_EQ(values[i], BfObject::readBaselineValue(&readStream, readBaseline, 1, deltaBits));
+   }
+
+   EXPECT_EQ(writeBaseline.validMask, readBaseline.validMask);
+   EXPECT_EQ(writeBaseline.values[0], readBaseline.values[0]);
+   EXPECT_EQ(writeBaseline.values[1], readBaseline.values[1]);
+
+   // Small changes cost well under the 17 bits a whole 16-bit value takes
+   BitStream smallStream(buffer, sizeof(buffer));
+   BfObject::writeBaselineValue(&smallStream, writeBaseline, 0, writeBaseline.values[0] + 3, deltaBits);
+   EXPECT_EQ(8, smallStream.getBitPosition());
+}
+
+
 /**
  * Test some LUA commands to all objects
  */
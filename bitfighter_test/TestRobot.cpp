@@ -8,6 +8,11 @@
 #include "../zap/ServerGame.h"
 #include "../zap/gameType.h"
 #include "../zap/luaLevelGenerator.h"
+#include "../zap/BotNavMeshZone.h"
+#include "../zap/robot.h"
+#include "../zap/moveObject.h"
+#include "../zap/Level.h"
+#include "../zap/stringUtils.h"
 #include "gtest/gtest.h"
 
 namespace Zap
@@ -60,6 +65,220 @@ TEST(RobotTest, luaRobotNew)
 }
 
 
+// Square zones, 100 wide, on a size x size grid, each linked to the ones beside it
+static void makeZoneGrid(S32 size, Vector<BotNavMeshZone *> &zones)
+{
+	for(S32 y = 0; y < size; y++)
+		for(S32 x = 0; x < size; x++)
+		{
+			BotNavMeshZone *zone = new BotNavMeshZone(y * size + x);
+			zone->disableTriangulation();
+
+			Vector<Point> verts;
+			verts.push_back(Point(x * 100,       y * 100));
+			verts.push_back(Point(x * 100 + 100, y * 100));
+			verts.push_back(Point(x * 100 + 100, y * 100 + 100));
+			verts.push_back(Point(x * 100,       y * 100 + 100));
+			zone->setGeometry(verts);
+
+			zones.push_back(zone);
+		}
+
+	const S32 dx[] = { 1, -1, 0, 0 };
+	const S32 dy[] = { 0, 0, 1, -1 };
+
+	for(S32 y = 0; y < size; y++)
+		for(S32 x = 0; x < size; x++)
+			for(S32 i = 0; i < 4; i++)
+			{
+				S32 nx = x + dx[i], ny = y + dy[i];
+				if(nx < 0 || ny < 0 || nx >= size || ny >= size)
+					continue;
+
+				NeighboringZone neighbor;
+				neighbor.zoneID = U16(ny * size + nx);
+				neighbor.center = zones[neighbor.zoneID]->getCenter();
+				neighbor.borderCenter = (zones[y * size + x]->getCenter() + neighbor.center) * 0.5f;
+				neighbor.distTo = 100;
+
+				zones[y * size + x]->mNeighbors.push_back(neighbor);
+			}
+}
+
+
+// Paths are the target, then a zone center and gateway per hop, then the start zone's center twice
+static S32 countHops(const Vector<Point> &path)
+{
+	return (path.size() - 3) / 2;
+}
+
+
+TEST(RobotTest, PathPlannerNextHopTable)
+{
+	Vector<BotNavMeshZone *> zones;
+	makeZoneGrid(10, zones);
+
+	AStar planner;
+	planner.prepare(&zones);
+	EXPECT_FALSE(planner.hasClusters());
+
+	// Planner searches until the table is built, a few rows per tick
+	EXPECT_FALSE(planner.buildNextHopTable(10));
+	Vector<Point> searched = planner.findPath(&zones, 0, 99, Point(950, 950));
+
+	while(!planner.buildNextHopTable(10))
+		continue;
+
+	Vector<Point> walked = planner.findPath(&zones, 0, 99, Point(950, 950));
+
+	EXPECT_EQ(18, countHops(searched));
+	EXPECT_EQ(18, countHops(walked));
+	EXPECT_EQ(searched[0], walked[0]);
+	EXPECT_EQ(searched.last(), walked.last());
+
+	zones.deleteAndClear();
+}
+
+
+TEST(RobotTest, PathPlannerClusters)
+{
+	Vector<BotNavMeshZone *> zones;
+	makeZoneGrid(40, zones);      // Too many zones for a table
+
+	AStar planner;
+	planner.prepare(&zones);
+	EXPECT_TRUE(planner.hasClusters());
+	EXPECT_FALSE(planner.buildNextHopTable());
+
+	// Searching the corridor should get us from corner to corner in not much more than the 78 hops it takes
+	Vector<Point> path = planner.findPath(&zones, 0, 1599, Point(3950, 3950));
+	ASSERT_TRUE(path.size() > 0);
+	EXPECT_GE(countHops(path), 78);
+	EXPECT_LE(countHops(path), 90);
+	EXPECT_EQ(zones[0]->getCenter(), path.last());
+
+	zones.deleteAndClear();
+}
+
+
+// Teammates share a snapshot of what they can see; it has to pick up objects added since it was taken, and can't
+// list anything twice just because several bots see it
+TEST(RobotTest, TeamVisibilitySnapshot)
+{
+	GamePair gamePair("GameType 10 8\nTeam Blue 0 0 1\nSpawn 0 0 0\n", 0);
+	ServerGame *server = gamePair.server;
+	Vector<string> args;
+
+	server->addBot(args, ClientInfo::ClassRobotAddedByAddbots);
+	server->addBot(args, ClientInfo::ClassRobotAddedByAddbots);
+	gamePair.idle(10, 5);
+
+	ASSERT_EQ(2, server->getBotCount());
+	Robot *bot = server->getBot(0);
+	ASSERT_EQ(bot->getTeam(), server->getBot(1)->getTeam());
+
+	Point pos = bot->getActualPos();
+	Rect queryRect(pos, pos);
+	queryRect.expand(server->computePlayerVisArea(bot));
+
+	ObjectTypeMask types;
+	types.set(RobotShipTypeNumber);
+	types.set(TestItemTypeNumber);
+
+	Vector<DatabaseObject *> found;
+	EXPECT_TRUE(server->findTeamVisibleObjects(bot, types, queryRect, found));
+	EXPECT_EQ(2, found.size());         // Both bots, once each
+
+	// Same tick, so only the new object tells the snapshot it's out of date
+	TestItem *item = new TestItem();
+	item->setPos(pos + Point(50, 0));
+	item->addToGame(server, server->getLevel());
+
+	found.clear();
+	EXPECT_TRUE(server->findTeamVisibleObjects(bot, types, queryRect, found));
+	EXPECT_EQ(3, found.size());
+	EXPECT_TRUE(found.contains(item));
+}
+
+
+// A team full of bots, each looking around a few times a tick, should cost one query per tick rather than one per
+// call, and get back what it would have found by asking the level itself
+TEST(RobotTest, TeamSnapshotQueriesOncePerTick)
+{
+	string code = "GameType 10 8\nTeam Blue 0 0 1\nSpawn 0 0 0\n";
+	for(S32 i = 0; i < 20; i++)
+		code += "TestItem " + itos(i * 40 - 400) + " " + itos((i % 5) * 60 - 120) + "\n";
+
+	GamePair gamePair(code, 0);
+	ServerGame *server = gamePair.server;
+	Vector<string> args;
+
+	const S32 BotCount = 8;
+	for(S32 i = 0; i < BotCount; i++)
+		server->addBot(args, ClientInfo::ClassRobotAddedByAddbots);
+	gamePair.idle(10, 5);
+	ASSERT_EQ(BotCount, server->getBotCount());
+
+	// What scripts commonly look for, one call each
+	const S32 LookCount = 3;
+	Vector<U8> lookTypes[LookCount];
+	ObjectTypeMask lookMasks[LookCount];
+	U8 typeNumbers[LookCount] = { RobotShipTypeNumber, TestItemTypeNumber, ResourceItemTypeNumber };
+
+	for(S32 i = 0; i < LookCount; i++)
+	{
+		lookTypes[i].push_back(typeNumbers[i]);
+		lookMasks[i].set(typeNumbers[i]);
+	}
+
+	for(S32 tick = 0; tick < 5; tick++)
+	{
+		gamePair.idle(10);
+
+		Vector<DatabaseObject *> fromSnapshot[BotCount][LookCount];
+		Vector<DatabaseObject *> fromLevel[BotCount][LookCount];
+
+		U32 queryId = GridDatabase::mQueryId;
+
+		for(S32 i = 0; i < BotCount; i++)
+		{
+			Robot *bot = server->getBot(i);
+			Point pos = bot->getActualPos();
+			Rect queryRect(pos, pos);
+			queryRect.expand(server->computePlayerVisArea(bot));
+
+			for(S32 j = 0; j < LookCount; j++)
+				ASSERT_TRUE(server->findTeamVisibleObjects(bot, lookMasks[j], queryRect, fromSnapshot[i][j]));
+		}
+
+		// The bots' own scripts may already have taken this tick's snapshot
+		EXPECT_LE(GridDatabase::mQueryId - queryId, U32(1));
+		queryId = GridDatabase::mQueryId;
+
+		for(S32 i = 0; i < BotCount; i++)
+		{
+			Robot *bot = server->getBot(i);
+			Point pos = bot->getActualPos();
+			Rect queryRect(pos, pos);
+			queryRect.expand(server->computePlayerVisArea(bot));
+
+			for(S32 j = 0; j < LookCount; j++)
+				server->getLevel()->findObjects(lookTypes[j], fromLevel[i][j], queryRect);
+		}
+
+		EXPECT_EQ(U32(BotCount * LookCount), GridDatabase::mQueryId - queryId);
+
+		for(S32 i = 0; i < BotCount; i++)
+			for(S32 j = 0; j < LookCount; j++)
+			{
+				ASSERT_EQ(fromLevel[i][j].size(), fromSnapshot[i][j].size()) << "Bot " << i << ", type " << S32(typeNumbers[j]);
+				for(S32 k = 0; k < fromLevel[i][j].size(); k++)
+					EXPECT_TRUE(fromSnapshot[i][j].contains(fromLevel[i][j][k]));
+			}
+	}
+}
+
+
 /** onShipSpawned doesn't fire?
 
 TEST(RobotTest, RemoveFromGameDuringInitialOnShipSpawn)
@@ -55,6 +55,38 @@ TEST(ServerGameTest, KillStreakTests)
 }
 
 
+TEST(ServerGameTest, StaggeredGhosting)
+{
+   GamePair gamePair("", 0);
+   ServerGame *game = gamePair.server;
+   GhostingScheduler *scheduler = game->getGhostingScheduler();
+
+   // Only let one client load the level at a time
+   scheduler->setLimits(GhostingScheduler::DefaultMaxLoadingBandwidth, 1);
+
+   gamePair.addClient("Alpha");
+   gamePair.addClient("Bravo");
+   gamePair.addClient("Charlie");
+
+   EXPECT_EQ(1, scheduler->getLoadingCount());
+   EXPECT_EQ(2, scheduler->getWaitingCount());
+
+   EXPECT_TRUE (game->findClientInfo("Alpha")  ->getConnection()->isGhosting());
+   EXPECT_FALSE(game->findClientInfo("Bravo")  ->getConnection()->isGhosting());
+   EXPECT_FALSE(game->findClientInfo("Charlie")->getConnection()->isGhosting());
+
+   // The others get their turn once Alpha has the level
+   for(S32 i = 0; i < 100 && scheduler->getWaitingCount() + scheduler->getLoadingCount() > 0; i++)
+      gamePair.idle(10);
+
+   EXPECT_EQ(0, scheduler->getWaitingCount());
+   EXPECT_EQ(0, scheduler->getLoadingCount());
+
+   EXPECT_TRUE(game->findClientInfo("Bravo")  ->getConnection()->isGhosting());
+   EXPECT_TRUE(game->findClientInfo("Charlie")->getConnection()->isGhosting());
+}
+
+
 TEST(ServerGameTest, LittleStory) 
 {
    // Use GamePair to our serverGame set up properly.  We don't care about clients here.
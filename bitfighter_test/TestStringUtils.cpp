@@ -266,4 +266,41 @@ TEST(StringUtilsTest, WrapStringsLineWidth)
 }
 
 
+
+// parseStringInPlace() is meant to be a drop-in replacement for parseString(), so they must agree on everything
+TEST(StringUtilsTest, parseStringInPlace)
+{
+   const char *lines[] = {
+      "",
+      "   ",
+      "Turret!5 0 1 2",
+      "  LevelName   \t My Level\r",
+      "LevelDescription \"A quoted description\" with \"words\"",
+      "Word \"unclosed quote runs to the end ",
+      "\" \"\" \"x\" \"\"y\"\" \"a b\"c d",
+      "Mid\"dle \"ab\"cd ef\"gh",
+   };
+
+   Vector<const char *> words;
+   Vector<char> buffer;
+
+   for(U32 i = 0; i < ARRAYSIZE(lines); i++)
+   {
+      SCOPED_TRACE(string("Line: ") + lines[i]);
+
+      Vector<string> expected = parseString(lines[i]);
+
+      S32 len = (S32)strlen(lines[i]);
+      buffer.resize(len + 1);
+      strcpy(buffer.address(), lines[i]);
+
+      parseStringInPlace(buffer.address(), len, words);
+
+      ASSERT_EQ(expected.size(), words.size());
+      for(S32 j = 0; j < words.size(); j++)
+         EXPECT_EQ(expected[j], words[j]);
+   }
+}
+
+
 };
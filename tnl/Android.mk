@@ -14,6 +14,7 @@ LOCAL_CFLAGS :=
 
 # Add your application source files here...
 LOCAL_SRC_FILES := assert.cpp \
+	asyncWriter.cpp \
 	asymmetricKey.cpp \
 	bitStream.cpp \
 	byteBuffer.cpp \
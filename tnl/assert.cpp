@@ -60,6 +60,7 @@ void Assert::processAssert(const char *filename, U32 lineNumber, const char  *me
 {
 
 	logprintf(TNL::LogConsumer::LogError, "Assert: %s in %s line %u", message, filename, lineNumber);
+   LogConsumer::flushAll();      // We may not survive this; get everything leading up to it on disk
 
 #ifdef WIN32
    processing = true;  // only windows appears to have message box implemented, see platform.cpp
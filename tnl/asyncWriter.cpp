@@ -0,0 +1,366 @@
+//-----------------------------------------------------------------------------------
+//
+//   Torque Network Library
+//   Copyright (C) 2004 GarageGames.com, Inc.
+//   For more information see http://www.opentnl.org
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation; either version 2 of the License, or
+//   (at your option) any later version.
+//
+//   For use in products that are not compatible with the terms of the GNU
+//   General Public License, alternative licensing options are available
+//   from GarageGames.com.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program; if not, write to the Free Software
+//   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//------------------------------------------------------------------------------------
+
+#include "tnlAsyncWriter.h"
+#include "tnlLog.h"
+#include "tnlPlatform.h"
+#include "tnlVector.h"
+
+namespace TNL
+{
+
+// Does the fwrites for every AsyncWriteStream.  Sleeps on mWork whenever there's nothing queued.
+class AsyncWriterThread : public Thread
+{
+public:
+   enum {
+      ChunkSize = 64 * 1024,     // Most written per stream before moving on to the next
+   };
+
+   Mutex mLock;                  // Guards mStreams and every stream's ring
+   Semaphore mWork;
+   bool mIdle;
+   bool mStopping;
+   Semaphore mStopped;
+   Vector<AsyncWriteStream *> mStreams;
+   U8 mChunk[ChunkSize];
+
+   AsyncWriterThread() { mIdle = false; mStopping = false; }
+
+   // Called with mLock held
+   void wake()
+   {
+      if(mIdle)
+      {
+         mIdle = false;
+         mWork.increment();
+      }
+   }
+
+   U32 run();
+};
+
+
+// Created by the first stream; it sleeps when there's nothing to write.  Streams are opened from the main thread,
+// so creating it needs no lock.  Only stopWriterThread() gets rid of it, and the next stream starts a new one.
+static AsyncWriterThread *gWriterThread = NULL;
+static bool gWriterThreadFailed = false;
+
+
+U32 AsyncWriterThread::run()
+{
+   mLock.lock();
+
+   while(true)
+   {
+      bool wrote = false;
+
+      for(S32 i = 0; i < mStreams.size(); i++)
+      {
+         AsyncWriteStream *stream = mStreams[i];
+
+         if(stream->mQueued == 0)
+         {
+            if(stream->mClosing)
+            {
+               mStreams.erase(i);
+               i--;
+               stream->mClosed.increment();
+            }
+            continue;
+         }
+
+         // Copy out under the lock, so the stream's owner can keep writing (or grow the ring) while we're on disk
+         U32 size = getMin(stream->mQueued, U32(ChunkSize));
+         U32 firstPart = getMin(size, stream->mCapacity - stream->mHead);
+         memcpy(mChunk, stream->mBuffer + stream->mHead, firstPart);
+         memcpy(mChunk + firstPart, stream->mBuffer, size - firstPart);
+
+         stream->mHead = (stream->mHead + size) % stream->mCapacity;
+         stream->mQueued -= size;
+         bool caughtUp = stream->mQueued == 0;
+
+         if(stream->mWaitingForSpace)
+         {
+            stream->mWaitingForSpace = false;
+            stream->mSpaceFreed.increment();
+         }
+
+         // Streams only go away once we've seen them empty, so stream is safe to use unlocked
+         stream->mWriting = true;
+         mLock.unlock();
+         fwrite(mChunk, 1, size, stream->mFile);
+         if(caughtUp)
+            fflush(stream->mFile);
+         mLock.lock();
+         stream->mWriting = false;
+
+         if(stream->mWaitingForFlush && stream->mQueued == 0)
+         {
+            stream->mWaitingForFlush = false;
+            stream->mFlushed.increment();
+         }
+
+         wrote = true;
+      }
+
+      if(!wrote)
+      {
+         if(mStopping)     // Everything has been written, and nothing more can be queued
+         {
+            mLock.unlock();
+            mStopped.increment();
+            return 0;
+         }
+
+         mIdle = true;
+         mLock.unlock();
+         mWork.wait();
+         mLock.lock();
+      }
+   }
+
+   return 0;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+AsyncWriteStream::AsyncWriteStream(FILE *file, OverflowPolicy policy, U32 initialSize, U32 maxSize, U32 blockTimeout)
+{
+   TNLAssert(file, "Must have a file handle");
+   TNLAssert(initialSize > 0, "Ring can't be empty");
+
+   mFile = file;
+   mPolicy = policy;
+   mBlockTimeout = blockTimeout;
+
+   mCapacity = initialSize;
+   mMaxCapacity = policy == GrowWhenFull ? getMax(maxSize, initialSize) : initialSize;
+   mBuffer = (U8 *) malloc(mCapacity);
+   mHead = 0;
+   mQueued = 0;
+
+   mWaitingForSpace = false;
+   mWriting = false;
+   mWaitingForFlush = false;
+   mClosing = false;
+
+   mPeakQueued = 0;
+   mStallTime = 0;
+   mDroppedBytes = 0;
+
+   if(!gWriterThread && !gWriterThreadFailed)
+   {
+      gWriterThread = new AsyncWriterThread();
+      if(!gWriterThread->start())
+      {
+         logprintf(LogConsumer::LogWarning, "Failed to create file writer thread, writing files directly");
+         delete gWriterThread;
+         gWriterThread = NULL;
+         gWriterThreadFailed = true;
+      }
+   }
+
+   mThread = gWriterThread;
+
+   if(mThread)
+   {
+      mThread->mLock.lock();
+      mThread->mStreams.push_back(this);
+      mThread->mLock.unlock();
+   }
+}
+
+
+AsyncWriteStream::~AsyncWriteStream()
+{
+   if(mThread)
+   {
+      mThread->mLock.lock();
+      mClosing = true;
+      mThread->wake();
+      mThread->mLock.unlock();
+
+      mClosed.wait();
+   }
+
+   fclose(mFile);
+   free(mBuffer);
+}
+
+
+// Called with the writer thread's lock held; makes room for needed bytes if maxSize allows
+bool AsyncWriteStream::grow(U32 needed)
+{
+   if(needed > mMaxCapacity)
+      return false;
+
+   U32 capacity = mCapacity;
+   while(capacity < needed)
+      capacity *= 2;
+   capacity = getMin(capacity, mMaxCapacity);
+
+   // Unwrap the queued bytes into the start of the new ring
+   U8 *buffer = (U8 *) malloc(capacity);
+   U32 firstPart = getMin(mQueued, mCapacity - mHead);
+   memcpy(buffer, mBuffer + mHead, firstPart);
+   memcpy(buffer + firstPart, mBuffer, mQueued - firstPart);
+
+   free(mBuffer);
+   mBuffer = buffer;
+   mCapacity = capacity;
+   mHead = 0;
+
+   return true;
+}
+
+
+bool AsyncWriteStream::write(const void *data, U32 size)
+{
+   if(!mThread)
+      return fwrite(data, 1, size, mFile) == size;
+
+   mThread->mLock.lock();
+
+   U32 waited = 0;
+   while(mCapacity - mQueued < size)
+   {
+      if(mPolicy == GrowWhenFull && grow(mQueued + size))
+         break;
+
+      if(mPolicy == BlockWhenFull && size <= mCapacity && waited < mBlockTimeout)
+      {
+         mWaitingForSpace = true;
+         mThread->wake();
+         mThread->mLock.unlock();
+
+         U32 start = Platform::getRealMilliseconds();
+         mSpaceFreed.wait(mBlockTimeout - waited);
+         U32 elapsed = Platform::getRealMilliseconds() - start;
+
+         waited += getMax(elapsed, U32(1));     // Always progress toward the deadline, even on a stale wakeup
+         mStallTime += elapsed;
+
+         mThread->mLock.lock();
+         continue;
+      }
+
+      mWaitingForSpace = false;
+      mDroppedBytes += size;
+      mThread->mLock.unlock();
+      return false;
+   }
+
+   U32 tail = (mHead + mQueued) % mCapacity;
+   U32 firstPart = getMin(size, mCapacity - tail);
+   memcpy(mBuffer + tail, data, firstPart);
+   memcpy(mBuffer, (const U8 *) data + firstPart, size - firstPart);
+
+   mQueued += size;
+   mPeakQueued = getMax(mPeakQueued, mQueued);
+
+   mThread->wake();
+   mThread->mLock.unlock();
+
+   return true;
+}
+
+
+// Used for log lines we can't afford to lose, and on the way down after a crash.  The lock is recursive, so this
+// is safe even if we crashed while this thread was inside write().
+bool AsyncWriteStream::flush(U32 timeout)
+{
+   if(!mThread)
+      return fflush(mFile) == 0;
+
+   mThread->mLock.lock();
+
+   U32 start = Platform::getRealMilliseconds();
+
+   while(mQueued > 0 || mWriting)
+   {
+      U32 elapsed = Platform::getRealMilliseconds() - start;
+      if(elapsed >= timeout)
+         break;
+
+      mWaitingForFlush = true;
+      mThread->wake();
+      mThread->mLock.unlock();
+
+      mFlushed.wait(timeout - elapsed);      // Stale wakeups are fine; we check again
+
+      mThread->mLock.lock();
+   }
+
+   bool flushed = mQueued == 0 && !mWriting;
+   mWaitingForFlush = false;
+
+   mThread->mLock.unlock();
+
+   return flushed;
+}
+
+
+U32 AsyncWriteStream::getQueuedBytes()
+{
+   if(!mThread)
+      return 0;
+
+   mThread->mLock.lock();
+   U32 queued = mQueued;
+   mThread->mLock.unlock();
+
+   return queued;
+}
+
+
+// Streams created from here on start a new writer thread.  Called from the main thread, like everything else that
+// creates or destroys streams, so there's nobody to race with for gWriterThread.  Static method.
+void AsyncWriteStream::stopWriterThread()
+{
+   AsyncWriterThread *thread = gWriterThread;
+   if(!thread)
+      return;
+
+   thread->mLock.lock();
+
+   for(S32 i = 0; i < thread->mStreams.size(); i++)
+      thread->mStreams[i]->mThread = NULL;      // Any further writes go straight to the file
+
+   thread->mStopping = true;
+   thread->wake();
+   thread->mLock.unlock();
+
+   thread->mStopped.wait();
+
+   // The thread may not quite have returned from run() yet, so we leave it allocated
+   gWriterThread = NULL;
+}
+
+
+};
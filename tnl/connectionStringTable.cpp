@@ -148,6 +148,29 @@ void ConnectionStringTable::packetDropped(PacketList *note)
       walk = next;
    }
 }
+void ConnectionStringTable::writeConfirmedEntries(BitStream *stream)
+{
+   for(U32 i = 0; i < EntryCount; i++)
+      if(mEntryTable[i].string.isNotNull() && mEntryTable[i].receiveConfirmed)
+      {
+         stream->writeFlag(true);
+         stream->writeInt(i, EntryBitSize);
+         stream->writeString(mEntryTable[i].string.getString());
+      }
+   stream->writeFlag(false);
+}
+
+void ConnectionStringTable::readEntries(BitStream *stream)
+{
+   char buf[256];
+   while(stream->readFlag() && stream->isValid())
+   {
+      U32 index = stream->readInt(EntryBitSize);
+      stream->readString(buf);
+      mRemoteStringTable[index].set(buf);
+   }
+}
+
 void ConnectionStringTable::packetRewind(PacketList *note, PacketEntry *p_entry)
 {
    if(!p_entry)  // if we don't have a packet entry to rewind to, then lets drop everything
@@ -102,6 +102,78 @@ void EventConnection::clearRecvEvents()
    mNextRecvEventSeq = FirstValidSendEventSeq;
    if(mTNLDataBuffer)
       delete mTNLDataBuffer;
+   mTNLDataBuffer = NULL;
+}
+
+
+void EventConnection::setNextRecvEventSeq(S32 seq)
+{
+   clearRecvEvents();
+   mNextRecvEventSeq = seq;
+}
+
+
+void EventConnection::takeEventsPostedSince(S32 firstSeq, Vector<RefPtr<NetEvent> > &events)
+{
+   EventNote **walk = &mSendEventQueueHead;
+   EventNote *prev = NULL;
+
+   while(*walk && (*walk)->mSeqCount < firstSeq)
+   {
+      prev = *walk;
+      walk = &(*walk)->mNextEvent;
+   }
+
+   EventNote *note = *walk;
+   *walk = NULL;
+   mSendEventQueueTail = prev;
+
+   while(note)
+   {
+      EventNote *next = note->mNextEvent;
+      events.push_back(note->mEvent);
+      mEventNoteChunker.free(note);
+      note = next;
+   }
+
+   mNextSendEventSeq = firstSeq;
+}
+
+
+void EventConnection::writeEventList(BitStream *bstream, const Vector<RefPtr<NetEvent> > &events)
+{
+   for(S32 i = 0; i < events.size(); i++)
+   {
+      bstream->writeFlag(true);
+      S32 start = bstream->getBitPosition();
+
+      if(mConnectionParameters.mDebugObjectSizes)
+         bstream->advanceBitPosition(BitStreamPosBitSize);
+
+      bstream->writeInt(events[i]->getClassId(getNetClassGroup()), mEventClassBitSize);
+      events[i]->pack(this, bstream);
+
+      if(mConnectionParameters.mDebugObjectSizes)
+         bstream->writeIntAt(bstream->getBitPosition(), BitStreamPosBitSize, start);
+   }
+   bstream->writeFlag(false);
+}
+
+
+void EventConnection::readEventList(BitStream *bstream)
+{
+   while(bstream->readFlag())
+   {
+      NetEvent *evt = unpackNetEvent(bstream);
+      if(!evt)
+         return;
+
+      processEvent(evt);
+      delete evt;
+
+      if(mErrorBuffer[0])
+         return;
+   }
 }
 
 void EventConnection::writeConnectRequest(BitStream *stream)
@@ -46,6 +46,11 @@ GhostConnection::GhostConnection()
    mGhostFrom = false;
    mGhostTo = false;
    mClearUnscopedObjects = false;
+
+   mPackingGhost = NULL;
+   mHasPendingBaseline = false;
+   mUnpackingGhostIndex = -1;
+   mUnpackingBaselineSequence = 0;
 }
 
 GhostConnection::~GhostConnection()
@@ -132,7 +137,7 @@ void GhostConnection::packetDropped(PacketNotify *pnotify)
       if(packRef->ghostInfoFlags & GhostInfo::Ghosting)
       {
          packRef->ghost->flags |= GhostInfo::NotYetGhosted;
-         packRef->ghost->flags &= ~GhostInfo::Ghosting;
+         packRef->ghost->flags &= ~(GhostInfo::Ghosting | GhostInfo::HasAckedBaseline);
       }
       
       // otherwise, if it was being deleted,
@@ -166,6 +171,17 @@ void GhostConnection::packetReceived(PacketNotify *pnotify)
 
       GhostRef *temp = packRef->nextRef;      
 
+      // The client now has this update's values to take differences from
+      if(packRef->hasBaseline)
+      {
+         GhostInfo *ghost = packRef->ghost;
+         if(!(ghost->flags & GhostInfo::HasAckedBaseline) || S32(packRef->baseline.sequence - ghost->ackedBaseline.sequence) > 0)
+         {
+            ghost->ackedBaseline = packRef->baseline;
+            ghost->flags |= GhostInfo::HasAckedBaseline;
+         }
+      }
+
       // If this object was ghosting, it is now ghosted...
       if(packRef->ghostInfoFlags & GhostInfo::Ghosting)
       {
@@ -357,14 +373,27 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
          freeGhostInfo(walk);
          continue;
       }
+
+      walk->flags &= ~GhostInfo::UpdateHeldBack;
+
       // Don't do any ghost processing on objects that are being killed
       // or in the process of ghosting
-      else if(!(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting)))
+      if(!(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting)))
       {
          if(walk->flags & GhostInfo::KillGhost)
             walk->priority = F32_MAX;
          else
-            walk->priority = walk->obj->getUpdatePriority(this, walk->updateMask, walk->updateSkipCount);
+         {
+            // Objects updated at a reduced rate wait until enough packets have gone by
+            U32 interval = walk->obj->getUpdateInterval(this, walk->updateMask);
+            if(interval > 1 && walk->updateSkipCount < interval)
+            {
+               walk->flags |= GhostInfo::UpdateHeldBack;
+               walk->priority = 0;
+            }
+            else
+               walk->priority = walk->obj->getUpdatePriority(this, walk->updateMask, walk->updateSkipCount);
+         }
       }
       else
          walk->priority = 0;
@@ -397,7 +426,7 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
    for(S32 i = mGhostZeroUpdateIndex - 1; i >= 0 && !bstream->isFull(); i--)
    {
       GhostInfo *walk = mGhostArray[i];
-      if(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting))
+      if(walk->flags & (GhostInfo::KillingGhost | GhostInfo::Ghosting | GhostInfo::UpdateHeldBack))
          continue;
 
       U32 updateStart = bstream->getBitPosition();
@@ -430,7 +459,10 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
             NetObject::mIsInitialUpdate = true;
          }
          // update the object
+         mPackingGhost = walk;
+         mHasPendingBaseline = false;
          retMask = walk->obj->packUpdate(this, updateMask, bstream);
+         mPackingGhost = NULL;
 
          if(NetObject::mIsInitialUpdate)
          {
@@ -477,6 +509,7 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
       upd->ghost = walk;
       upd->ghostInfoFlags = 0;
       upd->updateChain = NULL;
+      upd->hasBaseline = false;
 
       if(walk->flags & GhostInfo::KillGhost)
       {
@@ -502,6 +535,13 @@ void GhostConnection::writePacket(BitStream *bstream, PacketNotify *pnotify)
 
          upd->mask = updateMask & ~retMask;
          walk->updateSkipCount = 0;
+
+         if(mHasPendingBaseline)
+         {
+            upd->hasBaseline = true;
+            upd->baseline = mPendingBaseline;
+            walk->baselineSequence++;
+         }
          count++;
       }
    }
@@ -546,6 +586,7 @@ void GhostConnection::readPacket(BitStream *bstream)
             mLocalGhosts[index]->decRef();  // This deletes the object if needed
             mLocalGhosts[index] = NULL;
          }
+         clearReceivedBaselines(index);
       }
       else
       {
@@ -556,51 +597,21 @@ void GhostConnection::readPacket(BitStream *bstream)
          while(U32(mLocalGhosts.size()) <= index)  // Increase vector size when needed
             mLocalGhosts.push_back(NULL);
 
+         mUnpackingGhostIndex = index;
+
          if(!mLocalGhosts[index]) // it's a new ghost... cool
          {
-            S32 classId = bstream->readInt(mGhostClassBitSize);
-            if(U32(classId) >= mGhostClassCount)
-            {
-               setLastError("Invalid packet.");
-               return;
-            }
+            clearReceivedBaselines(index);
+            bool created = readNewGhost(bstream, index);
+            mUnpackingGhostIndex = -1;
 
-            NetObject *obj = (NetObject *) Object::create(getNetClassGroup(), NetClassTypeObject, classId);
-            if(!obj)
-            {
-               setLastError("Invalid packet.");
+            if(!created)
                return;
-            }
-            obj->mOwningConnection = this;
-            obj->mNetFlags = NetObject::IsGhost;
-            obj->incRef(); // This is to disallow others delete our object
-
-            // object gets initial update before adding to the manager
-
-            obj->mNetIndex = index;
-            mLocalGhosts[index] = obj;
-
-            obj->onGhostAddBeforeUpdate(this);
-
-            NetObject::mIsInitialUpdate = true;
-            mLocalGhosts[index]->unpackUpdate(this, bstream);
-            NetObject::mIsInitialUpdate = false;
-            
-            if(!obj->onGhostAdd(this))    // Runs addToGame() on some objects
-            {
-               if(!mErrorBuffer[0])
-                  setLastError("Invalid packet.");
-               return;
-            }
-            if(mRemoteConnection)
-            {
-               GhostConnection *gc = static_cast<GhostConnection *>(mRemoteConnection.getPointer());
-               obj->mServerObject = gc->resolveGhostParent(index);
-            }
          }
          else
          {
             mLocalGhosts[index]->unpackUpdate(this, bstream);
+            mUnpackingGhostIndex = -1;
          }
 
          if(mConnectionParameters.mDebugObjectSizes)
@@ -619,6 +630,237 @@ void GhostConnection::readPacket(BitStream *bstream)
 //-----------------------------------------------------------------------------
 
 
+
+// Reads the class and initial update of a ghost the other side has just created at index
+bool GhostConnection::readNewGhost(BitStream *bstream, U32 index)
+{
+   S32 classId = bstream->readInt(mGhostClassBitSize);
+   if(U32(classId) >= mGhostClassCount)
+   {
+      setLastError("Invalid packet.");
+      return false;
+   }
+
+   NetObject *obj = (NetObject *) Object::create(getNetClassGroup(), NetClassTypeObject, classId);
+   if(!obj)
+   {
+      setLastError("Invalid packet.");
+      return false;
+   }
+   obj->mOwningConnection = this;
+   obj->mNetFlags = NetObject::IsGhost;
+   obj->incRef(); // This is to disallow others delete our object
+
+   // object gets initial update before adding to the manager
+
+   obj->mNetIndex = index;
+   mLocalGhosts[index] = obj;
+
+   obj->onGhostAddBeforeUpdate(this);
+
+   NetObject::mIsInitialUpdate = true;
+   obj->unpackUpdate(this, bstream);
+   NetObject::mIsInitialUpdate = false;
+
+   if(!obj->onGhostAdd(this))    // Runs addToGame() on some objects
+   {
+      if(!mErrorBuffer[0])
+         setLastError("Invalid packet.");
+      return false;
+   }
+   if(mRemoteConnection)
+   {
+      GhostConnection *gc = static_cast<GhostConnection *>(mRemoteConnection.getPointer());
+      obj->mServerObject = gc->resolveGhostParent(index);
+   }
+   return true;
+}
+
+
+bool GhostConnection::canWriteGhostSnapshot()
+{
+   for(S32 i = 0; i < mGhostZeroUpdateIndex; i++)
+      if(mGhostArray[i]->flags & (GhostInfo::KillGhost | GhostInfo::KillingGhost))
+         return false;
+
+   return true;
+}
+
+
+void GhostConnection::writeGhostSnapshot(BitStream *bstream)
+{
+   for(S32 i = 0; i < mGhostRefs.size(); i++)
+   {
+      GhostInfo *walk = mGhostRefs[i];
+
+      // A reader starting from here knows nothing of earlier updates, so don't code against them
+      walk->flags &= ~GhostInfo::HasAckedBaseline;
+
+      if(walk->arrayIndex >= mGhostFreeIndex || !walk->obj || (walk->flags & (GhostInfo::NotYetGhosted | GhostInfo::KillGhost | GhostInfo::KillingGhost)))
+         continue;
+
+      bstream->writeFlag(true);
+      bstream->writeInt(walk->index, GhostIdBitSize);
+      bstream->writeInt(walk->obj->getClassId(getNetClassGroup()), mGhostClassBitSize);
+
+      NetObject::mIsInitialUpdate = true;
+      walk->obj->packUpdate(this, 0xFFFFFFFF, bstream);
+      NetObject::mIsInitialUpdate = false;
+   }
+   bstream->writeFlag(false);
+}
+
+
+void GhostConnection::readGhostSnapshot(BitStream *bstream)
+{
+   if(!doesGhostTo())
+      return;
+
+   for(S32 i = 0; i < mReceivedBaselines.size(); i++)
+      clearReceivedBaselines(i);
+
+   // Anything the subclass doesn't want to keep gets rebuilt from scratch
+   for(S32 i = 0; i < mLocalGhosts.size(); i++)
+      if(mLocalGhosts[i] && !keepGhostAcrossSnapshot(mLocalGhosts[i]))
+      {
+         mLocalGhosts[i]->onGhostRemove();
+         mLocalGhosts[i]->decRef();
+         mLocalGhosts[i] = NULL;
+      }
+
+   Vector<bool> inSnapshot(mLocalGhosts.size());
+   for(S32 i = 0; i < mLocalGhosts.size(); i++)
+      inSnapshot.push_back(false);
+
+   while(bstream->readFlag())
+   {
+      U32 index = bstream->readInt(GhostIdBitSize);
+
+      while(U32(mLocalGhosts.size()) <= index)
+      {
+         mLocalGhosts.push_back(NULL);
+         inSnapshot.push_back(false);
+      }
+      inSnapshot[index] = true;
+
+      NetObject *obj = mLocalGhosts[index];
+
+      // A kept ghost is only updated in place if the snapshot has the same kind of object there
+      if(obj)
+      {
+         U32 start = bstream->getBitPosition();
+         U32 classId = bstream->readInt(mGhostClassBitSize);
+
+         if(classId == U32(obj->getClassId(getNetClassGroup())))
+         {
+            NetObject::mIsInitialUpdate = true;
+            obj->unpackUpdate(this, bstream);
+            NetObject::mIsInitialUpdate = false;
+
+            if(mErrorBuffer[0])
+               return;
+            continue;
+         }
+
+         obj->onGhostRemove();
+         obj->decRef();
+         mLocalGhosts[index] = NULL;
+         bstream->setBitPosition(start);
+      }
+
+      if(!readNewGhost(bstream, index))
+         return;
+   }
+
+   // Kept ghosts the snapshot doesn't know about are gone
+   for(S32 i = 0; i < mLocalGhosts.size(); i++)
+      if(mLocalGhosts[i] && !inSnapshot[i])
+      {
+         mLocalGhosts[i]->onGhostRemove();
+         mLocalGhosts[i]->decRef();
+         mLocalGhosts[i] = NULL;
+      }
+}
+
+//-----------------------------------------------------------------------------
+
+void GhostConnection::packBaselineReference(BitStream *bstream, GhostBaseline &baseline)
+{
+   baseline = GhostBaseline();
+
+   // Outside of writePacket (in a snapshot, say) there's no update to record, and nothing to code against
+   if(!mPackingGhost)
+   {
+      bstream->writeInt(0, BaselineSequenceBits);
+      bstream->writeFlag(false);
+      return;
+   }
+
+   U32 sequence = mPackingGhost->baselineSequence;
+   bstream->writeInt(sequence & BaselineSequenceMask, BaselineSequenceBits);
+
+   // The acked update has to be one the client still remembers
+   const GhostBaseline &acked = mPackingGhost->ackedBaseline;
+   if(bstream->writeFlag((mPackingGhost->flags & GhostInfo::HasAckedBaseline) && sequence - acked.sequence < BaselineHistorySize))
+   {
+      bstream->writeInt(acked.sequence & BaselineSequenceMask, BaselineSequenceBits);
+      baseline = acked;
+   }
+
+   baseline.sequence = sequence;
+}
+
+
+void GhostConnection::unpackBaselineReference(BitStream *bstream, GhostBaseline &baseline)
+{
+   baseline = GhostBaseline();
+
+   mUnpackingBaselineSequence = bstream->readInt(BaselineSequenceBits);
+
+   if(bstream->readFlag())
+   {
+      U32 sequence = bstream->readInt(BaselineSequenceBits);
+
+      // Never missing unless the server's confused; the caller will read garbage values, but stay in step
+      if(mUnpackingGhostIndex != -1 && mUnpackingGhostIndex < mReceivedBaselines.size() && mReceivedBaselines[mUnpackingGhostIndex])
+         baseline = mReceivedBaselines[mUnpackingGhostIndex][sequence];
+   }
+
+   baseline.sequence = mUnpackingBaselineSequence;
+}
+
+
+void GhostConnection::recordBaseline(const GhostBaseline &baseline)
+{
+   if(mPackingGhost)
+   {
+      mPendingBaseline = baseline;
+      mHasPendingBaseline = true;
+      return;
+   }
+
+   if(mUnpackingGhostIndex == -1)
+      return;
+
+   while(mReceivedBaselines.size() <= mUnpackingGhostIndex)
+      mReceivedBaselines.push_back(NULL);
+
+   if(!mReceivedBaselines[mUnpackingGhostIndex])
+      mReceivedBaselines[mUnpackingGhostIndex] = new GhostBaseline[BaselineHistorySize];
+
+   mReceivedBaselines[mUnpackingGhostIndex][mUnpackingBaselineSequence] = baseline;
+}
+
+
+void GhostConnection::clearReceivedBaselines(S32 index)
+{
+   if(index >= mReceivedBaselines.size())
+      return;
+
+   delete[] mReceivedBaselines[index];
+   mReceivedBaselines[index] = NULL;
+}
+
 //-----------------------------------------------------------------------------
 
 void GhostConnection::setScopeObject(NetObject *obj)
@@ -782,6 +1024,7 @@ void GhostConnection::objectInScope(NetObject *obj)
    giptr->obj = obj;
    giptr->lastUpdateChain = NULL;
    giptr->updateSkipCount = 0;
+   giptr->baselineSequence = 0;
 
    giptr->connection = this;
 
@@ -872,6 +1115,9 @@ void GhostConnection::deleteLocalGhosts()
          mLocalGhosts[i] = NULL;
       }
    }
+
+   for(S32 i = 0; i < mReceivedBaselines.size(); i++)
+      clearReceivedBaselines(i);
 }
 
 void GhostConnection::clearGhostInfo()
@@ -926,6 +1172,20 @@ void GhostConnection::resetGhosting()
 }
 
 
+// True once every object in scope has been ghosted at least once and none has an initial update still in flight
+bool GhostConnection::hasGhostedEverything()
+{
+   if(!mGhosting)
+      return false;
+
+   for(S32 i = 0; i < mGhostFreeIndex; i++)
+      if(mGhostArray[i]->flags & (GhostInfo::NotYetGhosted | GhostInfo::Ghosting))
+         return false;
+
+   return true;
+}
+
+
 //-----------------------------------------------------------------------------
 
 NetObject *GhostConnection::resolveGhost(S32 id)
@@ -25,6 +25,7 @@
 //------------------------------------------------------------------------------------
 
 #include "tnlLog.h"
+#include "tnlAsyncWriter.h"
 #include "tnlDataChunker.h"
 #include "../zap/oglconsole.h"   // For logging to the console
 #include <time.h>
@@ -91,12 +92,29 @@ void LogConsumer::setMsgType(MsgType msgType, bool enable)
 }
 
 
-// Find all logs that are listenting to a specified MessageType and forward the message to them.  Static method.
+// Find all logs that are listenting to a specified MessageType and forward the message to them.  Fatal errors come
+// just before we go down, so they go all the way to disk before we return.  Plain errors stay queued like everything
+// else -- misbehaving scripts can log those every frame.  Static method.
 void LogConsumer::logString(LogConsumer::MsgType msgType, std::string message)
 {
+   bool isFatal = (msgType & LogFatalError) != 0;
+
    for(LogConsumer *walk = LogConsumer::getLinkedList(); walk; walk = walk->getNext())
       if(walk->mMsgTypes & msgType)     // Only log to the requested type of logfile
+      {
          walk->prepareAndLogString(message);
+
+         if(isFatal)
+            walk->flush();
+      }
+}
+
+
+// Static method
+void LogConsumer::flushAll()
+{
+   for(LogConsumer *walk = LogConsumer::getLinkedList(); walk; walk = walk->getNext())
+      walk->flush();
 }
 
 
@@ -152,40 +170,49 @@ void LogConsumer::prepareAndLogString(std::string message)
 // Constructor -- open the file
 FileLogConsumer::FileLogConsumer()    // Constructor
 {
-   f = NULL;
+   mStream = NULL;
 }
 
 
 // Destructor -- close the file
 FileLogConsumer::~FileLogConsumer()    
 {
-   if(f)
-      fclose(f);
+   delete mStream;      // Finishes writing anything still queued
 }
 
 void FileLogConsumer::init(std::string logFile, const char *mode)
 {
-   if(f)
-      fclose(f);
+   delete mStream;
+   mStream = NULL;
 
-   f = fopen(logFile.c_str(), mode);
+   FILE *f = fopen(logFile.c_str(), mode);
    if(!f)
+   {
       TNLAssert(false, "Can't open log file for writing!");    // TODO: What should we really do?
+      return;
+   }
+
+   // Logs rarely come in bursts big enough to fill this, but lines are better kept than dropped
+   mStream = new AsyncWriteStream(f, AsyncWriteStream::GrowWhenFull, 16 * 1024, 1024 * 1024);
 }
 
 
 void FileLogConsumer::writeString(const char *string)
 {
-   if(f)
-   {
-      fprintf(f, "%s", string);
-      fflush(f);
-   }
+   if(mStream)
+      mStream->write(string, (U32)strlen(string));
    //else
       //TNLAssert(false, "Logfile not initialized!");  // Causes stack overflow
 }
 
 
+void FileLogConsumer::flush()
+{
+   if(mStream)
+      mStream->flush();
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -41,6 +41,9 @@ U32 NetClassRep::mClassCRC[NetClassGroupCount] = {INITIAL_CRC_VALUE, };
 
 bool NetClassRep::mInitialized = false;
 
+Vector<NetClassRep *> NetClassRep::mNameTable;
+U32 NetClassRep::mNameHashSeed = 0;
+
 NetClassRep::NetClassRep()
 {
    mInitialUpdateCount = 0;
@@ -53,6 +56,15 @@ Object* NetClassRep::create(const char* className)
 {
    TNLAssert(mInitialized, "creating an object before NetClassRep::initialize.");
 
+   if(mNameTable.size())
+   {
+      NetClassRep *rep = mNameTable[hashClassName(className, mNameHashSeed) & (mNameTable.size() - 1)];
+      if(rep && !strcmp(rep->getClassName(), className))
+         return rep->create();
+
+      return NULL;
+   }
+
    for (NetClassRep *walk = mClassLinkList; walk; walk = walk->mNextClass)
       if (!strcmp(walk->getClassName(), className))
          return walk->create();
@@ -134,10 +146,76 @@ void NetClassRep::initialize()
          dynamicTable.clear();
       }
    }
+
+   buildNameTable();
+
    mInitialized = true;
 }
 
 
+// FNV-1a, with a seed mixed in so buildNameTable() has something to turn when two names land in the same slot
+U32 NetClassRep::hashClassName(const char *className, U32 seed)
+{
+   U32 hash = 2166136261U ^ (seed * 16777619U);
+
+   for(const char *c = className; *c; c++)
+      hash = (hash ^ U8(*c)) * 16777619U;
+
+   return hash;
+}
+
+
+// Levels create most of their objects by name, so make that lookup cheap: search for a table size and seed that
+// give every class name a slot of its own.  Where two classes share a name, the first in the link list wins, as
+// it would walking the list.  If we somehow can't find a perfect hash, the table is left empty and create()
+// walks the list as before.
+void NetClassRep::buildNameTable()
+{
+   Vector<NetClassRep *> reps;
+
+   for(NetClassRep *walk = mClassLinkList; walk; walk = walk->mNextClass)
+   {
+      bool duplicate = false;
+      for(S32 i = 0; i < reps.size() && !duplicate; i++)
+         duplicate = !strcmp(reps[i]->getClassName(), walk->getClassName());
+
+      if(!duplicate)
+         reps.push_back(walk);
+   }
+
+   mNameTable.clear();
+
+   const U32 MaxTableSize = 1 << 16;
+   const U32 SeedsPerSize = 256;
+
+   for(U32 size = getNextPow2(reps.size() * 2 + 1); size <= MaxTableSize; size *= 2)
+      for(U32 seed = 0; seed < SeedsPerSize; seed++)
+      {
+         mNameTable.resize(size);
+         for(U32 i = 0; i < size; i++)
+            mNameTable[i] = NULL;
+
+         bool collision = false;
+
+         for(S32 i = 0; i < reps.size() && !collision; i++)
+         {
+            NetClassRep *&slot = mNameTable[hashClassName(reps[i]->getClassName(), seed) & (size - 1)];
+            collision = slot != NULL;
+            slot = reps[i];
+         }
+
+         if(!collision)
+         {
+            mNameHashSeed = seed;
+            logprintf(LogConsumer::LogNetBase, "Class name table: %d classes in %d slots, seed %d", reps.size(), size, seed);
+            return;
+         }
+      }
+
+   mNameTable.clear();
+}
+
+
 // Only called on exit
 void NetClassRep::logBitUsage()
 {
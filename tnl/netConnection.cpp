@@ -569,6 +569,14 @@ void NetConnection::computeNegotiatedRate()
       mCurrentPacketSendPeriod = 0;
 }
 
+U32 NetConnection::getSendBandwidth()
+{
+   // Events are never packed past the preferred packet size, whatever the rate would allow
+   U32 packetSize = getMin(mCurrentPacketSendSize, MaxPreferredPacketDataSize);
+
+   return packetSize * 1000 / getMax(mCurrentPacketSendPeriod, U32(1));
+}
+
 void NetConnection::setIsAdaptive()
 {
    mTypeFlags.set(ConnectionAdaptive);
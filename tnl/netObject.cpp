@@ -184,6 +184,11 @@ F32 NetObject::getUpdatePriority(GhostConnection*, U32, S32 updateSkips)
    //return 0;
 }
 
+U32 NetObject::getUpdateInterval(GhostConnection*, U32)
+{
+   return 1;
+}
+
 U32 NetObject::packUpdate(GhostConnection*, U32, BitStream*)
 {
    return 0;
@@ -29,6 +29,8 @@
 
 #ifndef TNL_OS_WIN32
 #include "stdint.h"
+#include <errno.h>
+#include <time.h>
 #endif
 
 namespace TNL
@@ -50,6 +52,11 @@ void Semaphore::wait()
    WaitForSingleObject(mSemaphore, INFINITE);
 }
 
+bool Semaphore::wait(U32 timeoutMs)
+{
+   return WaitForSingleObject(mSemaphore, timeoutMs) == WAIT_OBJECT_0;
+}
+
 void Semaphore::increment(U32 count)
 {
    ReleaseSemaphore(mSemaphore, count, NULL);
@@ -144,6 +151,37 @@ void Semaphore::wait()
    sem_wait(&mSemaphore);
 }
 
+bool Semaphore::wait(U32 timeoutMs)
+{
+#ifdef __APPLE__
+   // No sem_timedwait here; poll instead
+   U32 start = Platform::getRealMilliseconds();
+   while(sem_trywait(&mSemaphore) != 0)
+   {
+      if(Platform::getRealMilliseconds() - start >= timeoutMs)
+         return false;
+      Platform::sleep(1);
+   }
+   return true;
+#else
+   timespec deadline;
+   clock_gettime(CLOCK_REALTIME, &deadline);
+   deadline.tv_sec  += timeoutMs / 1000;
+   deadline.tv_nsec += (timeoutMs % 1000) * 1000000;
+   if(deadline.tv_nsec >= 1000000000)
+   {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000;
+   }
+
+   while(sem_timedwait(&mSemaphore, &deadline) != 0)
+      if(errno != EINTR)
+         return false;
+
+   return true;
+#endif
+}
+
 void Semaphore::increment(U32 count)
 {
    for(U32 i = 0; i < count; i++)
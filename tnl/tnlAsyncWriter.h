@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------------
+//
+//   Torque Network Library
+//   Copyright (C) 2004 GarageGames.com, Inc.
+//   For more information see http://www.opentnl.org
+//
+//   This program is free software; you can redistribute it and/or modify
+//   it under the terms of the GNU General Public License as published by
+//   the Free Software Foundation; either version 2 of the License, or
+//   (at your option) any later version.
+//
+//   For use in products that are not compatible with the terms of the GNU
+//   General Public License, alternative licensing options are available
+//   from GarageGames.com.
+//
+//   This program is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//   GNU General Public License for more details.
+//
+//   You should have received a copy of the GNU General Public License
+//   along with this program; if not, write to the Free Software
+//   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//------------------------------------------------------------------------------------
+
+#ifndef _TNL_ASYNCWRITER_H_
+#define _TNL_ASYNCWRITER_H_
+
+#include "tnlThread.h"
+#include <stdio.h>
+
+namespace TNL
+{
+
+class AsyncWriterThread;
+
+/// A file written from a single background thread shared by every AsyncWriteStream.
+///
+/// fwrite can stall for a second or more on a VPS or a busy disk.  Writes to an
+/// AsyncWriteStream only copy into a ring buffer, so that stall lands on the writer
+/// thread rather than on the game.  What happens when the ring fills up is chosen
+/// per stream with an OverflowPolicy.  Writes are all or nothing: a write that
+/// doesn't fit is dropped whole, never split.
+class AsyncWriteStream
+{
+   friend class AsyncWriterThread;
+
+public:
+   enum {
+      DefaultFlushTimeout = 1000,   ///< ms; flush() gives up after this, in case the writer thread is wedged or dead
+   };
+
+   enum OverflowPolicy {
+      DropWhenFull,        ///< Throw away writes that don't fit
+      GrowWhenFull,        ///< Grow the ring, up to maxSize, then drop
+      BlockWhenFull,       ///< Wait up to blockTimeout ms for the writer thread to make room, then drop
+   };
+
+private:
+   AsyncWriterThread *mThread;   ///< NULL if we write straight to the file
+   FILE *mFile;
+   OverflowPolicy mPolicy;
+   U32 mBlockTimeout;
+
+   // Ring buffer, protected by the writer thread's lock
+   U8 *mBuffer;
+   U32 mCapacity;
+   U32 mMaxCapacity;
+   U32 mHead;                 ///< Where the writer thread reads from next
+   U32 mQueued;               ///< Bytes waiting to go to disk
+
+   bool mWaitingForSpace;
+   Semaphore mSpaceFreed;
+   bool mWriting;             ///< Writer thread has a chunk of ours that hasn't reached the file yet
+   bool mWaitingForFlush;
+   Semaphore mFlushed;
+   bool mClosing;
+   Semaphore mClosed;
+
+   // Metrics
+   U32 mPeakQueued;
+   U32 mStallTime;
+   U32 mDroppedBytes;
+
+   bool grow(U32 needed);
+
+public:
+   /// Takes ownership of file, which is closed once everything queued has been written.
+   AsyncWriteStream(FILE *file, OverflowPolicy policy, U32 initialSize, U32 maxSize = 0, U32 blockTimeout = 0);
+
+   /// Waits for everything queued to reach the file, then closes it.
+   ~AsyncWriteStream();
+
+   /// Queues size bytes for writing.  Returns false if they were dropped.
+   bool write(const void *data, U32 size);
+
+   /// Waits up to timeout ms for everything queued so far to be handed to the OS.  Returns false if it
+   /// didn't get there in time.
+   bool flush(U32 timeout = DefaultFlushTimeout);
+
+   U32 getQueuedBytes();                                 ///< Bytes not yet handed to the OS
+   U32 getPeakQueuedBytes() { return mPeakQueued; }      ///< Most bytes ever queued at once
+   U32 getStallTime() { return mStallTime; }             ///< Total ms write() has spent waiting for room
+   U32 getDroppedBytes() { return mDroppedBytes; }       ///< Total bytes thrown away because the ring was full
+
+   /// Writes out everything queued by every stream, then stops the writer thread.  Existing streams write
+   /// straight to their files from then on.  Call this before fork(): the child gets no writer thread, and
+   /// would wait forever on one that held the lock or owed it a flush.
+   static void stopWriterThread();
+};
+
+};
+
+#endif
@@ -101,6 +101,11 @@ public:
    void packetReceived(PacketList *note);
    void packetDropped(PacketList *note);
    void packetRewind(PacketList *note, PacketEntry *p_entry);
+
+   /// Writes every entry the other side has confirmed, so a reader that has lost its place in a
+   /// recorded stream can rebuild its table with readEntries()
+   void writeConfirmedEntries(BitStream *stream);
+   void readEntries(BitStream *stream);
 };
 
 };
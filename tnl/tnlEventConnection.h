@@ -109,6 +109,18 @@ protected:
    /// Dispatches an event
    void processEvent(NetEvent *theEvent);
 
+   /// Pulls the ordered events posted since sequence firstSeq back out of the send queue, so they can be
+   /// written some other way.  Sequencing carries on from firstSeq as though they had never been posted.
+   void takeEventsPostedSince(S32 firstSeq, Vector<RefPtr<NetEvent> > &events);
+
+   /// Writes events without sequence numbers; readEventList() dispatches each one as soon as it is read
+   void writeEventList(BitStream *bstream, const Vector<RefPtr<NetEvent> > &events);
+   void readEventList(BitStream *bstream);
+
+   /// Used by connections that jump around in a recorded packet stream
+   S32 getNextSendEventSeq() { return mNextSendEventSeq; }
+   void setNextRecvEventSeq(S32 seq);     ///< Also drops any events waiting on earlier ones
+
 
 //----------------------------------------------------------------
 // event manager functions/code:
@@ -42,6 +42,26 @@ namespace TNL {
 
 struct GhostInfo;
 
+/// Values an object sent in one update of its ghost, which later updates can be coded as differences from.
+///
+/// Both sides must hold exactly the same numbers, so objects put whatever they send here in the integer
+/// form the other side will decode it to.
+struct GhostBaseline
+{
+   enum {
+      MaxValues = 6,
+   };
+
+   U32 sequence;           ///< Which update of the ghost these values were sent in
+   U32 validMask;          ///< Bit i is set if values[i] was sent
+   S32 values[MaxValues];
+
+   GhostBaseline() { sequence = 0; validMask = 0; }
+
+   bool isValid(U32 i) const { return (validMask & BIT(i)) != 0; }
+   void set(U32 i, S32 value) { values[i] = value; validMask |= BIT(i); }
+};
+
 /// GhostConnection is a subclass of EventConnection that manages the transmission
 /// (ghosting) and updating of NetObjects over a connection.
 ///
@@ -101,6 +121,8 @@ public:
       GhostRef *nextRef;     ///< The next ghost updated in this packet
       GhostRef *updateChain; ///< A pointer to the GhostRef on the least previous packet that
                              ///  updated this ghost, or NULL, if no prior packet updated this ghost
+      bool hasBaseline;      ///< True if the update recorded a baseline
+      GhostBaseline baseline; ///< The values the update left the ghost with, once this packet is acked
    };
 
 
@@ -138,6 +160,47 @@ protected:
    /// Override to check if there is data pending on this GhostConnection.
    bool isDataToTransmit();
 
+   /// Writes every ghost the other side currently has, at its current index, so that a reader that has lost
+   /// its place in a recorded stream of packets can rebuild its ghosts with readGhostSnapshot().  Only call
+   /// when canWriteGhostSnapshot() says no ghosts are on their way out.
+   bool canWriteGhostSnapshot();
+   void writeGhostSnapshot(BitStream *bstream);
+   void readGhostSnapshot(BitStream *bstream);
+
+   /// Ghosts for which this returns true are updated in place by readGhostSnapshot(), rather than recreated
+   virtual bool keepGhostAcrossSnapshot(NetObject *ghost) { return false; }
+
+//----------------------------------------------------------------
+// baseline delta coding:
+//----------------------------------------------------------------
+
+public:
+   enum BaselineConstants {
+      BaselineSequenceBits = 3,
+      BaselineHistorySize = (1 << BaselineSequenceBits),    ///< Updates the receiving side remembers per ghost
+      BaselineSequenceMask = (BaselineHistorySize - 1),
+   };
+
+   /// From packUpdate()/unpackUpdate(), starts a part of the update coded against an earlier update.  Sends
+   /// which update that is, and fills baseline with its values; baseline is left empty if the other side
+   /// hasn't yet acked an update recent enough to use.  Call recordBaseline() once the values are written.
+   void packBaselineReference(BitStream *bstream, GhostBaseline &baseline);
+   void unpackBaselineReference(BitStream *bstream, GhostBaseline &baseline);
+
+   /// Remembers baseline as the values this update leaves the ghost with
+   void recordBaseline(const GhostBaseline &baseline);
+
+private:
+   GhostInfo *mPackingGhost;                    ///< Ghost being written by writePacket, if any
+   bool mHasPendingBaseline;
+   GhostBaseline mPendingBaseline;              ///< Recorded by the ghost being written; kept if its update fits
+
+   S32 mUnpackingGhostIndex;                    ///< Ghost being read by readPacket, or -1
+   U32 mUnpackingBaselineSequence;
+   Vector<GhostBaseline *> mReceivedBaselines;  ///< Per local ghost, the last BaselineHistorySize updates' values, or NULL
+
+   void clearReceivedBaselines(S32 index);
+
 //----------------------------------------------------------------
 // ghost manager functions/code:
 //----------------------------------------------------------------
@@ -170,6 +233,8 @@ protected:
 
    void freeGhostInfo(GhostInfo *);
 
+   bool readNewGhost(BitStream *bstream, U32 index);
+
    /// Notifies subclasses that the remote host is about to start ghosting objects.
    virtual void onStartGhosting();                              
 
@@ -238,6 +303,7 @@ public:
    void resetGhosting();                   ///< Stops ghosting objects from this GhostConnection to the remote host, which causes all ghosts to be destroyed on the client.
    void activateGhosting();                ///< Begins ghosting objects from this GhostConnection to the remote host, starting with the GhostAlways objects.
    bool isGhosting() { return mGhosting; } ///< Returns true if this connection is currently ghosting objects to the remote host.
+   bool hasGhostedEverything();            ///< Returns true if ghosting is on and the remote host has every object in scope.
 
    void detachObject(GhostInfo *info);                ///< Notifies the GhostConnection that the specified GhostInfo should no longer be scoped to the client.
 
@@ -279,6 +345,8 @@ struct GhostInfo
    GhostConnection *connection; ///< The connection that owns this GhostInfo
    GhostInfo *nextLookupInfo;   ///< Next GhostInfo in the hash table for NetObject*->GhostInfo*
    U32 updateSkipCount;         ///< How many times this object has NOT been updated in writePacket
+   U32 baselineSequence;        ///< Sequence number of the next update that records a baseline
+   GhostBaseline ackedBaseline; ///< Latest baseline the client is known to have, if HasAckedBaseline is set
 
    U32 flags;      ///< Current flag status of this object for this connection.
    F32 priority;   ///< Priority for the update of this object, computed after the scoping process has run.
@@ -293,6 +361,8 @@ struct GhostInfo
       Ghosting = BIT(3),            ///< This GhostInfo's NetObject has been sent to the client, but the packet it was sent in hasn't been acked yet.
       KillGhost = BIT(4),           ///< The ghost of this GhostInfo's NetObject should be destroyed ASAP.
       KillingGhost = BIT(5),        ///< The ghost of this GhostInfo's NetObject is in the process of being destroyed.
+      UpdateHeldBack = BIT(6),      ///< This GhostInfo's NetObject is out of date, but isn't due for an update in this packet.
+      HasAckedBaseline = BIT(7),    ///< ackedBaseline holds values the client has.
 
       /// Flag mask - if any of these are set, the object is not yet available for ghost ID lookup.
       NotAvailable = (NotYetGhosted | Ghosting | KillGhost | KillingGhost),
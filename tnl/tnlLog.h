@@ -119,6 +119,9 @@ public:
 
    static void logString(LogConsumer::MsgType msgType, std::string message);
 
+   virtual void flush() { }      // Make sure everything logged so far has been written out
+   static void flushAll();       // Flushes every consumer; for asserts and crashes
+
 private:
    S32 mMsgTypes;    // A bitmap of MsgType values
    void prepareAndLogString(std::string message);
@@ -129,10 +132,12 @@ private:
 ////////////////////////////////////////
 ////////////////////////////////////////
 
-class FileLogConsumer : public LogConsumer    // Dumps logs to file
+class AsyncWriteStream;
+
+class FileLogConsumer : public LogConsumer    // Dumps logs to file, through the shared writer thread
 {
 protected:
-   FILE *f;
+   AsyncWriteStream *mStream;
 
 public:
    FileLogConsumer();      // Constructor
@@ -140,6 +145,8 @@ public:
 
    void init(std::string logFile, const char *mode = "a");
 
+   void flush();
+
 private:
    void writeString(const char *string);
 }; 
@@ -220,6 +220,14 @@ protected:
    static U32 mClassCRC[NetClassGroupCount];                                ///< Internally computed class group CRC.
    static bool mInitialized;                                                ///< Set once the class tables are built, from initialize.
 
+   /// Perfect hash of class names, for create(className): every class name hashes to its own slot,
+   /// so a lookup is one hash and one strcmp.  Built by initialize().
+   static Vector<NetClassRep *> mNameTable;
+   static U32 mNameHashSeed;                                                ///< Seed that makes mNameTable collision free.
+
+   static U32 hashClassName(const char *className, U32 seed);
+   static void buildNameTable();
+
    /// mNetClassBitSize is the number of bits needed to transmit the class ID for a group and type.
    static U32 mNetClassBitSize[NetClassGroupCount][NetClassTypeCount];
 
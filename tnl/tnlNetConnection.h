@@ -539,6 +539,9 @@ public:
    F32 getOneWayTime()
       { return mRoundTripTime * 0.5f; }
 
+   /// Returns the number of bytes per second the negotiated packet rate and size let us send to the remote host.
+   U32 getSendBandwidth();
+
    /// Returns the remote address of the host we're connected or trying to connect to.
    const Address &getNetAddress();
 
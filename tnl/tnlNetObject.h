@@ -297,6 +297,15 @@ public:
    /// update.
    virtual F32 getUpdatePriority(GhostConnection *connection, U32 updateMask, S32 updateSkips);
 
+   /// Called before getUpdatePriority to find how often the object needs updating.
+   ///
+   /// An object with an interval of n is held back until n packets have gone by
+   /// since it was last updated, which lets objects of little interest to a
+   /// connection be updated at a reduced rate.  Held-back objects keep their
+   /// update mask, so their changes are only delayed, never lost.  The default
+   /// of 1 updates the object whenever there's room.
+   virtual U32 getUpdateInterval(GhostConnection *connection, U32 updateMask);
+
    /// Write the object's state to a packet.
    ///
    /// packUpdate is called on an object when it is to be written into a
@@ -68,6 +68,10 @@ public:
    /// will be awakened and the semaphore will decrement.
    void wait();
 
+   /// Like wait(), but gives up after timeoutMs milliseconds.  Returns true if
+   /// the semaphore was acquired, false if the time ran out first.
+   bool wait(U32 timeoutMs);
+
    /// Increments the semaphore's internal count.  This will wake
    /// count threads that are waiting on this semaphore.
    void increment(U32 count = 1);
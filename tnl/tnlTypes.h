@@ -333,7 +333,7 @@ static const U32 S32_MAX_DIGITS = 11;                             ///< S16_MIN =
 #      define TNL_GCC_2
 #    elif __GNUC__ == 3
 #      define TNL_GCC_3
-#    elif __GNUC__ == 4
+#    elif __GNUC__ >= 4
 #      define TNL_GCC_4
 #    else
 #      error "TNL: Unsupported version of GCC (see tnlMethodDispatch.cpp)"
@@ -896,14 +896,15 @@ bool BfObject::isVisibleToTeam(S32 teamIndex) const
 }
 
 
+// Runs for every ghost with something to send on every packet, so anything that depends only on the connection
+// comes from its Viewpoint.  Every ghosting connection in the game is a GameConnection.
 F32 BfObject::getUpdatePriority(GhostConnection *connection, U32 updateMask, S32 updateSkips)
 {
-   GameConnection *gc = dynamic_cast<GameConnection *>(connection);
-   BfObject *so = gc ? gc->getControlObject() : NULL;
+   const ControlObjectConnection::Viewpoint &view = static_cast<GameConnection *>(connection)->getViewpoint();
    F32 add = 0;
-   if(so)
+   if(view.valid)
    {
-      Point center = so->getExtent().getCenter();
+      const Point &center = view.center;
 
       Point nearest;
       const Rect &extent = getExtent();
@@ -924,9 +925,9 @@ F32 BfObject::getUpdatePriority(GhostConnection *connection, U32 updateMask, S32
 
       Point deltap = nearest - center;
 
-      F32 distance = (nearest - center).len();
+      F32 distance = deltap.len();
 
-      Point deltav = getVel() - so->getVel();
+      Point deltav = getVel() - view.vel;
 
 
       // initial scoping factor is distance based.
@@ -944,6 +945,64 @@ F32 BfObject::getUpdatePriority(GhostConnection *connection, U32 updateMask, S32
 }
 
 
+// Anything not on the client's screen can be updated less often.  The client carries moving objects along on their
+// last known velocity in between.  In packets.
+static const U32 InterestTierUpdateIntervals[BfObject::InterestTierCount] = { 1, 2, 4 };
+
+
+BfObject::InterestTier BfObject::getInterestTier(GhostConnection *connection)
+{
+   const ControlObjectConnection::Viewpoint &view = static_cast<GameConnection *>(connection)->getViewpoint();
+
+   // Connections without a ship, like the game recorder, get everything at full rate
+   if(!view.valid || !view.isShip)
+      return InterestNear;
+
+   const Point &center = view.center;
+   const Rect &extent = getExtent();
+
+   // Distance along each axis to the nearest part of our extent
+   F32 dx = getMax(0.0f, getMax(extent.min.x - center.x, center.x - extent.max.x));
+   F32 dy = getMax(0.0f, getMax(extent.min.y - center.y, center.y - extent.max.y));
+
+   const Point &visArea = view.visArea;
+
+   if(dx <= visArea.x && dy <= visArea.y)
+      return InterestNear;
+
+   if(dx <= visArea.x + Game::PLAYER_SCOPE_MARGIN && dy <= visArea.y + Game::PLAYER_SCOPE_MARGIN)
+      return InterestMid;
+
+   return InterestFar;
+}
+
+
+// Only movement is held back; anything else, and the first update, goes out as soon as there's room
+U32 BfObject::getUpdateInterval(GhostConnection *connection, U32 updateMask)
+{
+   U32 movementMask = getMovementMask();
+
+   if(updateMask == 0xFFFFFFFF || movementMask == 0 || (updateMask & ~movementMask) != 0)
+      return 1;
+
+   return InterestTierUpdateIntervals[getInterestTier(connection)];
+}
+
+
+U32 BfObject::getMovementMask() const
+{
+   return 0;
+}
+
+
+// Positions clients can see are always sent exactly; see ControlObjectConnection::writeCompressedPoint
+U32 BfObject::getPositionQuantization(InterestTier tier) const
+{
+   static const U32 quantization[InterestTierCount] = { 1, 2, 8 };
+   return quantization[tier];
+}
+
+
 void BfObject::damageObject(DamageInfo *theInfo)
 {
    // Do nothing
@@ -1333,6 +1392,51 @@ void BfObject::readCompressedVelocity(Point &vel, U32 max, BitStream *stream)
 }
 
 
+static const U8 SmallBaselineDeltaBits = 6;
+
+
+void BfObject::writeBaselineValue(BitStream *stream, GhostBaseline &baseline, U32 slot, S32 value, U8 deltaBits)
+{
+   S32 delta = value - baseline.values[slot];
+   S32 limit = 1 << (deltaBits - 1);
+
+   if(stream->writeFlag(baseline.isValid(slot) && delta >= -limit && delta < limit))
+   {
+      S32 smallLimit = 1 << (SmallBaselineDeltaBits - 1);
+
+      if(stream->writeFlag(delta >= -smallLimit && delta < smallLimit))
+         stream->writeSignedInt(delta, SmallBaselineDeltaBits);
+      else
+         stream->writeSignedInt(delta, deltaBits);
+   }
+   else if(stream->writeFlag(value >= S16_MIN && value <= S16_MAX))
+      stream->writeSignedInt(value, 16);
+   else
+      stream->writeInt(U32(value), 32);
+
+   baseline.set(slot, value);
+}
+
+
+S32 BfObject::readBaselineValue(BitStream *stream, GhostBaseline &baseline, U32 slot, U8 deltaBits)
+{
+   S32 value;
+
+   if(stream->readFlag())
+   {
+      S32 delta = stream->readSignedInt(stream->readFlag() ? SmallBaselineDeltaBits : deltaBits);
+      value = (baseline.isValid(slot) ? baseline.values[slot] : 0) + delta;
+   }
+   else if(stream->readFlag())
+      value = stream->readSignedInt(16);
+   else
+      value = S32(stream->readInt(32));
+
+   baseline.set(slot, value);
+   return value;
+}
+
+
 void BfObject::onGhostAddBeforeUpdate(GhostConnection *theConnection)
 {
 #ifndef ZAP_DEDICATED
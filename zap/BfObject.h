@@ -18,7 +18,7 @@
 #  pragma warning( disable : 4250)
 #endif
 
-namespace TNL{ class BitStream; }
+namespace TNL{ class BitStream; struct GhostBaseline; }
 
 
 namespace Zap
@@ -290,6 +290,20 @@ public:
 
    F32 getUpdatePriority(GhostConnection *connection, U32 updateMask, S32 updateSkips);
 
+   // How interesting we are to a client, by how far we are from their ship
+   enum InterestTier {
+      InterestNear,        // On their screen
+      InterestMid,         // Just off their screen, but within scope range
+      InterestFar,         // Only in scope through the commander's map or a spy bug
+      InterestTierCount
+   };
+
+   InterestTier getInterestTier(GhostConnection *connection);
+   U32 getUpdateInterval(GhostConnection *connection, U32 updateMask);
+
+   virtual U32 getMovementMask() const;                              // Mask bits that only carry movement
+   virtual U32 getPositionQuantization(InterestTier tier) const;     // Coarsest position step clients in tier need
+
    void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
    void findObjects(TestFunc, Vector<DatabaseObject *> &fillVector, const Rect &extents) const;
 
@@ -334,6 +348,10 @@ public:
    void writeCompressedVelocity(const Point &vel, U32 max, BitStream *stream);
    void readCompressedVelocity(Point &vel, U32 max, BitStream *stream);
 
+   // Values in a GhostBaseline go as small differences from the last update the client acked, when they can
+   static void writeBaselineValue(BitStream *stream, GhostBaseline &baseline, U32 slot, S32 value, U8 deltaBits);
+   static S32 readBaselineValue(BitStream *stream, GhostBaseline &baseline, U32 slot, U8 deltaBits);
+
    virtual bool collide(BfObject *hitObject);
    virtual bool collided(BfObject *otherObject, U32 stateIndex);
 
@@ -19,6 +19,8 @@
 #include <clipper.hpp>
 
 #include <vector>
+#include <queue>
+#include <set>
 #include <math.h>
 
 
@@ -718,6 +720,18 @@ NeighboringZone::NeighboringZone()
 ////////////////////////////////////////
 
 
+// Constructor
+AStar::AStar()
+{
+   mOnClosedList = 0;
+   mOnOpenList = 0;
+   mNextHopZoneCount = 0;
+   mNextHopTargetsDone = 0;
+   mClusterCount = 0;
+   mCorridorId = 0;
+}
+
+
 // Rough guess as to distance from fromZone to toZone
 F32 AStar::heuristic(const Vector<BotNavMeshZone *> *zones, S32 fromZone, S32 toZone)
 {
@@ -725,41 +739,383 @@ F32 AStar::heuristic(const Vector<BotNavMeshZone *> *zones, S32 fromZone, S32 to
 }
 
 
-// Returns a path, including the startZone and targetZone 
-Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target)
+void AStar::clearCache()
 {
-   // Because of these variables...
-   static U16 onClosedList = 0;
-   static U16 onOpenList;
+   mPathCache.clear();
 
-   // ...these arrays can be reused without further initialization
-   static U16 whichList[MAX_ZONES];       // Record whether a zone is on the open or closed list
-   static S16 openList[MAX_ZONES + 1]; 
-   static S16 openZone[MAX_ZONES]; 
-   static S16 parentZones[MAX_ZONES]; 
+   mNextHop.clear();
+   mNextHopZoneCount = 0;
+   mIncoming.clear();
+   mNextHopTargetsDone = 0;
 
-   static F32 Fcost[MAX_ZONES];   
-   static F32 Gcost[MAX_ZONES];    
-   static F32 Hcost[MAX_ZONES];   
+   mZoneCluster.clear();
+   mClusterCount = 0;
+   mClusterNextHop.clear();
+}
 
-   S16 numberOfOpenListItems = 0;
-   bool foundPath;
 
-   S32 newOpenListItemID = 0;         // Used for creating new IDs for zones to make heap work
+S32 AStar::getCacheSize() const
+{
+   return (S32)mPathCache.size();
+}
+
+
+bool AStar::hasNextHopTable() const
+{
+   return mNextHopZoneCount > 0;
+}
+
+
+bool AStar::hasClusters() const
+{
+   return mClusterCount > 0;
+}
+
+
+// Small levels get a next-hop table, built a bit at a time by buildNextHopTable(); bigger ones get clusters, which
+// are quick enough to build right here
+void AStar::prepare(const Vector<BotNavMeshZone *> *zones)
+{
+   clearCache();
+
+   const S32 zoneCount = zones->size();
+
+   if(zoneCount == 0)
+      return;
+
+   if(zoneCount > NextHopTableMaxZones)
+   {
+      buildClusters(zones);
+      return;
+   }
+
+   mIncoming.resize(zoneCount);
+
+   for(S32 i = 0; i < zoneCount; i++)
+   {
+      const Vector<NeighboringZone> &neighbors = zones->get(i)->mNeighbors;
+      for(S32 j = 0; j < neighbors.size(); j++)
+         mIncoming[neighbors[j].zoneID].push_back(pair<S32, F32>(i, neighbors[j].distTo));
+   }
+
+   mNextHop.resize(zoneCount * zoneCount);
+   for(S32 i = 0; i < mNextHop.size(); i++)
+      mNextHop[i] = -1;
+}
+
+
+// Fills in the table for up to maxTargets more target zones.  The table is only used once every target is done.
+bool AStar::buildNextHopTable(S32 maxTargets)
+{
+   const S32 zoneCount = mIncoming.size();
+
+   if(zoneCount == 0)
+      return hasNextHopTable();
+
+   Vector<F32> dist;
+
+   for(S32 i = 0; i < maxTargets && mNextHopTargetsDone < zoneCount; i++)
+      findNextHops(mIncoming, mNextHopTargetsDone++, dist, mNextHop);
+
+   if(mNextHopTargetsDone == zoneCount)
+   {
+      mNextHopZoneCount = zoneCount;
+      mIncoming.clear();
+   }
+
+   return hasNextHopTable();
+}
+
+
+// Runs Dijkstra from target over the reversed graph (teleporters make some links one-way).  Whenever a node is reached
+// from an already-settled neighbor, that neighbor is its next hop toward the target.  Fills column target of nextHop,
+// which is laid out [from * nodeCount + target].
+void AStar::findNextHops(const IncomingLinks &incoming, S32 target, Vector<F32> &dist, Vector<S16> &nextHop)
+{
+   const S32 count = incoming.size();
+
+   typedef pair<F32, S32> QueueItem;
+   priority_queue<QueueItem, vector<QueueItem>, greater<QueueItem> > queue;
+
+   dist.resize(count);
+   for(S32 i = 0; i < count; i++)
+      dist[i] = F32_MAX;
+
+   dist[target] = 0;
+   nextHop[target * count + target] = (S16)target;
+   queue.push(QueueItem(0, target));
+
+   while(!queue.empty())
+   {
+      QueueItem item = queue.top();
+      queue.pop();
+
+      S32 node = item.second;
+      if(item.first > dist[node])      // Stale entry; node was already settled via a shorter route
+         continue;
+
+      const Vector<pair<S32, F32> > &sources = incoming[node];
+      for(S32 i = 0; i < sources.size(); i++)
+      {
+         S32 from = sources[i].first;
+         F32 d = dist[node] + sources[i].second;
+
+         if(d < dist[from])
+         {
+            dist[from] = d;
+            nextHop[from * count + target] = (S16)node;
+            queue.push(QueueItem(d, from));
+         }
+      }
+   }
+}
+
+
+// Grows clusters breadth-first from each zone not yet in one, so every cluster is a connected patch of neighbors,
+// then links clusters whose zones touch, at the distance between their centers, and works out the next hops
+// between all of them
+void AStar::buildClusters(const Vector<BotNavMeshZone *> *zones)
+{
+   const S32 zoneCount = zones->size();
+
+   mZoneCluster.resize(zoneCount);
+   for(S32 i = 0; i < zoneCount; i++)
+      mZoneCluster[i] = -1;
+
+   Vector<Point> centers;
+   Vector<S32> members;
+
+   for(S32 seed = 0; seed < zoneCount; seed++)
+   {
+      if(mZoneCluster[seed] >= 0)
+         continue;
+
+      S32 cluster = centers.size();
+
+      members.clear();
+      members.push_back(seed);
+      mZoneCluster[seed] = (S16)cluster;
+
+      for(S32 i = 0; i < members.size() && members.size() < ClusterSize; i++)
+      {
+         const Vector<NeighboringZone> &neighbors = zones->get(members[i])->mNeighbors;
+
+         for(S32 j = 0; j < neighbors.size() && members.size() < ClusterSize; j++)
+            if(mZoneCluster[neighbors[j].zoneID] < 0)
+            {
+               mZoneCluster[neighbors[j].zoneID] = (S16)cluster;
+               members.push_back(neighbors[j].zoneID);
+            }
+      }
+
+      Point center;
+      for(S32 i = 0; i < members.size(); i++)
+         center += zones->get(members[i])->getCenter();
+
+      centers.push_back(center / (F32)members.size());
+   }
+
+   const S32 clusterCount = centers.size();
 
+   // Fragmented levels could leave us with too many clusters to be worth it; plain A* will have to do
+   if(clusterCount > NextHopTableMaxZones)
+   {
+      mZoneCluster.clear();
+      return;
+   }
+
+   set<pair<S32, S32> > links;
+   for(S32 i = 0; i < zoneCount; i++)
+   {
+      const Vector<NeighboringZone> &neighbors = zones->get(i)->mNeighbors;
+      for(S32 j = 0; j < neighbors.size(); j++)
+         if(mZoneCluster[i] != mZoneCluster[neighbors[j].zoneID])
+            links.insert(pair<S32, S32>(mZoneCluster[i], mZoneCluster[neighbors[j].zoneID]));
+   }
+
+   IncomingLinks incoming;
+   incoming.resize(clusterCount);
+
+   for(set<pair<S32, S32> >::const_iterator it = links.begin(); it != links.end(); it++)
+      incoming[it->second].push_back(pair<S32, F32>(it->first, centers[it->first].distanceTo(centers[it->second])));
+
+   mClusterNextHop.resize(clusterCount * clusterCount);
+   for(S32 i = 0; i < mClusterNextHop.size(); i++)
+      mClusterNextHop[i] = -1;
+
+   Vector<F32> dist;
+   for(S32 target = 0; target < clusterCount; target++)
+      findNextHops(incoming, target, dist, mClusterNextHop);
+
+   mCorridor.resize(clusterCount);
+   for(S32 i = 0; i < clusterCount; i++)
+      mCorridor[i] = 0;
+
+   mCorridorId = 0;
+   mClusterCount = clusterCount;
+}
+
+
+// Produces the same layout as searchPath: target, target zone center, then alternating gateways and
+// zone centers working back toward the start, with the start zone's center last
+Vector<Point> AStar::walkNextHopTable(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target) const
+{
    Vector<Point> path;
 
+   if(mNextHop[startZone * mNextHopZoneCount + targetZone] < 0)
+      return path;      // Unreachable
+
+   Vector<S32> route;   // Zones from start to target
+   route.push_back(startZone);
+
+   S32 zone = startZone;
+   while(zone != targetZone)
+   {
+      zone = mNextHop[zone * mNextHopZoneCount + targetZone];
+      route.push_back(zone);
+   }
+
+   path.push_back(target);
+   path.push_back(zones->get(targetZone)->getCenter());
+
+   for(S32 i = route.size() - 1; i > 0; i--)
+   {
+      path.push_back(findGateway(zones, route[i - 1], route[i]));
+      path.push_back(zones->get(route[i - 1])->getCenter());
+   }
+
+   path.push_back(zones->get(startZone)->getCenter());
+   return path;
+}
+
+
+// Searches only the zones in the clusters on the route from startZone's cluster to targetZone's.  Every zone-level
+// route maps onto a cluster-level one, so if there's no cluster route there's no path at all; the corridor itself
+// can occasionally be blocked inside a cluster, though (one-way teleporters), so we fall back to a full search.
+Vector<Point> AStar::searchCorridor(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target)
+{
+   S32 cluster = mZoneCluster[startZone];
+   S32 targetCluster = mZoneCluster[targetZone];
+
+   if(mClusterNextHop[cluster * mClusterCount + targetCluster] < 0)
+      return Vector<Point>();
+
+   if(mCorridorId == U16_MAX)       // Out of fresh ids; start over
+   {
+      for(S32 i = 0; i < mCorridor.size(); i++)
+         mCorridor[i] = 0;
+      mCorridorId = 0;
+   }
+
+   mCorridorId++;
+
+   mCorridor[cluster] = mCorridorId;
+   while(cluster != targetCluster)
+   {
+      cluster = mClusterNextHop[cluster * mClusterCount + targetCluster];
+      mCorridor[cluster] = mCorridorId;
+   }
+
+   Vector<Point> path = searchPath(zones, startZone, targetZone, target, true);
+
+   if(path.size() == 0)
+      path = searchPath(zones, startZone, targetZone, target);
+
+   return path;
+}
+
+
+// Make sure our scratch arrays are big enough for the current zone set
+void AStar::prepareScratch(S32 zoneCount)
+{
+   if(mWhichList.size() < zoneCount)
+   {
+      mWhichList.resize(zoneCount);          // New items start at 0, which is never onOpenList or onClosedList
+      mParentZones.resize(zoneCount);
+      mGcost.resize(zoneCount);
+
+      // Item IDs are 1-based, and each zone is opened at most once per search
+      mOpenList.resize(zoneCount + 1);
+      mOpenZone.resize(zoneCount + 1);
+      mFcost.resize(zoneCount + 1);
+      mHcost.resize(zoneCount + 1);
+   }
+
    // This block here lets us repeatedly reuse the whichList array without resetting it or recreating it
    // which, for larger numbers of zones should be a real time saver.  It's not clear if it is particularly
    // more efficient for the zone counts we typically see in Bitfighter levels.
-   if(onClosedList > U16_MAX - 3 ) // Reset whichList when we've run out of headroom
+   if(mOnClosedList > U16_MAX - 3) // Reset whichList when we've run out of headroom
    {
-      for(S32 i = 0; i < MAX_ZONES; i++) 
-         whichList[i] = 0;
-      onClosedList = 0;   
+      for(S32 i = 0; i < mWhichList.size(); i++) 
+         mWhichList[i] = 0;
+      mOnClosedList = 0;   
+   }
+   mOnClosedList = mOnClosedList + 2; // Changing the values of onOpenList and onClosed list is faster than redimming whichList() array
+   mOnOpenList = mOnClosedList - 1;
+}
+
+
+// Returns a path, including the startZone and targetZone.  Paths are cached per zone pair; the first point
+// of the returned path is always the passed target.
+Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target)
+{
+   // Table lookups are cheap enough that caching their results would gain us nothing
+   if(mNextHopZoneCount == zones->size() && mNextHopZoneCount > 0)
+      return walkNextHopTable(zones, startZone, targetZone, target);
+
+   pair<S32, S32> pathIndex(startZone, targetZone);
+
+   map<pair<S32, S32>, Vector<Point> >::iterator it = mPathCache.find(pathIndex);
+
+   if(it != mPathCache.end())
+   {
+      Vector<Point> path = it->second;
+
+      if(path.size() > 0)
+         path[0] = target;    // Cached plan was built for whatever target the first requester had
+
+      return path;
    }
-   onClosedList = onClosedList + 2; // Changing the values of onOpenList and onClosed list is faster than redimming whichList() array
-   onOpenList = onClosedList - 1;
+
+   Vector<Point> path;
+
+   if(mZoneCluster.size() == zones->size() && mClusterCount > 0)
+      path = searchCorridor(zones, startZone, targetZone, target);
+   else
+      path = searchPath(zones, startZone, targetZone, target);
+
+   mPathCache[pathIndex] = path;
+
+   return path;
+}
+
+
+// Run the actual search, bypassing the cache.  With useCorridor, only zones in clusters marked by searchCorridor()
+// are considered.
+Vector<Point> AStar::searchPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target,
+                                bool useCorridor)
+{
+   prepareScratch(zones->size());
+
+   // Grab raw pointers to our scratch space to keep the inner loops tight
+   U16 *whichList   = mWhichList.address();
+   S16 *openList    = mOpenList.address();
+   S16 *openZone    = mOpenZone.address();
+   S16 *parentZones = mParentZones.address();
+   F32 *Fcost       = mFcost.address();
+   F32 *Gcost       = mGcost.address();
+   F32 *Hcost       = mHcost.address();
+
+   const U16 onClosedList = mOnClosedList;
+   const U16 onOpenList   = mOnOpenList;
+   const S32 maxItems     = mOpenZone.size() - 1;
+
+   S16 numberOfOpenListItems = 0;
+   bool foundPath;
+
+   S32 newOpenListItemID = 0;         // Used for creating new IDs for zones to make heap work
+
+   Vector<Point> path;
 
    Gcost[startZone] = 0;         // That's the cost of going from the startZone to the startZone!
    Fcost[0] = Hcost[0] = heuristic(zones, startZone, targetZone);
@@ -836,11 +1192,11 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
          // Add these adjacent child squares to the open list
          //   for later consideration if appropriate.
 
-         Vector<NeighboringZone> neighboringZones = zones->get(parentZone)->mNeighbors;
+         const Vector<NeighboringZone> &neighboringZones = zones->get(parentZone)->mNeighbors;
 
          for(S32 a = 0; a < neighboringZones.size(); a++)
          {
-            NeighboringZone zone = neighboringZones[a];
+            const NeighboringZone &zone = neighboringZones[a];
             S32 zoneID = zone.zoneID;
 
             //   Check if zone is already on the closed list (items on the closed list have
@@ -848,9 +1204,12 @@ Vector<Point> AStar::findPath(const Vector<BotNavMeshZone *> *zones, S32 startZo
             if(whichList[zoneID] == onClosedList) 
                continue;
 
+            if(useCorridor && mCorridor[mZoneCluster[zoneID]] != mCorridorId)
+               continue;
+
             //   Add zone to the open list if it's not already on it
-            TNLAssert(newOpenListItemID < MAX_ZONES, "Too many nav zones... try increasing MAX_ZONES!");
-            if(whichList[zoneID] != onOpenList && newOpenListItemID < MAX_ZONES) 
+            TNLAssert(newOpenListItemID < maxItems, "More open list items than zones!");
+            if(whichList[zoneID] != onOpenList && newOpenListItemID < maxItems) 
             {   
                // Create a new open list item in the binary heap
                newOpenListItemID = newOpenListItemID + 1;   // Give each new item a unique id
@@ -9,6 +9,10 @@
 #include "gridDB.h"            // Parent
 #include "../recast/Recast.h"  // for rcPolyMesh;
 
+#include <map>
+
+using namespace std;
+
 namespace Zap
 {
 
@@ -96,15 +100,79 @@ public:
 ////////////////////////////////////////
 ////////////////////////////////////////
 
+// A* pathfinder over the bot nav zones.  All scratch state lives in the object, so separate instances
+// can be used concurrently (one per thread).  Completed paths are cached by (startZone, targetZone);
+// the cache must be cleared whenever the zones are rebuilt, i.e. on level change.
+//
+// prepare() readies the planner for a new set of zones.  On levels with few enough zones, it starts a table
+// holding the first step of the shortest path between every pair of zones; buildNextHopTable() fills it in a
+// few target zones at a time, and once it's done findPath() just walks the table rather than searching.  Larger
+// levels get a two-level graph instead: neighboring zones are grouped into clusters of around ClusterSize, with
+// a next-hop table between clusters, and a search only considers zones in the clusters along that route.
 class AStar
 {
+public:
+   static const S32 NextHopTableMaxZones = 1000;   // Table is zones^2 entries, 2MB at this size
+   static const S32 NextHopTargetsPerTick = 16;    // Rows of the table built by each buildNextHopTable() call
+   static const S32 ClusterSize = 32;              // Zones per cluster on levels too big for the table
+
 private:
+   // Because of these counters, the scratch arrays can be reused without further initialization
+   U16 mOnClosedList;
+   U16 mOnOpenList;
+
+   Vector<U16> mWhichList;       // Record whether a zone is on the open or closed list
+   Vector<S16> mOpenList;        // Binary heap of open list item IDs (1-based)
+   Vector<S16> mOpenZone;        // Zone for each open list item ID
+   Vector<S16> mParentZones;     // Zone we came from, indexed by zone
+
+   Vector<F32> mFcost;           // Indexed by open list item ID
+   Vector<F32> mGcost;           // Indexed by zone
+   Vector<F32> mHcost;           // Indexed by open list item ID
+
+   map<pair<S32, S32>, Vector<Point> > mPathCache;    // Zone-to-zone flight plans, shared by all bots
+
+   typedef Vector<Vector<pair<S32, F32> > > IncomingLinks;     // For each node, who can get there, and at what cost
+
+   Vector<S16> mNextHop;         // [startZone * zoneCount + targetZone] -> next zone on route, -1 if unreachable
+   S32 mNextHopZoneCount;        // Set once the table is complete
+   IncomingLinks mIncoming;      // Reversed zone graph, kept while the table is being built
+   S32 mNextHopTargetsDone;
+
+   Vector<S16> mZoneCluster;     // Cluster each zone belongs to
+   S32 mClusterCount;
+   Vector<S16> mClusterNextHop;  // [startCluster * mClusterCount + targetCluster] -> next cluster on route, -1 if unreachable
+   Vector<U16> mCorridor;        // Clusters the current search may use are marked with mCorridorId
+   U16 mCorridorId;
+
+   void prepareScratch(S32 zoneCount);
+   Vector<Point> searchPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target,
+                            bool useCorridor = false);
+   Vector<Point> searchCorridor(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target);
+   Vector<Point> walkNextHopTable(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target) const;
+
+   void buildClusters(const Vector<BotNavMeshZone *> *zones);
+
+   static void findNextHops(const IncomingLinks &incoming, S32 target, Vector<F32> &dist, Vector<S16> &nextHop);
    static F32 heuristic(const Vector<BotNavMeshZone *> *zones, S32 fromZone, S32 toZone);
    static Point findGateway(const Vector<BotNavMeshZone *> *zones, S32 zone1, S32 zone2);
 
 public:
-   static Vector<Point> findPath (const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target);
-   
+   AStar();    // Constructor
+
+   // Returns a path, including the startZone and targetZone, with target as the first point; uses cache when possible
+   Vector<Point> findPath(const Vector<BotNavMeshZone *> *zones, S32 startZone, S32 targetZone, const Point &target);
+
+   void clearCache();            // Forgets everything about the current zones
+   S32 getCacheSize() const;
+
+   // Call whenever the zones are rebuilt
+   void prepare(const Vector<BotNavMeshZone *> *zones);
+
+   // Builds a few more rows of the next-hop table, if prepare() started one; returns true once it's complete
+   bool buildNextHopTable(S32 maxTargets = NextHopTargetsPerTick);
+   bool hasNextHopTable() const;
+   bool hasClusters() const;
 };
 
 
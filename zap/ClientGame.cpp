@@ -13,6 +13,7 @@
 #include "IniFile.h"             // For CIniFile def
 
 #include "barrier.h"
+#include "Compression.h"
 #include "gameType.h"
 #include "UIEditor.h"
 #include "UIManager.h"
@@ -26,6 +27,7 @@
 #include "GameRecorderPlayback.h"
 
 #include "Colors.h"
+#include "Md5Utils.h"
 #include "stringUtils.h"
 
 #include <boost/shared_ptr.hpp>
@@ -62,7 +64,9 @@ static void initializeHelpItemForObjects()
 
 
 // Constructor
-ClientGame::ClientGame(const Address &bindAddress, GameSettingsPtr settings, UIManager *uiManager) : Game(bindAddress, settings)
+ClientGame::ClientGame(const Address &bindAddress, GameSettingsPtr settings, UIManager *uiManager) : 
+   Game(bindAddress, settings), 
+   mWallCache("wallcache")
 {
    mRemoteLevelDownloadFilename = "downloaded.level";
 
@@ -255,13 +259,83 @@ void ClientGame::startLoadingLevel(bool engineerEnabled)
 void ClientGame::doneLoadingLevel()
 {
    computeWorldObjectExtents();              // Make sure our world extents reflect all the objects we've loaded
-   Barrier::prepareRenderingGeometry(this);  // Get walls ready to render
+
+   // Get walls ready to render, unless we've done it for these walls before
+   if(mWallCache.hasWallEdges)
+      Barrier::mRenderLineSegments = mWallCache.wallEdgePoints;
+   else
+   {
+      Barrier::prepareRenderingGeometry(this);
+
+      if(mWallCache.hasWallGeometry)
+      {
+         mWallCache.setWallEdges(Barrier::mRenderLineSegments);
+         mWallCache.write(mWallCacheHash);
+      }
+   }
+
+   forgetWallGeometry();
 
    mUIManager->doneLoadingLevel();
    mUIManager->updateLeadingPlayerAndScore();
 }
 
 
+// Server is offering us a level's walls -- if we've seen them before, add them from our cache and return true
+bool ClientGame::loadCachedWallGeometry(const string &hash)
+{
+   forgetWallGeometry();
+
+   if(!mWallCache.read(hash) || !mWallCache.hasWallGeometry || !mWallCache.hasWallEdges || 
+         !Barrier::unpackWallGeometry(this, mWallCache.wallGeometry))
+   {
+      mWallCache.clear();
+      return false;
+   }
+
+   mWallCacheHash = hash;
+   return true;
+}
+
+
+// Server has sent us the walls we didn't have; keep them around so doneLoadingLevel() can cache them along
+// with their edges
+void ClientGame::setWallGeometry(const string &hash, const Vector<ByteBufferPtr> &compressedGeometry)
+{
+   static const U32 MaxWallGeometrySize = 32 * 1024 * 1024;
+
+   forgetWallGeometry();
+
+   Vector<U8> compressed, geometry;
+   joinChunks(compressedGeometry, compressed);
+
+   if(!uncompressBuffer(compressed.address(), compressed.size(), MaxWallGeometrySize, geometry))
+   {
+      logprintf(LogConsumer::LogError, "Could not decompress walls sent by the server");
+      return;
+   }
+
+   Md5::IncrementalHasher md5;
+   md5.add((const char *)geometry.address(), geometry.size());
+
+   if(md5.getHash() != hash || !Barrier::unpackWallGeometry(this, geometry))
+   {
+      logprintf(LogConsumer::LogError, "Walls sent by the server were damaged");
+      return;
+   }
+
+   mWallCache.setWallGeometry(geometry);
+   mWallCacheHash = hash;
+}
+
+
+void ClientGame::forgetWallGeometry()
+{
+   mWallCache.clear();
+   mWallCacheHash = "";
+}
+
+
 ClientInfo *ClientGame::getClientInfo() const
 {
    return mClientInfo;
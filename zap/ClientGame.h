@@ -18,6 +18,7 @@
 #include "SparkTypesEnum.h"
 #include "gameConnection.h"
 #include "MasterTypes.h"
+#include "LevelCache.h"
 
 
 #ifdef TNL_OS_WIN32
@@ -58,6 +59,9 @@ private:
 
    string mPreviousLevelName;    // For /prevlevel command
 
+   LevelCache mWallCache;        // Walls the server has sent us, and the edges we built from them
+   string mWallCacheHash;
+
    bool needsRating() const;
 
    static PersonalRating getNextRating(PersonalRating currentRating);
@@ -112,6 +116,10 @@ public:
    void startLoadingLevel(bool engineerEnabled);
    void doneLoadingLevel();
 
+   bool loadCachedWallGeometry(const string &hash);
+   void setWallGeometry(const string &hash, const Vector<ByteBufferPtr> &compressedGeometry);
+   void forgetWallGeometry();
+
    void gotTotalLevelRating(S16 rating);
    void gotPlayerLevelRating(S32 rating);
 
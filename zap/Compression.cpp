@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "Compression.h"
+
+#include "tnlMethodDispatch.h"      // For ByteBufferSizeBitSize
+
+#include "zlib.h"
+
+#include <string.h>
+
+namespace Zap
+{
+
+static const U32 HeaderSize = 4;
+static const U32 MaxChunkSize = (1 << Types::ByteBufferSizeBitSize) - 1;
+
+
+bool compressBuffer(const U8 *data, U32 size, Vector<U8> &compressed, bool fast)
+{
+   uLongf compressedSize = compressBound(size);
+
+   compressed.resize(HeaderSize + compressedSize);
+
+   // Uncompressed size, little-endian
+   for(U32 i = 0; i < HeaderSize; i++)
+      compressed[i] = U8(size >> (i * 8));
+
+   if(compress2(compressed.address() + HeaderSize, &compressedSize, data, size, fast ? Z_BEST_SPEED : Z_BEST_COMPRESSION) != Z_OK)
+   {
+      compressed.clear();
+      return false;
+   }
+
+   compressed.resize(HeaderSize + compressedSize);
+   return true;
+}
+
+
+bool uncompressBuffer(const U8 *data, U32 size, U32 maxSize, Vector<U8> &uncompressed)
+{
+   uncompressed.clear();
+
+   if(size < HeaderSize)
+      return false;
+
+   U32 expectedSize = 0;
+   for(U32 i = 0; i < HeaderSize; i++)
+      expectedSize |= U32(data[i]) << (i * 8);
+
+   if(expectedSize > maxSize)
+      return false;
+
+   uncompressed.resize(expectedSize);
+
+   uLongf uncompressedSize = expectedSize;
+   if(uncompress(uncompressed.address(), &uncompressedSize, data + HeaderSize, size - HeaderSize) != Z_OK ||
+         uncompressedSize != expectedSize)
+   {
+      uncompressed.clear();
+      return false;
+   }
+
+   return true;
+}
+
+
+void splitIntoChunks(const Vector<U8> &data, Vector<ByteBufferPtr> &chunks)
+{
+   chunks.clear();
+
+   for(S32 i = 0; i < data.size(); i += MaxChunkSize)
+   {
+      U32 chunkSize = getMin(U32(data.size() - i), MaxChunkSize);
+
+      ByteBuffer *chunk = new ByteBuffer(chunkSize);
+      memcpy(chunk->getBuffer(), data.address() + i, chunkSize);
+      chunks.push_back(ByteBufferPtr(chunk));
+   }
+}
+
+
+void joinChunks(const Vector<ByteBufferPtr> &chunks, Vector<U8> &data)
+{
+   U32 size = 0;
+   for(S32 i = 0; i < chunks.size(); i++)
+      size += chunks[i]->getBufferSize();
+
+   data.resize(size);
+
+   U32 pos = 0;
+   for(S32 i = 0; i < chunks.size(); i++)
+   {
+      memcpy(data.address() + pos, chunks[i]->getBuffer(), chunks[i]->getBufferSize());
+      pos += chunks[i]->getBufferSize();
+   }
+}
+
+
+}
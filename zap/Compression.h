@@ -0,0 +1,30 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _COMPRESSION_H_
+#define _COMPRESSION_H_
+
+#include "tnlByteBuffer.h"
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+using namespace TNL;
+
+namespace Zap
+{
+
+// zlib wrappers for sending and storing big lumps of data.  Compressed buffers start with the uncompressed
+// size, so uncompressBuffer() knows how much room to make, and can refuse anything bigger than maxSize.  Use fast
+// when compressing while the game is running.
+bool compressBuffer(const U8 *data, U32 size, Vector<U8> &compressed, bool fast = false);
+bool uncompressBuffer(const U8 *data, U32 size, U32 maxSize, Vector<U8> &uncompressed);
+
+// A single ByteBufferPtr RPC argument can only hold about 1K, so bigger buffers travel as a Vector of chunks
+void splitIntoChunks(const Vector<U8> &data, Vector<ByteBufferPtr> &chunks);
+void joinChunks(const Vector<ByteBufferPtr> &chunks, Vector<U8> &data);
+
+}
+
+#endif
@@ -91,6 +91,12 @@
    SETTINGS_ITEM(YesNo,              GameRecordingDownload,    "Host",           "GameRecordingDownload",    No,                              NULL,     NULL,     "If Yes, other players can download")                                                                                           \
    SETTINGS_ITEM(U32,                MaxFpsServer,             "Host",           "MaxFPS",                   100,                             NULL,     NULL,     "Maximum FPS the dedicated server will run at.  Higher values use more CPU (and power), lower may increase lag.\n"              \
                                                                                                                                                                   "Specify 0 for no limit. Negative values will not make Bitfighter run backwards.  Sorry.  (default = 100)")                     \
+   SETTINGS_ITEM(YesNo,              ScriptBytecodeCache,      "Host",           "ScriptBytecodeCache",      No,                              NULL,     NULL,     "If Yes, compiled bots and levelgens are saved in the scriptcache folder, so they don't need to be recompiled after a restart.")\
+   SETTINGS_ITEM(YesNo,              LevelCache,               "Host",           "LevelCache",               No,                              NULL,     NULL,     "If Yes, wall edges and bot zones for each level, and walls downloaded from servers, are saved in the levelcache folder, so they don't need to be rebuilt or downloaded again.")\
+   SETTINGS_ITEM(U32,                ScriptTimeBudget,         "Host",           "ScriptTimeBudget",         0,                               NULL,     NULL,     "Milliseconds a bot or levelgen event handler may run before the script is throttled for a few ticks.  0 disables the limit.")  \
+   SETTINGS_ITEM(U32,                ScriptInstructionBudget,  "Host",           "ScriptInstructionBudget",  0,                               NULL,     NULL,     "Lua instructions a bot or levelgen event handler may execute before being throttled; handlers using 20 times this are stopped.  0 disables counting.")\
+   SETTINGS_ITEM(S32,                LuaGcPause,               "Host",           "LuaGCPause",               200,                             NULL,     NULL,     "How long the Lua garbage collector waits between cycles, as a percentage of memory in use after the last one.  Lower collects more often.")\
+   SETTINGS_ITEM(S32,                LuaGcStepMul,             "Host",           "LuaGCStepMul",             200,                             NULL,     NULL,     "How aggressively the Lua garbage collector works relative to allocation, in percent.  Higher means shorter but more intrusive cycles.")\
    MYSQL_SETTINGS_TABLE_ENTRY                                                                                                                                                                                                                                                                     \
                                                                                                                                                                                                                                                                                                   \
    SETTINGS_ITEM(YesNo,              VotingEnabled,            "Host-Voting",    "VoteEnable",               No,                              NULL,     NULL,     "Enable voting on this server")                                                                                                 \
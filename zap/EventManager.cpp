@@ -27,9 +27,13 @@ namespace Zap
 struct Subscription {
    LuaScriptRunner *subscriber;
    ScriptContext context;
+   bool batched;              // True if the script has a batch handler for this event
 };
 
 
+#define EVENT_QUEUE_KEY "event_queues"
+
+
 // Statics:
 bool EventManager::anyPending = false; 
 static Vector<Subscription>      subscriptions         [EventManager::EventTypes];
@@ -63,6 +67,8 @@ EventManager::EventManager()
 
    mIsPaused = false;
    mStepCount = -1;
+   mTickPassRunning = true;
+   mBatchDepth = 0;
    mConstructed = true;
 }
 
@@ -121,16 +127,25 @@ void EventManager::subscribe(LuaScriptRunner *subscriber, EventType eventType, S
       return;
    }
 
+   lua_pop(L, -1);    // Remove function from stack                                  -- <<empty stack>>
+
    removeFromPendingUnsubscribeList(subscriber, eventType);
 
    Subscription s;
    s.subscriber = subscriber;
    s.context = context;
+   s.batched = false;
+
+   // See if the script would rather get this event in batches
+   if(isBatchable(eventType))
+   {
+      string batchFunction = string(eventDefs[eventType].function) + "Batch";
+      s.batched = LuaScriptRunner::loadFunction(L, subscriber->getScriptId(), batchFunction.c_str());    // -- function?
+      clearStack(L);                                                                               // -- <<empty stack>>
+   }
 
    pendingSubscriptions[eventType].push_back(s);
    anyPending = true;
-
-   lua_pop(L, -1);    // Remove function from stack                                  -- <<empty stack>>
 }
 
 
@@ -273,8 +288,49 @@ void EventManager::fireEvent(EventType eventType, U32 deltaT)
 
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
-      lua_pushinteger(L, deltaT);   // -- deltaT
-      fire(L, subscriptions[eventType][i].subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+      LuaScriptRunner *subscriber = subscriptions[eventType][i].subscriber;
+
+      // Scripts that went over budget sit out a few ticks, and get the missed time on the next one they run
+      if(eventType == TickEvent && subscriber->deferTick(deltaT))
+         continue;
+
+      lua_pushinteger(L, deltaT + subscriber->getDeferredTickTime());   // -- deltaT
+      fire(L, subscriber, eventDefs[eventType].function, subscriptions[eventType][i].context);
+   }
+}
+
+
+// onTick, for a single group of subscribers.  This doesn't save any work -- every subscriber still gets onTick
+// once per pass through the groups -- but servers with many bots fire each group on a separate sub-tick, so the
+// script work is staggered over several frames rather than arriving all at once.
+void EventManager::fireTickEvent(U32 deltaT, S32 tickGroup)
+{
+   // A step is a full pass through all the groups, as it was when everyone ticked together.  The decision is made
+   // at the first group, and the rest of the pass follows it, so steps never start or stop partway through.
+   if(tickGroup == 0)
+   {
+      mTickPassRunning = !mIsPaused || mStepCount > 0;
+
+      if(mTickPassRunning)
+         mStepCount--;
+   }
+
+   if(!mTickPassRunning || subscriptions[TickEvent].size() == 0)
+      return;
+
+   lua_State *L = LuaScriptRunner::getL();
+
+   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
+   for(S32 i = 0; i < subscriptions[TickEvent].size(); i++)
+   {
+      LuaScriptRunner *subscriber = subscriptions[TickEvent][i].subscriber;
+
+      if(subscriber->getTickGroup() != tickGroup || subscriber->deferTick(deltaT))
+         continue;
+
+      lua_pushinteger(L, deltaT + subscriber->getDeferredTickTime());   // -- deltaT
+      fire(L, subscriber, eventDefs[TickEvent].function, subscriptions[TickEvent][i].context);
    }
 }
 
@@ -307,8 +363,30 @@ void EventManager::fireEvent(EventType eventType, Ship *ship, BfObject *damaging
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
+   bool queued = isQueueing(eventType);
+
+   if(queued)
+   {
+      ship->push(L);                // -- ship
+
+      if(damagingObject)
+         damagingObject->push(L);   // -- ship, damagingObject
+      else
+         lua_pushnil(L);
+
+      if(shooter)
+         shooter->push(L);          // -- ship, damagingObject, shooter
+      else
+         lua_pushnil(L);
+
+      queueEvent(L, eventType, NULL);
+   }
+
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(queued && subscriptions[eventType][i].batched)    // Will get this one at the end of the batch
+         continue;
+
       ship->push(L);                // -- ship
 
       if(damagingObject)
@@ -337,11 +415,30 @@ void EventManager::fireEvent(LuaScriptRunner *sender, EventType eventType, const
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
+   bool queued = isQueueing(eventType);
+
+   if(queued)
+   {
+      lua_pushstring(L, message);   // -- message
+
+      if(playerInfo)
+         playerInfo->push(L);       // -- message, playerInfo
+      else
+         lua_pushnil(L);            
+
+      lua_pushboolean(L, global);   // -- message, player, isGlobal
+
+      queueEvent(L, eventType, sender);
+   }
+
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
       if(sender == subscriptions[eventType][i].subscriber)    // Don't alert sender about own message!
          continue;
 
+      if(queued && subscriptions[eventType][i].batched)
+         continue;
+
       lua_pushstring(L, message);   // -- message
 
       if(playerInfo)
@@ -387,8 +484,23 @@ void EventManager::fireEvent(EventType eventType, Ship *ship, Zone *zone)
 
    TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
 
+   bool queued = isQueueing(eventType);
+
+   if(queued)
+   {
+      ship->push(L);                                     // -- ship
+      zone->push(L);                                     // -- ship, zone   
+      lua_pushinteger(L, zone->getObjectTypeNumber());   // -- ship, zone, zone->objTypeNumber
+      lua_pushinteger(L, zone->getUserAssignedId());     // -- ship, zone, zone->objTypeNumber, zone->id
+
+      queueEvent(L, eventType, NULL);
+   }
+
    for(S32 i = 0; i < subscriptions[eventType].size(); i++)
    {
+      if(queued && subscriptions[eventType][i].batched)
+         continue;
+
       try   
       {
          // Passing ship, zone, zoneType, zoneId
@@ -439,7 +551,185 @@ void EventManager::fireEvent(EventType eventType, S32 score, S32 team, LuaPlayer
 bool EventManager::fire(lua_State *L, LuaScriptRunner *scriptRunner, const char *function, ScriptContext context)
 {
    setScriptContext(L, context);
-   return scriptRunner->runCmd(function, 0);
+   return scriptRunner->runCmd(function, 0, true);     // Event handlers are held to the script budgets
+}
+
+
+bool EventManager::isBatchable(EventType eventType)
+{
+   return eventType == ShipKilledEvent || eventType == MsgReceivedEvent || 
+          eventType == ShipEnteredZoneEvent || eventType == ShipLeftZoneEvent;
+}
+
+
+// True if eventType should be queued for the batch handlers, rather than fired at them right away.  Scripts with
+// only a regular handler always get their events immediately, so they see them in the order they happened.
+bool EventManager::isQueueing(EventType eventType) const
+{
+   if(mBatchDepth == 0)
+      return false;
+
+   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
+      if(subscriptions[eventType][i].batched)
+         return true;
+
+   return false;
+}
+
+
+// Number of args the regular (non-batch) handler for a batchable event takes
+S32 EventManager::getEventArgCount(EventType eventType)
+{
+   switch(eventType)
+   {
+      case ShipKilledEvent:
+      case MsgReceivedEvent:
+         return 3;
+
+      case ShipEnteredZoneEvent:
+      case ShipLeftZoneEvent:
+         return 4;
+
+      default:
+         TNLAssert(false, "Not a batchable event!");
+         return 0;
+   }
+}
+
+
+// Moves the event's args from the stack into a table, and adds that to the queue for eventType.  The queues
+// are kept in a table in the registry, indexed by event type.
+void EventManager::queueEvent(lua_State *L, EventType eventType, LuaScriptRunner *excluded)
+{
+   S32 argCount = getEventArgCount(eventType);
+
+   TNLAssert(lua_gettop(L) == argCount || dumpStack(L), "Expected only the event args on the stack!");
+
+   lua_createtable(L, argCount, 0);                  // -- <<args>>, event
+   lua_insert(L, 1);                                 // -- event, <<args>>
+
+   for(S32 i = argCount; i >= 1; i--)
+      lua_rawseti(L, 1, i);                          // -- event
+
+   lua_getfield(L, LUA_REGISTRYINDEX, EVENT_QUEUE_KEY);  // -- event, queues
+   if(lua_isnil(L, -1))
+   {
+      lua_pop(L, 1);                                 // -- event
+      lua_newtable(L);                               // -- event, queues
+      lua_pushvalue(L, -1);                          // -- event, queues, queues
+      lua_setfield(L, LUA_REGISTRYINDEX, EVENT_QUEUE_KEY);  // -- event, queues
+   }
+
+   lua_rawgeti(L, -1, eventType);                    // -- event, queues, queue
+   if(lua_isnil(L, -1))
+   {
+      lua_pop(L, 1);                                 // -- event, queues
+      lua_newtable(L);                               // -- event, queues, queue
+      lua_pushvalue(L, -1);                          // -- event, queues, queue, queue
+      lua_rawseti(L, -3, eventType);                 // -- event, queues, queue
+   }
+
+   lua_pushvalue(L, 1);                              // -- event, queues, queue, event
+   lua_rawseti(L, -2, mEventQueues[eventType].excluded.size() + 1);   // -- event, queues, queue
+
+   clearStack(L);                                    // -- <<empty stack>>
+
+   mEventQueues[eventType].excluded.push_back(excluded);
+}
+
+
+void EventManager::beginEventBatch()
+{
+   mBatchDepth++;
+}
+
+
+// Events fired by handlers while we're dispatching go out immediately, as they would outside a batch
+void EventManager::endEventBatch()
+{
+   TNLAssert(mBatchDepth > 0, "Unbalanced endEventBatch()!");
+
+   mBatchDepth--;
+   if(mBatchDepth > 0)
+      return;
+
+   lua_State *L = NULL;
+
+   for(S32 i = 0; i < EventTypes; i++)
+   {
+      if(mEventQueues[i].excluded.size() == 0)
+         continue;
+
+      if(!L)
+         L = LuaScriptRunner::getL();
+
+      Vector<LuaScriptRunner *> excluded = mEventQueues[i].excluded;
+      mEventQueues[i].excluded.clear();
+
+      // Take the queue out of the registry, so it can't be touched by anything our handlers do
+      lua_getfield(L, LUA_REGISTRYINDEX, EVENT_QUEUE_KEY);  // -- queues
+      lua_rawgeti(L, -1, i);                            // -- queues, queue
+      lua_pushnil(L);                                   // -- queues, queue, nil
+      lua_rawseti(L, -3, i);                            // -- queues, queue
+      lua_remove(L, -2);                                // -- queue
+      S32 queueRef = luaL_ref(L, LUA_REGISTRYINDEX);    // -- <<empty stack>>
+
+      dispatchQueuedEvents(L, (EventType)i, queueRef, excluded);
+
+      luaL_unref(L, LUA_REGISTRYINDEX, queueRef);
+   }
+}
+
+
+// Hands the queued events to the scripts with a batch handler; everyone else got them when they were fired.  Each
+// script gets its own copy of the list and of every event in it, so nothing one handler does to its tables can be
+// seen by the next.
+void EventManager::dispatchQueuedEvents(lua_State *L, EventType eventType, S32 queueRef, const Vector<LuaScriptRunner *> &excluded)
+{
+   S32 argCount = getEventArgCount(eventType);
+   string batchFunction = string(eventDefs[eventType].function) + "Batch";
+
+   TNLAssert(lua_gettop(L) == 0 || dumpStack(L), "Stack dirty!");
+
+   for(S32 i = 0; i < subscriptions[eventType].size(); i++)
+   {
+      if(!subscriptions[eventType][i].batched)
+         continue;
+
+      LuaScriptRunner *subscriber = subscriptions[eventType][i].subscriber;
+
+      lua_createtable(L, excluded.size(), 0);            // -- events
+      lua_rawgeti(L, LUA_REGISTRYINDEX, queueRef);       // -- events, queue
+
+      S32 count = 0;
+      for(S32 j = 0; j < excluded.size(); j++)
+      {
+         if(excluded[j] == subscriber)                   // Skip the events this script shouldn't see
+            continue;
+
+         lua_rawgeti(L, 2, j + 1);                       // -- events, queue, event
+         lua_createtable(L, argCount, 0);                // -- events, queue, event, copy
+
+         for(S32 k = 1; k <= argCount; k++)
+         {
+            lua_rawgeti(L, 3, k);                        // -- events, queue, event, copy, arg
+            lua_rawseti(L, 4, k);                        // -- events, queue, event, copy
+         }
+
+         lua_rawseti(L, 1, ++count);                     // -- events, queue, event
+         lua_pop(L, 1);                                  // -- events, queue
+      }
+
+      lua_pop(L, 1);                                     // -- events
+
+      if(count == 0)
+      {
+         lua_pop(L, 1);                                  // -- <<empty stack>>
+         continue;
+      }
+
+      fire(L, subscriber, batchFunction.c_str(), subscriptions[eventType][i].context);
+   }
 }
 
 
@@ -35,6 +35,12 @@ class EventManager
  *
  * See the \e subscribe methods for \link Robot::subscribe bots\endlink and \link LuaLevelGenerator::subscribe levelGens \endlink, and the 
  * \e Events section of the scripting overview page.
+ * 
+ * ShipKilled, MsgReceived, ShipEnteredZone and ShipLeftZone events often come in bursts.  A script can handle
+ * these more cheaply by also defining a handler with \e Batch appended to its name, such as
+ * \e onShipKilledBatch(events).  It is called once per game tick with a table of that tick's events, each of
+ * which is a table holding the usual handler arguments.  Scripts that only define the regular handler see no
+ * difference.
  */
 
 // See http://stackoverflow.com/questions/6635851/real-world-use-of-x-macros
@@ -77,12 +83,30 @@ private:
 
    void handleEventFiringError(lua_State *L, const Subscription &subscriber, EventType eventType, const char *errorMsg);
    bool fire(lua_State *L, LuaScriptRunner *scriptRunner, const char *function, ScriptContext context);
+
+   // Events that tend to arrive in bursts are queued while a batch is open, and handed to each subscriber together
+   struct EventQueue
+   {
+      Vector<LuaScriptRunner *> excluded;    // For each queued event, a script that should not hear about it, or NULL
+   };
+
+   EventQueue mEventQueues[EventTypes];      // The events themselves live in a Lua table, see queueEvent()
+   S32 mBatchDepth;
+
+   static bool isBatchable(EventType eventType);
+   bool isQueueing(EventType eventType) const;
+   static S32 getEventArgCount(EventType eventType);
+   void queueEvent(lua_State *L, EventType eventType, LuaScriptRunner *excluded);
+   void dispatchQueuedEvents(lua_State *L, EventType eventType, S32 queueRef, const Vector<LuaScriptRunner *> &excluded);
       
    bool mIsPaused;
    S32 mStepCount;           // If running for a certain number of steps, this will be > 0, while mIsPaused will be true
+   bool mTickPassRunning;    // Does the current pass through the tick groups get to run?  Decided at group 0.
    static bool mConstructed;
 
 public:
+   static const S32 TickGroups = 4;      // Tick subscribers are split into this many groups, fired one after another
+
    EventManager();                       // C++ constructor
    explicit EventManager(lua_State *L);  // Lua Constructor
    virtual ~EventManager();
@@ -107,6 +131,7 @@ public:
    // We'll have several different signatures for this one...
    void fireEvent(EventType eventType);
    void fireEvent(EventType eventType, U32 deltaT);      // Tick
+   void fireTickEvent(U32 deltaT, S32 tickGroup);        // Tick, but only for scripts in tickGroup
    void fireEvent(EventType eventType, Ship *ship);      // ShipSpawned
    void fireEvent(EventType eventType, Ship *ship, BfObject *damagingObject, BfObject *shooter);  // ShipKilled
    void fireEvent(LuaScriptRunner *sender, EventType eventType, const char *message, LuaPlayerInfo *playerInfo, bool global);  // MsgReceived
@@ -114,6 +139,10 @@ public:
    void fireEvent(EventType eventType, Ship *ship, Zone *zone); // ShipEnteredZoneEvent, ShipLeftZoneEvent
    void fireEvent(EventType eventType, S32 score, S32 team, LuaPlayerInfo *playerInfo);
 
+   // While a batch is open, bursty events are queued, then dispatched when the outermost batch ends
+   void beginEventBatch();
+   void endEventBatch();
+
    // Allow the pausing of event firing for debugging purposes
    void setPaused(bool isPaused);
    void togglePauseStatus();
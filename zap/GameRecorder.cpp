@@ -9,8 +9,9 @@
 #include "gameType.h"
 #include "ServerGame.h"
 #include "stringUtils.h"
-#include "tnlThread.h"
+#include "tnlAsyncWriter.h"
 #include "Level.h"
+#include "Compression.h"
 
 #ifndef ZAP_DEDICATED
 #  include "ClientGame.h"
@@ -26,93 +27,6 @@ namespace Zap
 
 
 
-// fwrite might have multiple 1-second freeze on VPS server or heavy disk access
-// Having fwrite in separate thread might fix the game from freezing/lagging
-// if run in VPS server or with heavy disk access
-
-class WriteBufferThread : public Thread
-{
-private:
-   FILE *f;
-   U32 lastPos;
-   U32 currPos;
-   U8 buffer[1024*128];
-   TNL::Semaphore sem1;
-   U32 threadPos;
-   bool exitNow;
-public:
-
-   WriteBufferThread(FILE *file)
-   {
-      TNLAssert(file != 0, "Must have a file handle");
-      lastPos = 0;
-      currPos = 0;
-      threadPos = 0;
-      exitNow = false;
-      f = file;
-      if(!start())
-      {
-         logprintf(LogConsumer::LogWarning, "Failed to create thread for recorder, games may not record");
-         fclose(f);
-         f = NULL;
-      }
-   }
-   ~WriteBufferThread()
-   {
-      exitNow = true;
-      sem1.increment();
-      while(f != 0)         // Wait until the other thread is done
-         Platform::sleep(1);
-   }
-
-
-   U8 *getBuffer(U32 size)
-   {
-      if(currPos + size > sizeof(buffer))
-      {
-         lastPos = currPos;
-         currPos = 0;
-      }
-      U32 t = threadPos;
-      while(t > currPos && t < currPos + size) // Buffer too full, waiting...
-      {
-         Platform::sleep(1);
-         t = threadPos;
-      }
-      return &buffer[currPos];
-   }
-   void addBuffer(U32 size)
-   {
-      currPos += size;
-      sem1.increment();
-   }
-
-   U32 run()
-   {
-      U32 currPos1 = currPos; // currPos could change anytime by other thread
-      while(!exitNow || currPos1 != threadPos)
-      {
-         if(currPos1 < threadPos)
-         {
-
-            fwrite(&buffer[threadPos], 1, lastPos - threadPos, f);
-            threadPos = 0;
-         }
-         else if(currPos1 > threadPos)
-         {
-            fwrite(&buffer[threadPos], 1, currPos1 - threadPos, f);
-            threadPos = currPos1;
-         }
-         else
-            sem1.wait();  // Waits until sem1.increment
-         currPos1 = currPos;
-      }
-      fclose(f);
-      f = 0;
-      return 0;
-   }
-};
-
 static void gameRecorderScoping(GameRecorderServer *conn, Game *game)
 {
    GameType *gt = game->getGameType();
@@ -155,12 +69,22 @@ static string newRecordingFileName(const string &dir, const string &levelName, c
    return file;
 }
 
+static void writeU32(U8 *dest, U32 value)
+{
+   for(U32 i = 0; i < 4; i++)
+      dest[i] = U8(value >> (i * 8));
+}
+
+
 // Constructor
 GameRecorderServer::GameRecorderServer(ServerGame *game)
 {
    mWriter = NULL;
    mGame = game;
    mMilliSeconds = 0;
+   mBlockStartTime = 0;
+   mRecordedTime = 0;
+   mFilePos = 0;
    mWriteMaxBitSize = U32_MAX;
    mPackUnpackShipEnergyMeter = true;
 
@@ -170,8 +94,12 @@ GameRecorderServer::GameRecorderServer(ServerGame *game)
             "." + buildGameRecorderExtension();
       string filename = joindir(dir, mFileName);
       FILE *file = fopen(filename.c_str(), "wb");
+
+      // fwrite can freeze for a second or more on a VPS or a busy disk, so the writing happens on another thread.
+      // Blocks are written whole, so if the disk falls so far behind that one has to be dropped, the recording
+      // just skips ahead to the next keyframe.
       if(file)
-         mWriter = new WriteBufferThread(file);
+         mWriter = new AsyncWriteStream(file, AsyncWriteStream::GrowWhenFull, WriteQueueSize, MaxWriteQueueSize);
    }
 
    if(mWriter)
@@ -188,15 +116,17 @@ GameRecorderServer::GameRecorderServer(ServerGame *game)
       mConnectionParameters.mIsInitiator = false;
       mConnectionParameters.mDebugObjectSizes = false;
 
-      U8 *data = mWriter->getBuffer(4);
+      U8 data[4];
       data[0] = CS_PROTOCOL_VERSION;
       data[1] = U8(mGhostClassCount);
       data[2] = U8(mEventClassCount);
-      data[3] = U8(mEventClassCount >> 8) | 0x10;
-      mWriter->addBuffer(4);
+      data[3] = U8(mEventClassCount >> 8) | 0x10 | U8(FormatFlag >> 8);
+      write(data, 4);
       gameRecorderScoping(this, game);
 
       s2cSetServerName(game->getSettings()->getHostName());
+
+      startBlock(false);   // Playing from the first block is the same as starting over
    }
 }
 
@@ -204,7 +134,126 @@ GameRecorderServer::GameRecorderServer(ServerGame *game)
 GameRecorderServer::~GameRecorderServer()
 {
    if(mWriter)
+   {
+      finishFile();
+
+      if(mWriter->getDroppedBytes() > 0)
+         logprintf(LogConsumer::LogWarning, "Disk too slow to keep up with recording %s; %d bytes were dropped",
+                   mFileName.c_str(), mWriter->getDroppedBytes());
+
+      logprintf(LogConsumer::ServerFilter, "Recorded %s; write queue peaked at %d bytes",
+                mFileName.c_str(), mWriter->getPeakQueuedBytes());
+
       delete mWriter;
+   }
+}
+
+
+// Returns false if the writer thread couldn't keep up and the data was dropped
+bool GameRecorderServer::write(const U8 *data, U32 size)
+{
+   if(!mWriter->write(data, size))
+      return false;
+
+   mFilePos += size;
+   return true;
+}
+
+
+// Keyframes can only be taken between events, with every ghost either in place or not yet sent
+bool GameRecorderServer::canWriteKeyframe()
+{
+   GameType *gameType = mGame->getGameType();
+
+   return gameType && isGhostAvailable(gameType) && !EventConnection::isDataToTransmit() && canWriteGhostSnapshot();
+}
+
+
+void GameRecorderServer::startBlock(bool keyframe)
+{
+   mBlockStartTime = mRecordedTime;
+   mBlock.resize(4);
+
+   if(!keyframe)
+   {
+      writeU32(mBlock.address(), 0);
+      return;
+   }
+
+   // Anything in the keyframe is written as if in a packet that was dropped, so none of the strings it introduces
+   // count as known to the reader afterwards
+   GhostPacketNotify notify;
+   mNotifyQueueTail = &notify;
+
+   // The game's current state is posted as ordinary events, then pulled back out of the queue
+   S32 firstEventSeq = getNextSendEventSeq();
+   mGame->getGameType()->sendRecordingState(this);
+
+   Vector<RefPtr<NetEvent> > events;
+   takeEventsPostedSince(firstEventSeq, events);
+
+   BitStream bstream;      // Grows as needed
+   mStringTable->writeConfirmedEntries(&bstream);
+   bstream.writeInt(firstEventSeq, 32);
+   writeGhostSnapshot(&bstream);
+   writeEventList(&bstream, events);
+
+   mStringTable->packetDropped(&notify.stringList);
+   mNotifyQueueTail = NULL;
+
+   bstream.zeroToByteBoundary();
+   U32 size = bstream.getBytePosition();
+
+   writeU32(mBlock.address(), size);
+   mBlock.resize(4 + size);
+   memcpy(mBlock.address() + 4, bstream.getBuffer(), size);
+}
+
+
+void GameRecorderServer::finishBlock()
+{
+   // Fast compression, as this happens while the game is running
+   Vector<U8> compressed;
+   if(!compressBuffer(mBlock.address(), mBlock.size(), compressed, true))
+   {
+      logprintf(LogConsumer::LogWarning, "Failed to compress recorded gameplay, some of it will be missing");
+      return;
+   }
+
+   // Header and data go in one write, so the block is either all there or left out of the file and index entirely
+   Vector<U8> block;
+   block.resize(BlockHeaderSize + compressed.size());
+   writeU32(&block[0], compressed.size());
+   writeU32(&block[4], mBlockStartTime);
+   writeU32(&block[8], mRecordedTime - mBlockStartTime);
+   memcpy(&block[BlockHeaderSize], compressed.address(), compressed.size());
+
+   U32 offset = mFilePos;
+   if(!write(block.address(), block.size()))
+      return;
+
+   mBlockOffsets.push_back(offset);
+   mBlockStartTimes.push_back(mBlockStartTime);
+}
+
+
+void GameRecorderServer::finishFile()
+{
+   finishBlock();
+
+   Vector<U8> index;
+   index.resize(mBlockOffsets.size() * IndexEntrySize + IndexTrailerSize);
+
+   for(S32 i = 0; i < mBlockOffsets.size(); i++)
+   {
+      writeU32(&index[i * IndexEntrySize], mBlockOffsets[i]);
+      writeU32(&index[i * IndexEntrySize + 4], mBlockStartTimes[i]);
+   }
+
+   writeU32(&index[index.size() - IndexTrailerSize], mBlockOffsets.size());
+   writeU32(&index[index.size() - IndexTrailerSize + 4], IndexMagic);
+
+   write(index.address(), index.size());
 }
 
 
@@ -236,7 +285,7 @@ void GameRecorderServer::idle(U32 MilliSeconds)
    GhostPacketNotify notify;
    mNotifyQueueTail = &notify;
 
-   U8 *data = mWriter->getBuffer(16383 + 3);
+   U8 data[16383 + 3];
    BitStream bstream(&data[3], 16383);
 
    prepareWritePacket();
@@ -252,7 +301,18 @@ void GameRecorderServer::idle(U32 MilliSeconds)
    data[0] = U8(size);
    data[1] = U8((size >> 8) & 63) | U8((ms >> 8) << 6);
    data[2] = U8(ms);
-   mWriter->addBuffer(bstream.getBytePosition() + 3);
+
+   U32 blockPos = mBlock.size();
+   mBlock.resize(blockPos + size + 3);
+   memcpy(mBlock.address() + blockPos, data, size + 3);
+
+   mRecordedTime += ms;
+
+   if((mRecordedTime - mBlockStartTime >= KeyframeInterval || U32(mBlock.size()) >= MaxBlockSize) && canWriteKeyframe())
+   {
+      finishBlock();
+      startBlock(true);
+   }
 }
 
 
@@ -10,24 +10,53 @@
 #include "tnlGhostConnection.h"
 #include "tnlNetObject.h"
 #include "gameConnection.h"
+#include "tnlAsyncWriter.h"
 
 
 namespace Zap {
 
 class ServerGame;
-class WriteBufferThread;
 
+// Recordings start with a 4 byte header, followed by zlib-compressed blocks of about KeyframeInterval each, and
+// end with an index of where each block starts.  Every block begins with a keyframe, which holds everything needed
+// to start playing from there, followed by the packets recorded during the block.
 class GameRecorderServer : public GameConnection
 {
    typedef GhostConnection Parent;
 
 private:
-   WriteBufferThread *mWriter;
+   AsyncWriteStream *mWriter;
    ServerGame *mGame;
    TNL::NetObject mNetObj;
    U32 mMilliSeconds;
 
+   Vector<U8> mBlock;            // Uncompressed contents of the block being recorded
+   U32 mBlockStartTime;
+   U32 mRecordedTime;
+   U32 mFilePos;
+   Vector<U32> mBlockOffsets;
+   Vector<U32> mBlockStartTimes;
+
+   bool write(const U8 *data, U32 size);
+   bool canWriteKeyframe();
+   void startBlock(bool keyframe);
+   void finishBlock();
+   void finishFile();
+
 public:
+   enum {
+      FormatFlag = 0x2000,                // Set in the header's event class count for block-based recordings
+      BlockHeaderSize = 12,               // Compressed size, start time, duration
+      IndexEntrySize = 8,                 // Offset, start time
+      IndexTrailerSize = 8,               // Entry count, IndexMagic
+      IndexMagic = 0x49524642,            // "BFRI"
+      KeyframeInterval = 10000,           // Milliseconds
+      MaxBlockSize = 256 * 1024,          // Start a new block early if this one gets big
+      MaxUncompressedBlockSize = 16 * 1024 * 1024,
+      WriteQueueSize = 512 * 1024,        // Room for a couple of blocks waiting on the disk...
+      MaxWriteQueueSize = 8 * 1024 * 1024, // ...growing to this much before blocks get dropped
+   };
+
    string mFileName;
 
    static string buildGameRecorderExtension();
@@ -20,6 +20,7 @@
 #include "OpenglUtils.h"
 #include "Cursor.h"
 #include "Level.h"
+#include "Compression.h"
 
 #include "version.h"
 
@@ -86,6 +87,19 @@ static void resetRenderState(ClientGame *game)
 }
 
 
+static const U32 SeekStep = 100;      // Milliseconds played at a time when seeking
+
+
+static U32 readU32(const U8 *data)
+{
+   U32 value = 0;
+   for(U32 i = 0; i < 4; i++)
+      value |= U32(data[i]) << (i * 8);
+
+   return value;
+}
+
+
 GameRecorderPlayback::GameRecorderPlayback(ClientGame *game, const char *filename) : GameConnection(game)
 {
    mFile = NULL;
@@ -95,6 +109,8 @@ GameRecorderPlayback::GameRecorderPlayback(ClientGame *game, const char *filenam
    mCurrentTime = 0;
    mTotalTime = 0;
    mIsButtonHeldDown = false;
+   mCurrentBlock = -1;
+   mBlockPos = 0;
 
    if(!mFile)
       mFile = fopen(filename, "rb");
@@ -111,7 +127,10 @@ GameRecorderPlayback::GameRecorderPlayback(ClientGame *game, const char *filenam
          mPackUnpackShipEnergyMeter = true;
          mEventClassCount &= ~0x1000;
       }
-      if(data[0] != CS_PROTOCOL_VERSION || 
+      bool blockFormat = (mEventClassCount & GameRecorderServer::FormatFlag) != 0;
+      mEventClassCount &= ~GameRecorderServer::FormatFlag;
+
+      if(data[0] != CS_PROTOCOL_VERSION || !blockFormat ||
          mEventClassCount > NetClassRep::getNetClassCount(getNetClassGroup(), NetClassTypeEvent) || 
          mGhostClassCount > NetClassRep::getNetClassCount(getNetClassGroup(), NetClassTypeObject))
       {
@@ -131,24 +150,131 @@ GameRecorderPlayback::GameRecorderPlayback(ClientGame *game, const char *filenam
 
    if(mFile)
    {
-      S32 filepos = ftell(mFile);
-      while(true)
+      fseek(mFile, 0, SEEK_END);
+      U32 fileSize = ftell(mFile);
+
+      // A recording that was never finished has no index, but its blocks can still be found one after another
+      if(!readIndex(fileSize))
+         scanBlocks(fileSize);
+
+      // The last block's header says how long the recording is
+      if(mBlockOffsets.size() > 0)
       {
-         U8 data[3];
-         if(fread(data, 1, 3, mFile) != 3)
-            break;
-         U32 size = (U32(data[1] & 63) << 8) + data[0];
-         U32 milli = S32((U32(data[1] >> 6) << 8) + data[2]);
-         if(size == 0)
-            break;
-         mTotalTime += milli;
-         fseek(mFile, size, SEEK_CUR);
+         U8 header[GameRecorderServer::BlockHeaderSize];
+         fseek(mFile, mBlockOffsets.last(), SEEK_SET);
+         if(fread(header, 1, GameRecorderServer::BlockHeaderSize, mFile) == GameRecorderServer::BlockHeaderSize)
+            mTotalTime = readU32(&header[4]) + readU32(&header[8]);
       }
-      fseek(mFile, filepos, SEEK_SET);
+
+      loadBlock(0);
+   }
+}
+
+
+bool GameRecorderPlayback::readIndex(U32 fileSize)
+{
+   if(fileSize < 4 + GameRecorderServer::IndexTrailerSize)
+      return false;
+
+   U8 trailer[GameRecorderServer::IndexTrailerSize];
+   fseek(mFile, fileSize - GameRecorderServer::IndexTrailerSize, SEEK_SET);
+   if(fread(trailer, 1, GameRecorderServer::IndexTrailerSize, mFile) != GameRecorderServer::IndexTrailerSize ||
+         readU32(&trailer[4]) != GameRecorderServer::IndexMagic)
+      return false;
+
+   U32 count = readU32(&trailer[0]);
+   U32 indexSize = count * GameRecorderServer::IndexEntrySize;
+   if(count == 0 || indexSize > fileSize - 4 - GameRecorderServer::IndexTrailerSize)
+      return false;
+
+   Vector<U8> index;
+   index.resize(indexSize);
+   fseek(mFile, fileSize - GameRecorderServer::IndexTrailerSize - indexSize, SEEK_SET);
+   if(fread(index.address(), 1, indexSize, mFile) != indexSize)
+      return false;
+
+   for(U32 i = 0; i < count; i++)
+   {
+      mBlockOffsets.push_back(readU32(&index[i * GameRecorderServer::IndexEntrySize]));
+      mBlockStartTimes.push_back(readU32(&index[i * GameRecorderServer::IndexEntrySize + 4]));
+   }
+
+   return true;
+}
+
+
+void GameRecorderPlayback::scanBlocks(U32 fileSize)
+{
+   mBlockOffsets.clear();
+   mBlockStartTimes.clear();
+
+   U32 pos = 4;
+   while(pos + GameRecorderServer::BlockHeaderSize <= fileSize)
+   {
+      U8 header[GameRecorderServer::BlockHeaderSize];
+      fseek(mFile, pos, SEEK_SET);
+      if(fread(header, 1, GameRecorderServer::BlockHeaderSize, mFile) != GameRecorderServer::BlockHeaderSize)
+         break;
+
+      U32 size = readU32(&header[0]);
+      if(size > fileSize - pos - GameRecorderServer::BlockHeaderSize)
+         break;      // Cut off part way through
+
+      mBlockOffsets.push_back(pos);
+      mBlockStartTimes.push_back(readU32(&header[4]));
+      pos += GameRecorderServer::BlockHeaderSize + size;
    }
 }
 
 
+// Reads and uncompresses a block, leaving it ready to play from just after its keyframe
+bool GameRecorderPlayback::loadBlock(S32 index)
+{
+   if(index < 0 || index >= mBlockOffsets.size())
+      return false;
+
+   U8 header[GameRecorderServer::BlockHeaderSize];
+   fseek(mFile, mBlockOffsets[index], SEEK_SET);
+   if(fread(header, 1, GameRecorderServer::BlockHeaderSize, mFile) != GameRecorderServer::BlockHeaderSize)
+      return false;
+
+   U32 size = readU32(&header[0]);
+   if(size > GameRecorderServer::MaxUncompressedBlockSize)
+      return false;
+
+   Vector<U8> compressed;
+   compressed.resize(size);
+   if(fread(compressed.address(), 1, size, mFile) != size ||
+         !uncompressBuffer(compressed.address(), size, GameRecorderServer::MaxUncompressedBlockSize, mBlockData) ||
+         mBlockData.size() < 4 || readU32(mBlockData.address()) > U32(mBlockData.size()) - 4)
+   {
+      mBlockData.clear();
+      return false;
+   }
+
+   mCurrentBlock = index;
+   mBlockPos = 4 + readU32(mBlockData.address());
+
+   return true;
+}
+
+
+// Packets never straddle blocks, so running off the end of one means moving on to the next
+bool GameRecorderPlayback::readBytes(U8 *dest, U32 size)
+{
+   if(mBlockPos >= U32(mBlockData.size()) && !loadBlock(mCurrentBlock + 1))
+      return false;
+
+   if(mBlockPos + size > U32(mBlockData.size()))
+      return false;
+
+   memcpy(dest, mBlockData.address() + mBlockPos, size);
+   mBlockPos += size;
+
+   return true;
+}
+
+
 GameRecorderPlayback::~GameRecorderPlayback()
 {
    if(mFile)
@@ -157,6 +283,7 @@ GameRecorderPlayback::~GameRecorderPlayback()
 
 
 bool GameRecorderPlayback::isValid()     { return mFile != NULL; }
+bool GameRecorderPlayback::isAtEnd()     { return !mFile || mMilliSeconds == S32_MAX; }
 bool GameRecorderPlayback::lostContact() { return false; }
 
 
@@ -244,7 +371,7 @@ void GameRecorderPlayback::processMoreData(U32 MilliSeconds)
          mPacketRecvBytesTotal += mSizeToRead;
          mPacketRecvCount++;
 
-         if(fread(data, 1, mSizeToRead, mFile) == mSizeToRead)
+         if(readBytes(data, mSizeToRead))
          {
             BitStream bstream(data, mSizeToRead);
             GhostConnection::readPacket(&bstream);
@@ -252,8 +379,11 @@ void GameRecorderPlayback::processMoreData(U32 MilliSeconds)
          mSizeToRead = 0;
       }
 
-      if(fread(data, 1, 3, mFile) != 3)
-         break; // Could not read 3 bytes
+      if(!readBytes(data, 3))   // Could not read 3 bytes, must be the end
+      {
+         mMilliSeconds = S32_MAX;
+         break;
+      }
 
       U32 size = (U32(data[1] & 63) << 8) + data[0];
       U32 milli = S32((U32(data[1] >> 6) << 8) + data[2]);
@@ -276,17 +406,77 @@ void GameRecorderPlayback::processMoreData(U32 MilliSeconds)
 }
 
 
-void GameRecorderPlayback::restart()
+// Ghosts are rebuilt from scratch when jumping to a keyframe, except the GameType, which holds the game's state
+bool GameRecorderPlayback::keepGhostAcrossSnapshot(NetObject *ghost)
 {
-   deleteLocalGhosts();
+   return ghost == mGame->getGameType();
+}
+
+
+// Sets everything up as it was at the start of a block
+void GameRecorderPlayback::jumpToBlock(S32 index)
+{
+   if(!loadBlock(index))
+      return;
+
    mMilliSeconds = 0;
    mSizeToRead = 0;
-   mCurrentTime = 0;
-   clearRecvEvents();
+   mCurrentTime = mBlockStartTimes[index];
    mGame->clearClientList();
 
-   if(mFile)
-      fseek(mFile, 4, SEEK_SET);
+   U32 keyframeSize = readU32(mBlockData.address());
+
+   if(keyframeSize == 0)      // The first block, with nothing before it
+   {
+      deleteLocalGhosts();
+      clearRecvEvents();
+      return;
+   }
+
+   BitStream bstream(mBlockData.address() + 4, keyframeSize);
+
+   mStringTable->readEntries(&bstream);
+   setNextRecvEventSeq(S32(bstream.readInt(32)));
+   readGhostSnapshot(&bstream);
+   readEventList(&bstream);
+}
+
+
+void GameRecorderPlayback::seek(U32 time)
+{
+   if(!mFile || mBlockOffsets.size() == 0)
+      return;
+
+   time = min(time, mTotalTime);
+
+   S32 block = 0;
+   while(block + 1 < mBlockOffsets.size() && mBlockStartTimes[block + 1] <= time)
+      block++;
+
+   // Level info and walls are only sent at the start, so we need to have played that far before jumping anywhere
+   if(!mGame->getGameType() && block > 0)
+   {
+      jumpToBlock(0);
+      processMoreData(mBlockStartTimes[1]);
+   }
+
+   // Only play through to the target if it's a short way ahead of us; otherwise start from its keyframe
+   if(block != mCurrentBlock || time < mCurrentTime)
+      jumpToBlock(block);
+
+   // Objects are only sent when something changes, and move along on their own in between.  Playing through in one
+   // big step would leave them where the last update put them.
+   if(time >= mCurrentTime)
+   {
+      U32 remaining = time - mCurrentTime;
+
+      while(remaining > 0 && !isAtEnd())
+      {
+         U32 step = min(remaining, SeekStep);
+         processMoreData(step);
+         remaining -= step;
+      }
+   }
 }
 
 // --------
@@ -427,6 +617,7 @@ PlaybackGameUserInterface::PlaybackGameUserInterface(ClientGame *game, UIManager
    mSpeed = 0;
    mSpeedRemainder = 0;
    mVisible = false;
+   mScrubbing = false;
 }
 
 
@@ -437,6 +628,7 @@ void PlaybackGameUserInterface::onActivate()
    mSpeed = 2;
    mSpeedRemainder = 0;
    mVisible = true;
+   mScrubbing = false;
 }
 
 
@@ -463,11 +655,12 @@ const F32 btn0_x = 200; // pause
 const F32 btn1_x = 250; // slow play
 const F32 btn2_x = 300; // play
 const F32 btn3_x = 350; // fast forward
+const F32 btn4_x = 400; // very fast forward
 const F32 btn_y = 510;
 const F32 btn_w = 20;
 const F32 btn_h = 20;
 
-const F32 btn_spectate_name_x = 400;
+const F32 btn_spectate_name_x = 450;
 
 const F32 buttons_lines[] = {
    btn0_x + btn_w/3  , btn_y            , btn0_x            , btn_y,
@@ -498,9 +691,34 @@ const F32 buttons_lines[] = {
    btn3_x + btn_w/2  , btn_y            , btn3_x + btn_w    , btn_y + btn_h/2,
    btn3_x + btn_w/2  , btn_y + btn_h    , btn3_x + btn_w    , btn_y + btn_h/2,
 
+   btn4_x            , btn_y            , btn4_x            , btn_y + btn_h,
+   btn4_x            , btn_y            , btn4_x + btn_w/3  , btn_y + btn_h/2,
+   btn4_x            , btn_y + btn_h    , btn4_x + btn_w/3  , btn_y + btn_h/2,
+   btn4_x + btn_w/3  , btn_y            , btn4_x + btn_w/3  , btn_y + btn_h,
+   btn4_x + btn_w/3  , btn_y            , btn4_x + btn_w*2/3, btn_y + btn_h/2,
+   btn4_x + btn_w/3  , btn_y + btn_h    , btn4_x + btn_w*2/3, btn_y + btn_h/2,
+   btn4_x + btn_w*2/3, btn_y            , btn4_x + btn_w*2/3, btn_y + btn_h,
+   btn4_x + btn_w*2/3, btn_y            , btn4_x + btn_w    , btn_y + btn_h/2,
+   btn4_x + btn_w*2/3, btn_y + btn_h    , btn4_x + btn_w    , btn_y + btn_h/2,
+
 };
 
 
+void PlaybackGameUserInterface::seekToMouse()
+{
+   F32 x = DisplayManager::getScreenInfo()->getMousePos()->x;
+
+   F32 x2 = (x - playbackBar_x) / playbackBar_w;
+   if(x2 < 0)
+      x2 = 0;
+   if(x2 > 1)
+      x2 = 1;
+
+   mPlaybackConnection->seek(U32(x2 * mPlaybackConnection->mTotalTime));
+   resetRenderState(getGame());
+}
+
+
 bool PlaybackGameUserInterface::onKeyDown(InputCode inputCode)
 {
    if(inputCode == MOUSE_LEFT)
@@ -518,25 +736,14 @@ bool PlaybackGameUserInterface::onKeyDown(InputCode inputCode)
             mSpeed = 2;
          else if(x >= btn3_x && x <= btn3_x + btn_w)
             mSpeed = 3;
+         else if(x >= btn4_x && x <= btn4_x + btn_w)
+            mSpeed = 4;
          return true;
       }
       else if(y >= playbackBar_y && y <= playbackBar_y + playbackBar_h)
       {
-         F32 x2 = (x - playbackBar_x) / playbackBar_w;
-         if(x2 < 0)
-            x2 = 0;
-         if(x2 > 1)
-            x2 = 1;
-
-         U32 time = U32(x2 * mPlaybackConnection->mTotalTime);
-
-         // TODO: maybe we need to seek more efficiency by avoiding having to start all over from the beginning
-         if(time < mPlaybackConnection->mCurrentTime)
-            mPlaybackConnection->restart();
-
-         mPlaybackConnection->processMoreData(time - mPlaybackConnection->mCurrentTime);
-         resetRenderState(getGame());
-
+         mScrubbing = true;
+         seekToMouse();
          return true;
       }
    }
@@ -559,7 +766,15 @@ bool PlaybackGameUserInterface::onKeyDown(InputCode inputCode)
 }
 
 
-void PlaybackGameUserInterface::onKeyUp(InputCode inputCode) { mGameInterface->onKeyUp(inputCode); }
+void PlaybackGameUserInterface::onKeyUp(InputCode inputCode)
+{
+   if(inputCode == MOUSE_LEFT)
+      mScrubbing = false;
+
+   mGameInterface->onKeyUp(inputCode);
+}
+
+
 void PlaybackGameUserInterface::onTextInput(char ascii)      { mGameInterface->onTextInput(ascii); }
 
 
@@ -569,6 +784,9 @@ void PlaybackGameUserInterface::onMouseMoved()
    F32 y = DisplayManager::getScreenInfo()->getMousePos()->y;
 
    mVisible = (y >= 100); // Maybe a better way to hide the bottom bar?
+
+   if(mScrubbing)
+      seekToMouse();
 }
 
 
@@ -583,6 +801,7 @@ void PlaybackGameUserInterface::idle(U32 timeDelta)
       case 1: idleTime = (timeDelta + mSpeedRemainder) >> 2; mSpeedRemainder = (mSpeedRemainder + timeDelta) & 3; break;
       case 2: break;
       case 3: idleTime = timeDelta * 4; break;
+      case 4: idleTime = timeDelta * 16; break;
    }
 
    if(idleTime != 0)
@@ -13,6 +13,8 @@
 
 #include "UIMenus.h"
 
+#include "gtest/gtest_prod.h"
+
 namespace Zap {
 
 
@@ -27,6 +29,24 @@ class GameRecorderPlayback : public GameConnection
    U32 mSizeToRead;
    SafePtr<ClientInfo> mClientInfoSpectating;
 
+   Vector<U32> mBlockOffsets;
+   Vector<U32> mBlockStartTimes;
+   S32 mCurrentBlock;
+   Vector<U8> mBlockData;     // Uncompressed contents of the block being played
+   U32 mBlockPos;
+
+   bool readIndex(U32 fileSize);
+   void scanBlocks(U32 fileSize);
+   bool loadBlock(S32 index);
+   bool readBytes(U8 *dest, U32 size);
+   void jumpToBlock(S32 index);
+
+   FRIEND_TEST(GameRecorderTest, SeekingMatchesStraightPlayback);
+   FRIEND_TEST(GameRecorderTest, PlaysWithoutIndex);
+
+protected:
+   bool keepGhostAcrossSnapshot(NetObject *ghost);
+
 public:
    GameRecorderPlayback(ClientGame *game, const char *filename);
    ~GameRecorderPlayback();
@@ -38,6 +58,7 @@ public:
    U32 mCurrentTime;
 
    bool isValid();
+   bool isAtEnd();
 
    bool lostContact();
    void addPendingMove(Move *theMove);
@@ -45,7 +66,7 @@ public:
 
    void updateSpectate();
    void processMoreData(TNL::U32 MilliSeconds);
-   void restart();
+   void seek(U32 time);
 };
 
 
@@ -77,6 +98,9 @@ class PlaybackGameUserInterface : public UserInterface
    U32 mSpeed;
    U32 mSpeedRemainder;
    bool mVisible;
+   bool mScrubbing;     // Dragging along the playback bar
+
+   void seekToMouse();
 public:
    explicit PlaybackGameUserInterface(ClientGame *game, UIManager *uiManager);
    void onActivate();
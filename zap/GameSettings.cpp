@@ -23,6 +23,10 @@
 
 #include "IniFile.h"
 
+#ifndef ZAP_DEDICATED
+#  include "ReplayStats.h"    // For writeReplayStats
+#endif
+
 #include <stdio.h>
 #include <algorithm>
 
@@ -134,6 +138,7 @@ DirectiveInfo directiveDefs[] = {
 { "sendres", FOUR_REQUIRED,  GET_RESOURCE,  5, GameSettings::sendRes,   "<server address> <admin password> <resource name> <LEVEL|LEVELGEN|BOT>", "Retrieve a resource from a remote server, with same requirements as -sendres.",                                                                                                                                                                "Usage: bitfighter sendres <server address> <admin password> <resource name> <LEVEL|LEVELGEN|BOT>" },
 
 // Other commands
+{ "replaystats", ALL_REMAINING, REPLAY_STATS, 6, GameSettings::replayStats, "<output folder> <recording or folder> [recording or folder]...", "Play recorded games through as fast as possible, without displaying them, and write a JSON file of stats (kills, flag carries, and a heatmap of ship positions) for each into the output folder. Not available in the dedicated server.", "Usage: bitfighter replaystats <output folder> <recording or folder> [recording or folder]..." },
 { "rules",   NO_PARAMETERS,  SHOW_RULES,        6, GameSettings::showRules,      "",  "Print a list of \"rules of the game\" and other possibly useful data", "" },
 { "help",    NO_PARAMETERS,  HELP,              6, GameSettings::showHelp,       "",  "Display this message", "" },
 { "version", NO_PARAMETERS,  VERSION,           6, GameSettings::showVersion,    "",  "Print version information", "" },
@@ -1068,6 +1073,27 @@ void GameSettings::showRules(GameSettings *settings, const Vector<string> &words
 }
 
 
+////////////////////////////////////////
+////////////////////////////////////////
+// Pull stats out of recorded games with the -replaystats option
+
+void GameSettings::replayStats(GameSettings *settings, const Vector<string> &words)
+{
+   writeToConsole();
+
+#ifdef ZAP_DEDICATED
+   printf("Recordings can only be processed by the full game, not the dedicated server\n");
+#else
+   if(words.size() < 2)
+      printf("Usage: bitfighter replaystats <output folder> <recording or folder> [recording or folder]...\n");
+   else
+      writeReplayStats(words);
+#endif
+
+   exitToOs(0);
+}
+
+
 ////////////////////////////////////////
 ////////////////////////////////////////
 // Print help message with -help
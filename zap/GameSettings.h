@@ -72,6 +72,7 @@ enum ParamId {
 
    SEND_RESOURCE,
    GET_RESOURCE,
+   REPLAY_STATS,
    SHOW_RULES,
    SHOW_LUA_CLASSES,
    HELP,
@@ -287,6 +288,7 @@ public:
 
    static void getRes(GameSettings *settings, const Vector<string> &words);
    static void sendRes(GameSettings *settings, const Vector<string> &words);
+   static void replayStats(GameSettings *settings, const Vector<string> &words);
    static void showRules(GameSettings *settings, const Vector<string> &words);
    static void showHelp(GameSettings *settings, const Vector<string> &words);
    static void showVersion(GameSettings *settings, const Vector<string> &words);
@@ -0,0 +1,188 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "GhostingScheduler.h"
+
+#include "gameConnection.h"
+#include "gameType.h"
+#include "ClientInfo.h"
+
+#include "tnlLog.h"
+#include "tnlPlatform.h"
+
+namespace Zap
+{
+
+// Constructor
+GhostingScheduler::GhostingScheduler()
+{
+   mMaxLoadingBandwidth = DefaultMaxLoadingBandwidth;
+   mMaxLoadingClients = DefaultMaxLoadingClients;
+   mLoadingRate = 0;
+   mAdmittedThisTick = 0;
+}
+
+
+void GhostingScheduler::setLimits(U32 maxLoadingBandwidth, S32 maxLoadingClients)
+{
+   mMaxLoadingBandwidth = maxLoadingBandwidth;
+   mMaxLoadingClients = maxLoadingClients;
+}
+
+
+// What we've been sending to loading clients, plus the most that clients admitted since then could send
+U32 GhostingScheduler::getLoadingBandwidth() const
+{
+   U32 bandwidth = mLoadingRate;
+
+   for(S32 i = 0; i < mLoading.size(); i++)
+      if(!mLoading[i].measured && mLoading[i].connection.isValid())
+         bandwidth += mLoading[i].connection->getSendBandwidth();
+
+   return bandwidth;
+}
+
+
+// Starts ghosting to the first waiting client if it fits in our limits.  Someone always gets in when nobody is
+// loading, however fast their connection.
+bool GhostingScheduler::admitNext(U32 now)
+{
+   while(mWaiting.size() > 0 && !mWaiting[0].connection.isValid())
+      mWaiting.erase(0);
+
+   if(mWaiting.size() == 0)
+      return false;
+
+   GameConnection *connection = mWaiting[0].connection;
+
+   if(mLoading.size() > 0)
+   {
+      if(mLoading.size() >= mMaxLoadingClients || mAdmittedThisTick >= MaxAdmissionsPerTick)
+         return false;
+
+      if(getLoadingBandwidth() + connection->getSendBandwidth() > mMaxLoadingBandwidth)
+         return false;
+   }
+
+   Entry entry = mWaiting[0];
+   mWaiting.erase(0);
+
+   entry.startTime = now;
+   entry.startBytes = connection->mPacketSendBytesTotal;
+   entry.lastBytes = entry.startBytes;
+   entry.measured = false;
+   mLoading.push_back(entry);
+
+   mAdmittedThisTick++;
+
+   connection->activateGhosting();
+   return true;
+}
+
+
+// The GameType ghost carries the level info and kicks off the wall sync, so nothing's playable without it
+bool GhostingScheduler::isPlayable(GameConnection *connection, GameType *gameType) const
+{
+   return gameType && connection->isGhostAvailable(gameType) && connection->hasGhostedEverything();
+}
+
+
+void GhostingScheduler::remove(Vector<Entry> &entries, GameConnection *connection)
+{
+   for(S32 i = entries.size() - 1; i >= 0; i--)
+      if(entries[i].connection.getPointer() == connection)
+         entries.erase(i);
+}
+
+
+// Takes the place of calling activateGhosting() directly; if there's room, ghosting starts right away
+void GhostingScheduler::queue(GameConnection *connection)
+{
+   remove(connection);
+
+   Entry entry;
+   entry.connection = connection;
+   entry.queuedTime = Platform::getRealMilliseconds();
+   entry.startTime = 0;
+   entry.startBytes = 0;
+   entry.lastBytes = 0;
+   entry.measured = false;
+   mWaiting.push_back(entry);
+
+   admitNext(entry.queuedTime);
+}
+
+
+void GhostingScheduler::remove(GameConnection *connection)
+{
+   remove(mWaiting, connection);
+   remove(mLoading, connection);
+}
+
+
+void GhostingScheduler::idle(GameType *gameType, U32 timeDelta)
+{
+   U32 now = Platform::getRealMilliseconds();
+   U32 sentBytes = 0;
+
+   for(S32 i = mLoading.size() - 1; i >= 0; i--)
+   {
+      Entry &entry = mLoading[i];
+      GameConnection *connection = entry.connection;
+
+      if(!connection)
+      {
+         mLoading.erase(i);
+         continue;
+      }
+
+      const char *name = connection->getClientInfo() ? connection->getClientInfo()->getName().getString() : "";
+
+      if(isPlayable(connection, gameType))
+      {
+         logprintf(LogConsumer::ServerFilter, "%s ready to play %dms after joining the level (%dms waiting, %d bytes)",
+                   name, now - entry.queuedTime, entry.startTime - entry.queuedTime,
+                   connection->mPacketSendBytesTotal - entry.startBytes);
+         mLoading.erase(i);
+      }
+      else if(now - entry.startTime > LoadingTimeout)
+      {
+         logprintf(LogConsumer::ServerFilter, "%s still loading the level after %dms; letting others in",
+                   name, now - entry.queuedTime);
+         mLoading.erase(i);
+      }
+      else
+      {
+         sentBytes += connection->mPacketSendBytesTotal - entry.lastBytes;
+         entry.lastBytes = connection->mPacketSendBytesTotal;
+         entry.measured = true;
+      }
+   }
+
+   // Packets don't go out every tick, so smooth things out a bit
+   U32 rate = U32(U64(sentBytes) * 1000 / getMax(timeDelta, U32(1)));
+   mLoadingRate = (mLoadingRate * 3 + rate) / 4;
+
+   // Let in as many as fit
+   mAdmittedThisTick = 0;
+
+   while(admitNext(now))
+      continue;
+}
+
+
+S32 GhostingScheduler::getWaitingCount() const
+{
+   return mWaiting.size();
+}
+
+
+S32 GhostingScheduler::getLoadingCount() const
+{
+   return mLoading.size();
+}
+
+
+}
@@ -0,0 +1,72 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _GHOSTING_SCHEDULER_H_
+#define _GHOSTING_SCHEDULER_H_
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+#include "tnlNetBase.h"       // For SafePtr
+
+using namespace TNL;
+
+namespace Zap
+{
+
+class GameConnection;
+class GameType;
+
+// Spreads the start of ghosting over several ticks when many clients need the whole level at once -- at a level
+// change, or when a crowd joins together.  Only a few clients load the level at a time, no more than a couple
+// start in any one tick, and the bytes actually sent to those loading are metered against a shared budget; clients
+// that don't fit wait their turn.  Within a client, ghosts near the player's ship already go first, by
+// BfObject::getUpdatePriority().
+class GhostingScheduler
+{
+   struct Entry
+   {
+      SafePtr<GameConnection> connection;
+      U32 queuedTime;         // Real time, in ms
+      U32 startTime;          // When ghosting was activated
+      U32 startBytes;         // Connection's total bytes sent at that point
+      U32 lastBytes;          // ...and as of the last tick
+      bool measured;          // Has it been loading for a whole tick yet?
+   };
+
+   Vector<Entry> mWaiting;
+   Vector<Entry> mLoading;
+
+   U32 mMaxLoadingBandwidth;
+   S32 mMaxLoadingClients;
+   U32 mLoadingRate;          // Bytes per second actually sent to loading clients, averaged over the last few ticks
+   S32 mAdmittedThisTick;
+
+   U32 getLoadingBandwidth() const;
+   bool admitNext(U32 now);
+   bool isPlayable(GameConnection *connection, GameType *gameType) const;
+   void remove(Vector<Entry> &entries, GameConnection *connection);
+   void remove(GameConnection *connection);
+
+public:
+   static const U32 DefaultMaxLoadingBandwidth = 256 * 1024;   // Bytes per second, across every client loading a level
+   static const S32 DefaultMaxLoadingClients = 8;
+   static const S32 MaxAdmissionsPerTick = 2;
+   static const U32 LoadingTimeout = 15000;                    // Slow clients stop counting against the limits after this
+
+   GhostingScheduler();    // Constructor
+
+   void setLimits(U32 maxLoadingBandwidth, S32 maxLoadingClients);
+
+   void queue(GameConnection *connection);
+
+   void idle(GameType *gameType, U32 timeDelta);
+
+   S32 getWaitingCount() const;
+   S32 getLoadingCount() const;
+};
+
+}
+
+#endif
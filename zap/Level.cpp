@@ -9,6 +9,7 @@
 #include "EngineeredItem.h"
 #include "game.h"
 #include "gameType.h"
+#include "LevelCache.h"
 #include "LevelDatabase.h"
 #include "LevelLoadException.h"
 #include "robot.h"
@@ -167,23 +168,69 @@ void Level::addBots(Game *game)
 // if contents is empty or somehow invalid.
 void Level::loadLevelFromString(const string &contents, const string &filename)
 {
-   istringstream iss(contents);
-   string line;
-
+   size_t pos = 0;
    Md5::IncrementalHasher md5;
 
-   while(std::getline(iss, line))
+   parseLevelLines(contents, filename, pos, S32_MAX, md5);
+   finishLoading(md5.getHash());
+}
+
+
+// Parses up to maxLines lines of contents, starting at pos, and advances pos past them.  Returns true once
+// we've reached the end of contents.
+bool Level::parseLevelLines(const string &contents, const string &filename, size_t &pos, S32 maxLines, 
+                            Md5::IncrementalHasher &md5)
+{
+   const char *data = contents.c_str();
+   const char *dataEnd = data + contents.size();
+
+   for(S32 i = 0; i < maxLines && pos < contents.size(); i++)
    {
-      parseLevelLine(line, filename);
-      md5.add(line);
+      const char *line = data + pos;
+      const char *lineEnd = (const char *)memchr(line, '\n', dataEnd - line);
+      if(!lineEnd)
+         lineEnd = dataEnd;
+
+      S32 len = S32(lineEnd - line);
+      pos += len + 1;
+
+      parseLevelLine(line, len, filename);
+      md5.add(line, len);
    }
 
-	mLevelHash = md5.getHash();
+   return pos >= contents.size();
+}
+
 
-   // Build wall edge geometry
-   Vector<Point> wallEdgePoints;  // <== not used
-   buildWallEdgeGeometry(wallEdgePoints);
+// Called once all the lines have been parsed
+void Level::finishLoading(const string &hash)
+{
+   LevelCache cache;
+   cache.read(hash);
 
+   finishWalls(hash, cache);
+   finishItems();
+}
+
+
+// Build wall edge geometry, unless cache says we've clipped these walls on an earlier visit
+void Level::finishWalls(const string &hash, const LevelCache &cache)
+{
+	mLevelHash = hash;
+
+   if(cache.hasWallEdges)
+      setWallEdgeGeometry(cache.wallEdgePoints);
+   else
+   {
+      Vector<Point> wallEdgePoints;  // <== not used
+      buildWallEdgeGeometry(wallEdgePoints);
+   }
+}
+
+
+// Called once the wall edges are in place
+void Level::finishItems()
+{
    // Snap enigneered items to those edges
    snapAllEngineeredItems(false);
 
@@ -191,11 +238,57 @@ void Level::loadLevelFromString(const string &contents, const string &filename)
 }
 
 
+// Static method -- splits lines the same way parseLevelLines() does, so the hashes match.  Doesn't touch any
+// shared state, so it's safe to call from the secondary thread.
+string Level::computeHash(const string &contents)
+{
+   Md5::IncrementalHasher md5;
+
+   const char *data = contents.c_str();
+   const char *dataEnd = data + contents.size();
+
+   for(size_t pos = 0; pos < contents.size(); )
+   {
+      const char *line = data + pos;
+      const char *lineEnd = (const char *)memchr(line, '\n', dataEnd - line);
+      if(!lineEnd)
+         lineEnd = dataEnd;
+
+      md5.add(line, lineEnd - line);
+      pos += lineEnd - line + 1;
+   }
+
+   return md5.getHash();
+}
+
+
 // Populates wallEdgePoints
 void Level::buildWallEdgeGeometry(Vector<Point> &wallEdgePoints)
 {
    Vector<const WallSegment *> wallSegments;
+   getWallSegments(wallSegments);
+
+   mWallEdgeManager.rebuildEdges(wallSegments, wallEdgePoints);      // Fills wallEdgePoints
+}
+
+
+// Use edges built earlier by buildWallEdgeGeometry(), e.g. ones from the LevelCache
+void Level::setWallEdgeGeometry(const Vector<Point> &wallEdgePoints)
+{
+   mWallEdgeManager.setEdges(wallEdgePoints);
+}
+
+
+// Fills wallEdgePoints with the edges we have now, in the form buildWallEdgeGeometry() produces
+void Level::getWallEdgeGeometry(Vector<Point> &wallEdgePoints) const
+{
+   mWallEdgeManager.getEdges(wallEdgePoints);
+}
 
+
+// Fills wallSegments with the segments of every PolyWall and WallItem in the level
+void Level::getWallSegments(Vector<const WallSegment *> &wallSegments) const
+{
    const Vector<DatabaseObject *> *polyWalls = findObjects_fast(PolyWallTypeNumber);
    const Vector<DatabaseObject *> *wallItems = findObjects_fast(WallItemTypeNumber);
 
@@ -215,9 +308,6 @@ void Level::buildWallEdgeGeometry(Vector<Point> &wallEdgePoints)
       for(S32 j = 0; j < barrier->getSegmentCount(); j++)
          wallSegments.push_back(barrier->getSegment(j));
    }
-
-
-   mWallEdgeManager.rebuildEdges(wallSegments, wallEdgePoints);      // Fills wallEdgePoints
 }
 
 
@@ -276,32 +366,38 @@ void Level::validateLevel()
 // Each line of the file is handled separately by processLevelLoadLine in game.cpp or UIEditor.cpp
 void Level::parseLevelLine(const string &line, const string &levelFileName)
 {
-   Vector<string> args = parseString(line);
-   U32 argc = args.size();
-   S32 id = 0;
+   parseLevelLine(line.c_str(), (S32)line.size(), levelFileName);
+}
 
-   string errorMsg;     // Reusable object
 
-   const char** argv = new const char* [argc];     // Deleted below
+// Tokenizes a copy of line in place, so the only allocations are when mLineBuffer or mLineArgs needs to grow
+void Level::parseLevelLine(const char *line, S32 len, const string &levelFileName)
+{
+   mLineBuffer.resize(len + 1);
+   memcpy(mLineBuffer.address(), line, len);
+   mLineBuffer[len] = 0;
+
+   parseStringInPlace(mLineBuffer.address(), len, mLineArgs);
+
+   U32 argc = mLineArgs.size();
+   S32 id = 0;
 
    if(argc >= 1)
    {
       // Check if there is an id embedded with a "!"  (Turret!5 is a turret with id = 5)
-      std::size_t pos = args[0].find("!");
-      if(pos != string::npos)
+      const char *bang = strchr(mLineArgs[0], '!');
+      if(bang)
       {
-         id = atoi(args[0].substr(pos + 1, args[0].size() - pos - 1).c_str());
-         args[0] = args[0].substr(0, pos);
+         id = atoi(bang + 1);
+         mLineBuffer[S32(bang - mLineBuffer.address())] = 0;
       }
    }
 
-   for(U32 i = 0; i < argc; i++)
-      argv[i] = args[i].c_str();
+   string errorMsg;
 
    try
    {
-      errorMsg.clear();
-      bool ok = processLevelLoadLine(argc, id, (const char **)argv, errorMsg);
+      bool ok = processLevelLoadLine(argc, id, mLineArgs.address(), errorMsg);
       if(!ok)
          logprintf(LogConsumer::LogLevelError, "Level Error: Non-fatal found in level %s: %s", 
                    levelFileName.c_str(), errorMsg.c_str());
@@ -309,10 +405,8 @@ void Level::parseLevelLine(const string &line, const string &levelFileName)
    catch(LevelLoadException &e)
    {
       logprintf(LogConsumer::LogLevelError, "Level Error: Fatal error with level %s, line %s: %s", 
-                levelFileName.c_str(), line.c_str(), e.what());  // TODO: fix "line" variable having hundreds of level lines
+                levelFileName.c_str(), string(line, len).c_str(), e.what());
    }
-
-   delete[] argv;
 }
 
 
@@ -813,7 +907,7 @@ bool Level::processLevelLoadLine(U32 argc, S32 id, const char **argv, string &er
    // Handle regular game objects
    else
    {
-      string objName;
+      const char *objName;
 
       // Convert any NexusFlagItem into FlagItem, only NexusFlagItem will show up on ship
       if(stricmp(argv[0], "HuntersFlagItem") == 0 || stricmp(argv[0], "NexusFlagItem") == 0)
@@ -834,13 +928,13 @@ bool Level::processLevelLoadLine(U32 argc, S32 id, const char **argv, string &er
       if(!mGameType)   
          mGameType.set(new GameType(this));    // Cleaned up... where, exactly?
 
-      TNL::Object *obj = TNL::Object::create(objName.c_str());    // Create an object of the type specified on the line
+      TNL::Object *obj = TNL::Object::create(objName);    // Create an object of the type specified on the line
 
       SafePtr<BfObject> object = dynamic_cast<BfObject *>(obj);   // Force our new object to be a BfObject
 
       if(object.isNull())    // Well... that was a bad idea!
       {
-         errorMsg = "Unknown object type '" + objName + "'!";
+         errorMsg = "Unknown object type '" + string(objName) + "'!";
          delete obj;
          return false;
       }
@@ -855,7 +949,7 @@ bool Level::processLevelLoadLine(U32 argc, S32 id, const char **argv, string &er
 
       if(!validArgs)
       {
-         errorMsg = "Invalid arguments for object '" + objName + "'!";
+         errorMsg = "Invalid arguments for object '" + string(objName) + "'!";
          delete obj;
          return false;
       }
@@ -23,6 +23,11 @@
 using namespace std;
 using namespace TNL;
 
+namespace Md5
+{
+   class IncrementalHasher;
+}
+
 
 namespace Zap
 {
@@ -30,6 +35,7 @@ namespace Zap
 class BotNavMeshZone;
 class Game;
 class GameType;
+class LevelCache;
 class PolyWall;
 class WallItem;
 
@@ -61,7 +67,12 @@ private:
    Vector<BotNavMeshZone *> mAllZones;
 
    void initialize();
+   // Scratch space for parseLevelLine(), kept around so loading doesn't allocate for every line
+   Vector<char> mLineBuffer;
+   Vector<const char *> mLineArgs;
+
    void parseLevelLine(const string &line, const string &levelFileName);
+   void parseLevelLine(const char *line, S32 len, const string &levelFileName);
    bool processLevelLoadLine(U32 argc, S32 id, const char **argv, string &errorMsg);  
    bool processLevelParam(S32 argc, const char **argv);
 
@@ -78,9 +89,23 @@ public:
 
    void loadLevelFromString(const string &contents, const string &filename = "");
    bool loadLevelFromFile(const string &filename);
+
+   // For loading a level a few lines at a time; loadLevelFromString() is these two in one go
+   bool parseLevelLines(const string &contents, const string &filename, size_t &pos, S32 maxLines, 
+                        Md5::IncrementalHasher &md5);
+   void finishLoading(const string &hash);
+
+   // ...and finishLoading() is these two, for when they need to go in separate ticks
+   void finishWalls(const string &hash, const LevelCache &cache);
+   void finishItems();
+
+   static string computeHash(const string &contents);    // Same hash parseLevelLines() builds, without the parsing
    void validateLevel();
 
    void buildWallEdgeGeometry(Vector<Point> &wallEdgePoints);
+   void setWallEdgeGeometry(const Vector<Point> &wallEdgePoints);
+   void getWallEdgeGeometry(Vector<Point> &wallEdgePoints) const;
+   void getWallSegments(Vector<const WallSegment *> &wallSegments) const;
    void snapAllEngineeredItems(bool onlyUnsnapped);
 
    boost::shared_ptr<Vector<TeamInfo> > getTeamInfosClone() const;
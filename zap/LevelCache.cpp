@@ -0,0 +1,359 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelCache.h"
+
+#include "gridDB.h"
+#include "stringUtils.h"
+
+#include "tnlBitStream.h"
+#include "tnlLog.h"
+
+#include <stdio.h>
+
+namespace Zap
+{
+
+// Statics
+string LevelCache::mCacheDir;
+
+static const U32 CacheFileMagic = 0x434C4642;      // "BFLC"
+static const U32 MaxCacheFileSize = 64 * 1024 * 1024;
+
+
+// Constructor
+LevelCache::LevelCache(const string &extension)
+{
+   mExtension = extension;
+   clear();
+}
+
+
+// Static method
+void LevelCache::setCacheDir(const string &dir)
+{
+   if(dir != "" && !makeSureFolderExists(dir))
+   {
+      logprintf(LogConsumer::LogWarning, "Could not create level cache folder %s; levels will be built from scratch", dir.c_str());
+      mCacheDir = "";
+      return;
+   }
+
+   mCacheDir = dir;
+}
+
+
+// Static method
+bool LevelCache::isEnabled()
+{
+   return mCacheDir != "";
+}
+
+
+// Hashes are MD5 digests.  Clients get theirs from the server, and it ends up in a file name, so anything else --
+// a path separator, "..", an empty string -- is turned away.  Static method.
+bool LevelCache::isValidHash(const string &hash)
+{
+   return hash.length() == 32 && isHex(hash);
+}
+
+
+string LevelCache::getCacheFile(const string &hash) const
+{
+   TNLAssert(isValidHash(hash), "Should have checked the hash by now!");
+
+   return joindir(mCacheDir, hash + "." + mExtension);
+}
+
+
+void LevelCache::clear()
+{
+   wallEdgePoints.clear();
+   hasWallEdges = false;
+
+   zones.clear();
+   hasZones = false;
+
+   wallGeometry.clear();
+   hasWallGeometry = false;
+
+   mModified = false;
+}
+
+
+static void writePoints(BitStream &stream, const Vector<Point> &points)
+{
+   stream.write(U32(points.size()));
+
+   for(S32 i = 0; i < points.size(); i++)
+      points[i].write(&stream);
+}
+
+
+// Reads a count, and makes sure there is enough data left in the stream to back it up, so a damaged file
+// can't have us allocating gigabytes
+static bool readCount(BitStream &stream, U32 streamSize, U32 minBytesPerItem, U32 &count)
+{
+   stream.read(&count);
+
+   return stream.isValid() && U64(count) * minBytesPerItem <= streamSize - stream.getBytePosition();
+}
+
+
+static bool readPoints(BitStream &stream, U32 streamSize, Vector<Point> &points)
+{
+   U32 count;
+   if(!readCount(stream, streamSize, sizeof(F32) * 2, count))
+      return false;
+
+   points.resize(count);
+
+   for(U32 i = 0; i < count; i++)
+      points[i].read(&stream);
+
+   return stream.isValid();
+}
+
+
+// The whole file is read into memory in one go, then decoded straight out of that buffer
+bool LevelCache::read(const string &hash)
+{
+   clear();
+
+   if(!isEnabled() || !isValidHash(hash))
+      return false;
+
+   FILE *f = fopen(getCacheFile(hash).c_str(), "rb");
+   if(!f)
+      return false;
+
+   fseek(f, 0, SEEK_END);
+   long size = ftell(f);
+   fseek(f, 0, SEEK_SET);
+
+   if(size <= 0 || size > (long)MaxCacheFileSize)
+   {
+      fclose(f);
+      return false;
+   }
+
+   Vector<U8> buffer(size);
+   buffer.resize(size);
+
+   bool ok = fread(buffer.address(), 1, size, f) == (size_t)size;
+   fclose(f);
+
+   if(!ok)
+      return false;
+
+   BitStream stream(buffer.address(), size);
+
+   U32 magic, version;
+   char fileHash[256];
+
+   stream.read(&magic);
+   stream.read(&version);
+   stream.readString(fileHash);
+
+   // Written by a different version of the game, or the file has been renamed or damaged
+   if(!stream.isValid() || magic != CacheFileMagic || version != FormatVersion || hash != fileHash)
+      return false;
+
+   hasWallEdges = stream.readFlag();
+   if(hasWallEdges && !readPoints(stream, size, wallEdgePoints))
+   {
+      clear();
+      return false;
+   }
+
+   hasZones = stream.readFlag();
+   if(hasZones)
+   {
+      U32 zoneCount;
+      if(!readCount(stream, size, sizeof(U32) * 2, zoneCount))
+      {
+         clear();
+         return false;
+      }
+
+      zones.resize(zoneCount);
+
+      for(U32 i = 0; i < zoneCount; i++)
+      {
+         ZoneInfo &zone = zones[i];
+
+         U32 neighborCount;
+         if(!readPoints(stream, size, zone.verts) || !readCount(stream, size, sizeof(U16), neighborCount))
+         {
+            clear();
+            return false;
+         }
+
+         zone.neighbors.resize(neighborCount);
+
+         for(U32 j = 0; j < neighborCount; j++)
+         {
+            NeighboringZone &neighbor = zone.neighbors[j];
+
+            stream.read(&neighbor.zoneID);
+            neighbor.borderStart.read(&stream);
+            neighbor.borderEnd.read(&stream);
+            neighbor.borderCenter.read(&stream);
+            neighbor.center.read(&stream);
+            stream.read(&neighbor.distTo);
+
+            // Bots index the zone list with this, so one that points past the end would crash them
+            if(neighbor.zoneID >= zoneCount)
+            {
+               clear();
+               return false;
+            }
+         }
+      }
+   }
+
+   hasWallGeometry = stream.readFlag();
+   if(hasWallGeometry)
+   {
+      U32 bytes;
+      if(!readCount(stream, size, 1, bytes))
+      {
+         clear();
+         return false;
+      }
+
+      wallGeometry.resize(bytes);
+      stream.read(bytes, wallGeometry.address());
+   }
+
+   if(!stream.isValid())
+   {
+      clear();
+      return false;
+   }
+
+   return true;
+}
+
+
+// Failures here aren't fatal; we'll just build everything from scratch again next time
+bool LevelCache::write(const string &hash)
+{
+   if(!isEnabled() || !mModified || !isValidHash(hash))
+      return false;
+
+   BitStream stream;
+
+   stream.write(CacheFileMagic);
+   stream.write(FormatVersion);
+   stream.writeString(hash.c_str());
+
+   if(stream.writeFlag(hasWallEdges))
+      writePoints(stream, wallEdgePoints);
+
+   if(stream.writeFlag(hasZones))
+   {
+      stream.write(U32(zones.size()));
+
+      for(S32 i = 0; i < zones.size(); i++)
+      {
+         const ZoneInfo &zone = zones[i];
+
+         writePoints(stream, zone.verts);
+         stream.write(U32(zone.neighbors.size()));
+
+         for(S32 j = 0; j < zone.neighbors.size(); j++)
+         {
+            const NeighboringZone &neighbor = zone.neighbors[j];
+
+            stream.write(neighbor.zoneID);
+            neighbor.borderStart.write(&stream);
+            neighbor.borderEnd.write(&stream);
+            neighbor.borderCenter.write(&stream);
+            neighbor.center.write(&stream);
+            stream.write(neighbor.distTo);
+         }
+      }
+   }
+
+   if(stream.writeFlag(hasWallGeometry))
+   {
+      stream.write(U32(wallGeometry.size()));
+      stream.write(wallGeometry.size(), wallGeometry.address());
+   }
+
+   if(!stream.isValid())
+      return false;
+
+   FILE *f = fopen(getCacheFile(hash).c_str(), "wb");
+   if(!f)
+      return false;
+
+   size_t bytes = stream.getBytePosition();
+   bool ok = fwrite(stream.getBuffer(), 1, bytes, f) == bytes;
+   fclose(f);
+
+   mModified = false;
+
+   return ok;
+}
+
+
+void LevelCache::setWallEdges(const Vector<Point> &points)
+{
+   wallEdgePoints = points;
+   hasWallEdges = true;
+   mModified = true;
+}
+
+
+void LevelCache::setWallGeometry(const Vector<U8> &geometry)
+{
+   wallGeometry = geometry;
+   hasWallGeometry = true;
+   mModified = true;
+}
+
+
+void LevelCache::storeZones(const Vector<BotNavMeshZone *> &allZones)
+{
+   zones.resize(allZones.size());
+
+   for(S32 i = 0; i < allZones.size(); i++)
+   {
+      TNLAssert(allZones[i]->getZoneId() == i, "Expected zones to be in id order!");
+
+      zones[i].verts = *allZones[i]->getOutline();
+      zones[i].neighbors = allZones[i]->mNeighbors;
+   }
+
+   hasZones = true;
+   mModified = true;
+}
+
+
+// Recreate the zones buildBotMeshZones() would have made, neighbors, teleporter links and all
+void LevelCache::createZones(GridDatabase &botZoneDatabase, Vector<BotNavMeshZone *> &allZones, bool triangulateZones) const
+{
+   allZones.deleteAndClear();
+   allZones.reserve(zones.size());
+
+   for(S32 i = 0; i < zones.size(); i++)
+   {
+      BotNavMeshZone *botzone = new BotNavMeshZone(i);
+
+      if(!triangulateZones)
+         botzone->disableTriangulation();
+
+      botzone->setGeometry(zones[i].verts);
+      botzone->mNeighbors = zones[i].neighbors;
+      botzone->addToZoneDatabase(&botZoneDatabase);
+
+      allZones.push_back(botzone);
+   }
+}
+
+
+}
@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LEVEL_CACHE_H_
+#define _LEVEL_CACHE_H_
+
+#include "BotNavMeshZone.h"      // For NeighboringZone
+
+#include "Point.h"
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <string>
+
+using namespace std;
+using namespace TNL;
+
+namespace Zap
+{
+
+class GridDatabase;
+
+// Keeps the expensive-to-compute parts of a level -- its merged wall edges and its bot nav zones -- on disk,
+// keyed by the level's hash, so the server doesn't need to run clipper, poly2tri and recast every time the
+// level comes around again.  Since the hash covers the whole level file, any change to the level gets a new
+// cache file; any change to how we compute these things should bump FormatVersion.
+//
+// Clients use one too, keyed by the hash of the wall geometry the server sent, to hold that geometry along with
+// the rendering edges they built from it.
+class LevelCache
+{
+public:
+   struct ZoneInfo
+   {
+      Vector<Point> verts;
+      Vector<NeighboringZone> neighbors;
+   };
+
+private:
+   static string mCacheDir;
+
+   string getCacheFile(const string &hash) const;
+
+   string mExtension;               // Lets clients keep their files apart from a local server's
+   bool mModified;                  // Has anything been added since we read or wrote the file?
+
+public:
+   static const U32 FormatVersion = 2;
+
+   explicit LevelCache(const string &extension = "levelcache");     // Constructor
+
+   Vector<Point> wallEdgePoints;
+   bool hasWallEdges;
+
+   Vector<ZoneInfo> zones;
+   bool hasZones;
+
+   Vector<U8> wallGeometry;         // Walls as packed by Barrier::packWallGeometry()
+   bool hasWallGeometry;
+
+   static void setCacheDir(const string &dir);     // Pass "" to disable the cache
+   static bool isEnabled();
+   static bool isValidHash(const string &hash);
+
+   void clear();
+   bool read(const string &hash);   // Returns false if there is no usable cache file for hash
+   bool write(const string &hash);  // Only touches the disk if something has been added
+
+   void setWallEdges(const Vector<Point> &points);
+   void setWallGeometry(const Vector<U8> &geometry);
+
+   void storeZones(const Vector<BotNavMeshZone *> &allZones);
+   void createZones(GridDatabase &botZoneDatabase, Vector<BotNavMeshZone *> &allZones, bool triangulateZones) const;
+};
+
+
+}
+
+#endif
@@ -0,0 +1,178 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LevelPreloader.h"
+
+#include "Level.h"
+
+#include "Md5Utils.h"
+#include "stringUtils.h"
+
+#include "tnlPlatform.h"
+#include "tnlAssert.h"
+
+namespace Zap
+{
+
+// Constructor
+LevelPreloader::ReadFileEntry::ReadFileEntry(const string &filename)
+{
+   mFilename = filename;
+   mFileExists = false;
+   mFinished = false;
+}
+
+
+// Runs on the secondary thread
+void LevelPreloader::ReadFileEntry::run()
+{
+   mFileExists = readFile(mFilename, mContents);
+
+   if(mFileExists)
+   {
+      mHash = Level::computeHash(mContents);
+      mCache.read(mHash);
+   }
+}
+
+
+// Runs on the game thread, after run() is done
+void LevelPreloader::ReadFileEntry::finish()
+{
+   mFinished = true;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Constructor
+LevelPreloader::LevelPreloader()
+{
+   mState = Idle;
+   mPos = 0;
+   mLevel = NULL;
+   mHasher = NULL;
+}
+
+
+// Destructor
+LevelPreloader::~LevelPreloader()
+{
+   cancel();
+}
+
+
+void LevelPreloader::start(const string &filename, Master::DatabaseAccessThread *thread)
+{
+   cancel();
+
+   mFilename = filename;
+   mReader = new ReadFileEntry(filename);
+   mState = Reading;
+
+   thread->addEntry(mReader);
+}
+
+
+// Throw away anything we've loaded so far.  If the file is still being read, the secondary thread holds its
+// own reference to the reader, so it's safe to let go of ours.
+void LevelPreloader::cancel()
+{
+   delete mLevel;
+   mLevel = NULL;
+
+   delete mHasher;
+   mHasher = NULL;
+
+   mReader = NULL;
+   mFilename = "";
+   mPos = 0;
+   mState = Idle;
+}
+
+
+void LevelPreloader::idle(U32 timeLimit)
+{
+   if(mState == Reading && mReader->mFinished)
+   {
+      if(!mReader->mFileExists)
+      {
+         cancel();      // We'll let the regular loader report the problem
+         return;
+      }
+
+      mLevel = new Level();
+      mHasher = new Md5::IncrementalHasher();
+      mState = Parsing;
+   }
+
+   if(mState == Parsing)
+      parse(timeLimit);
+   else if(mState == FinishingWalls || mState == FinishingItems)
+      finishStep();
+}
+
+
+void LevelPreloader::parse(U32 timeLimit)
+{
+   U32 startTime = Platform::getRealMilliseconds();
+
+   bool done = false;
+
+   while(!done && Platform::getRealMilliseconds() - startTime < timeLimit)
+      done = mLevel->parseLevelLines(mReader->mContents, mFilename, mPos, LinesPerCheck, *mHasher);
+
+   if(done)
+   {
+      TNLAssert(mHasher->getHash() == mReader->mHash, "Level changed while we were loading it?");
+      mState = FinishingWalls;
+   }
+}
+
+
+// Does the next bit of Level::finishLoading(); each can take a while on a big level, so we do one per tick
+void LevelPreloader::finishStep()
+{
+   if(mState == FinishingWalls)
+   {
+      mLevel->finishWalls(mReader->mHash, mReader->mCache);
+      mState = FinishingItems;
+   }
+   else if(mState == FinishingItems)
+   {
+      mLevel->finishItems();
+      mState = Ready;
+   }
+}
+
+
+// Hands over the preloaded level, finishing any loading that's still left to do
+Level *LevelPreloader::takeLevel(const string &filename, LevelCache &cache)
+{
+   if(filename != mFilename || mState == Idle || mState == Reading)
+   {
+      cancel();
+      return NULL;
+   }
+
+   if(mState == Parsing)
+      parse(U32_MAX);
+
+   while(mState != Ready)
+      finishStep();
+
+   Level *level = mLevel;
+   mLevel = NULL;
+
+   cache = mReader->mCache;
+
+   cancel();
+
+   return level;
+}
+
+
+}
@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LEVEL_PRELOADER_H_
+#define _LEVEL_PRELOADER_H_
+
+#include "../master/DatabaseAccessThread.h"
+
+#include "LevelCache.h"
+
+#include "tnlTypes.h"
+
+#include <string>
+
+using namespace std;
+using namespace TNL;
+
+namespace Md5
+{
+   class IncrementalHasher;
+}
+
+
+namespace Zap
+{
+
+class Level;
+
+// Loads the next level while the scoreboard is showing at the end of a game, so cycleLevel() doesn't have to
+// stall the server while it reads and parses the file.  The file and its LevelCache entry are read on the
+// secondary thread; parsing creates game objects, so it stays on the game thread, but is spread over a number
+// of ticks.  Wall edges (which may mean a run of clipper) and engineered item snapping then get a tick each.
+class LevelPreloader
+{
+private:
+   // Reads the level file, and whatever we have cached for it, on the secondary thread
+   class ReadFileEntry : public Master::ThreadEntry
+   {
+   public:
+      string mFilename;
+      string mContents;
+      string mHash;
+      LevelCache mCache;
+      bool mFileExists;    // Written by run(), read on the game thread once mFinished is set
+      bool mFinished;      // Set by finish(), on the game thread
+
+      explicit ReadFileEntry(const string &filename);    // Constructor
+
+      void run();
+      void finish();
+   };
+
+   enum State {
+      Idle,
+      Reading,
+      Parsing,
+      FinishingWalls,
+      FinishingItems,
+      Ready,
+   };
+
+   State mState;
+   string mFilename;
+   RefPtr<ReadFileEntry> mReader;
+   size_t mPos;                     // How far we've parsed through the file
+   Level *mLevel;
+   Md5::IncrementalHasher *mHasher;
+
+   void parse(U32 timeLimit);
+   void finishStep();
+
+public:
+   static const S32 LinesPerCheck = 32;      // Parse this many lines between looks at the clock
+
+   LevelPreloader();                // Constructor
+   virtual ~LevelPreloader();       // Destructor
+
+   void start(const string &filename, Master::DatabaseAccessThread *thread);
+   void cancel();
+   void idle(U32 timeLimit);        // Parse for up to timeLimit ms
+
+   // Returns NULL if we weren't loading filename; caller owns level.  Fills cache with the level's LevelCache entry.
+   Level *takeLevel(const string &filename, LevelCache &cache);
+};
+
+
+}
+
+#endif
@@ -288,6 +288,13 @@ string LevelSource::getLevelFileName(S32 index)
 }
 
 
+// Levels that don't come from a file (StringLevelSource, levels sent by a remote host) return ""
+string LevelSource::findLevelFile(S32 index) const
+{
+   return "";
+}
+
+
 void LevelSource::setLevelFileName(S32 index, const string &filename)
 {
    mLevelInfos[index].filename = filename;
@@ -385,7 +392,7 @@ Level *MultiLevelSource::getLevel(S32 index) const
 
    const LevelInfo *levelInfo = &mLevelInfos[index];
 
-   string filename = FolderManager::findLevelFile(levelInfo->folder, levelInfo->filename);
+   string filename = findLevelFile(index);
 
    if(filename == "")
    {
@@ -406,6 +413,14 @@ Level *MultiLevelSource::getLevel(S32 index) const
 }
 
 
+string MultiLevelSource::findLevelFile(S32 index) const
+{
+   TNLAssert(index >= 0 && index < mLevelInfos.size(), "Index out of bounds!");
+
+   return FolderManager::findLevelFile(mLevelInfos[index].folder, mLevelInfos[index].filename);
+}
+
+
 // Returns a textual level descriptor good for logging and error messages and such
 string MultiLevelSource::getLevelFileDescriptor(S32 index) const
 {
@@ -577,31 +592,11 @@ FileListLevelSource::~FileListLevelSource()
 }
 
 
-// Load specified level, put results in gameObjectDatabase.  Return md5 hash of level.
-Level *FileListLevelSource::getLevel(S32 index) const
+string FileListLevelSource::findLevelFile(S32 index) const
 {
    TNLAssert(index >= 0 && index < mLevelInfos.size(), "Index out of bounds!");
 
-   const LevelInfo *levelInfo = &mLevelInfos[index];
-
-   string filename = FolderManager::findLevelFile(GameSettings::getFolderManager()->getLevelDir(), levelInfo->filename);
-
-   if(filename == "")
-   {
-      logprintf("Unable to find level file \"%s\".  Skipping...", levelInfo->filename.c_str());
-      return NULL;
-   }
-
-   Level *level = new Level();      // Will be deleted by caller
-
-   if(!level->loadLevelFromFile(filename))
-   {
-      logprintf("Unable to process level file \"%s\".  Skipping...", levelInfo->filename.c_str());
-      delete level;
-      return NULL;
-   }
-
-   return level;
+   return FolderManager::findLevelFile(GameSettings::getFolderManager()->getLevelDir(), mLevelInfos[index].filename);
 }
 
 
@@ -98,6 +98,7 @@ public:
    virtual bool populateLevelInfoFromSourceByIndex(S32 levelInfoIndex);
 
    virtual Level *getLevel(S32 index) const = 0;
+   virtual string findLevelFile(S32 index) const;     // Full path of level's file, or "" if it doesn't live in one
    virtual bool loadLevels(FolderManager *folderManager);
    virtual string getLevelFileDescriptor(S32 index) const = 0;
    virtual bool isEmptyLevelDirOk() const = 0;
@@ -125,6 +126,7 @@ public:
 
    bool loadLevels(FolderManager *folderManager);
    Level *getLevel(S32 index) const;
+   string findLevelFile(S32 index) const;
    string getLevelFileDescriptor(S32 index) const;
    bool isEmptyLevelDirOk() const;
 
@@ -163,7 +165,7 @@ public:
    FileListLevelSource(const Vector<string> &levelList, const string &folder, GameSettings *settings);     // Constructor
    virtual ~FileListLevelSource();                                                                                                                // Destructor
 
-   Level *getLevel(S32 index) const;
+   string findLevelFile(S32 index) const;
 
    static Vector<string> findAllFilesInPlaylist(const string &fileName, const string &levelDir);
 };
@@ -37,40 +37,99 @@ void checkArgCount(lua_State *L, S32 argsWanted, const char *methodName)
 }
 
 
+// Every binding passes the same string literals on each call, so we remember which profile each (table, function)
+// pair resolved to the first time around.  This avoids rescanning the profile table with strcmp on every call.
+// Entries are verified with a single strcmp on hit, so a caller passing a non-literal name can't get a stale profile.
+struct ResolvedProfile
+{
+   const void *table;                        // Class profile table or module name pointer
+   const char *functionName;                 // Caller's function name pointer
+   const char *profileName;                  // Name stored in the resolved profile
+   const LuaFunctionArgList *functionArgList;
+};
+
+static const U32 ResolvedProfileSlots = 512;    // Must be a power of 2
+static ResolvedProfile resolvedProfiles[ResolvedProfileSlots];
+
+
+static ResolvedProfile &getResolvedProfileSlot(const void *table, const char *functionName)
+{
+   U32 hash = U32(size_t(table) >> 3) * 31 + U32(size_t(functionName));
+   hash ^= hash >> 9;
+   return resolvedProfiles[hash & (ResolvedProfileSlots - 1)];
+}
+
+
+static const LuaFunctionArgList *findResolvedProfile(const void *table, const char *functionName)
+{
+   const ResolvedProfile &slot = getResolvedProfileSlot(table, functionName);
+
+   if(slot.table == table && slot.functionName == functionName && strcmp(slot.profileName, functionName) == 0)
+      return slot.functionArgList;
+
+   return NULL;
+}
+
+
+static void storeResolvedProfile(const void *table, const char *functionName, const char *profileName,
+                                 const LuaFunctionArgList *functionArgList)
+{
+   ResolvedProfile &slot = getResolvedProfileSlot(table, functionName);
+
+   slot.table           = table;
+   slot.functionName    = functionName;
+   slot.profileName     = profileName;
+   slot.functionArgList = functionArgList;
+}
+
+
 // === Centralized Parameter Checking ===
 // Returns index of matching parameter profile; throws error if it can't find one.  If you get a valid profile index back,
 // you can blindly convert the stack items with the confidence you'll get what you want; no further type checking is required.
 // In writing this function, I tried to be extra clear, perhaps at the expense of slight redundancy.
 S32 checkArgList(lua_State *L, const LuaFunctionProfile *functionInfos, const char *className, const char *functionName)
 {
-   const LuaFunctionProfile *functionInfo = NULL;
+   const LuaFunctionArgList *functionArgList = findResolvedProfile(functionInfos, functionName);
 
-   // First, find the correct profile for this function
-   for(S32 i = 0; functionInfos[i].functionName != NULL; i++)
-      if(strcmp(functionInfos[i].functionName, functionName) == 0)
-      {
-         functionInfo = &functionInfos[i];
-         break;
-      }
+   if(!functionArgList)
+   {
+      // First call from this site, find the correct profile for this function
+      for(S32 i = 0; functionInfos[i].functionName != NULL; i++)
+         if(strcmp(functionInfos[i].functionName, functionName) == 0)
+         {
+            functionArgList = &functionInfos[i].functionArgList;
+            storeResolvedProfile(functionInfos, functionName, functionInfos[i].functionName, functionArgList);
+            break;
+         }
 
-   if(!functionInfo)
-      return -1;
+      if(!functionArgList)
+         return -1;
+   }
 
-   return checkArgList(L, functionInfo->functionArgList, className, functionName);
+   return checkArgList(L, *functionArgList, className, functionName);
 }
 
 
 S32 checkArgList(lua_State *L, const char *moduleName, const char *functionName)
 {
-   ProfileMap profileMap = LuaModuleRegistrarBase::getModuleProfiles();
+   const LuaFunctionArgList *functionArgList = findResolvedProfile(moduleName, functionName);
+
+   if(functionArgList)
+      return checkArgList(L, *functionArgList, moduleName, functionName);
 
-   ProfileMap::iterator iter = profileMap.find(string(moduleName));
+   // Module profiles are fully registered before main, so pointers into the map are stable from here on
+   const ProfileMap &profileMap = LuaModuleRegistrarBase::getModuleProfiles();
+
+   ProfileMap::const_iterator iter = profileMap.find(string(moduleName));
    if(iter != profileMap.end())
    {
-      vector<LuaStaticFunctionProfile> &profiles = (*iter).second;
+      const vector<LuaStaticFunctionProfile> &profiles = (*iter).second;
       for(U32 i = 0; i < profiles.size(); i++)
          if(!strcmp(profiles[i].functionName, functionName))
+         {
+            storeResolvedProfile(moduleName, functionName, profiles[i].functionName, &profiles[i].functionArgList);
             return checkArgList(L, profiles[i].functionArgList, moduleName, functionName);
+         }
    }
 
    // No matching profile found
@@ -79,6 +138,22 @@ S32 checkArgList(lua_State *L, const char *moduleName, const char *functionName)
 }
 
 
+// Lua types that can possibly pass for each arg type, one bit per type.  lua_isnumber() accepts numeric strings and
+// lua_isstring() accepts numbers, so those go both ways.
+static const U32 BoolType   = 1 << LUA_TBOOLEAN;
+static const U32 NumberType = (1 << LUA_TNUMBER) | (1 << LUA_TSTRING);
+static const U32 StringType = (1 << LUA_TSTRING) | (1 << LUA_TNUMBER);
+static const U32 TableType  = 1 << LUA_TTABLE;
+static const U32 ObjectType = 1 << LUA_TUSERDATA;
+static const U32 AnyType    = U32_MAX;
+
+static const U32 argLuaTypes[] = {
+#  define LUA_ARG_TYPE_ITEM(a, b, luaTypes) luaTypes,
+      LUA_ARG_TYPE_TABLE
+#  undef LUA_ARG_TYPE_ITEM
+};
+
+
 S32 checkArgList(lua_State *L, const LuaFunctionArgList &functionArgList, const char *className, const char *functionName)
 {
    S32 stackDepth = lua_gettop(L);
@@ -97,7 +172,11 @@ S32 checkArgList(lua_State *L, const LuaFunctionArgList &functionArgList, const
          if(stackPos < stackDepth)
          {  
             stackPos++;
-            ok = checkLuaArgs(L, candidateArgList[j], stackPos);
+
+            // Most mismatches, such as a number where another profile wants a point, are caught by the type mask
+            // without calling into checkLuaArgs
+            ok = (argLuaTypes[candidateArgList[j]] & (1 << lua_type(L, stackPos))) && 
+                 checkLuaArgs(L, candidateArgList[j], stackPos);
          }
 
          if(!ok)
@@ -709,18 +788,15 @@ S32 luaTableCopy(lua_State *L)
 }
 
 
+// Calls luavec.lua's point.new(), which is saved in the registry when the Lua instance is configured, so we skip
+// looking it up through the globals every time.  Building the table here with the C API measured slower than
+// letting point.new's table constructor do it.
 void luaPushPoint(lua_State *L, F32 x, F32 y)
 {
-   // The luavec.lua script should already be loaded and have the 'point'
-   // methods set up
-   lua_getglobal(L, "point");    // point
-   lua_getfield(L, -1, "new");   // point, new
-   lua_pushnumber(L, x);         // point, new, x
-   lua_pushnumber(L, y);         // point, new, x, y
-
-   // Run
-   lua_call(L, 2, 1);            // point, pt
-   lua_remove(L, -2);            // pt
+   lua_getfield(L, LUA_REGISTRYINDEX, POINT_NEW_KEY);   // new
+   lua_pushnumber(L, x);                                // new, x
+   lua_pushnumber(L, y);                                // new, x, y
+   lua_call(L, 2, 1);                                   // pt
 }
 
 
@@ -951,7 +1027,7 @@ void getPointVectorFromTable(lua_State *L, S32 index, Vector<Point> &points)
 
 // Create a list of type names for displaying function signatures
 static const char *argTypeNames[] = {
-#  define LUA_ARG_TYPE_ITEM(a, name) name,
+#  define LUA_ARG_TYPE_ITEM(a, name, c) name,
       LUA_ARG_TYPE_TABLE
 #  undef LUA_ARG_TYPE_ITEM
 };
@@ -66,40 +66,40 @@ typedef pair<ClassName, vector<ClassName> > Node;
 namespace LuaArgs
 {
 
-   //                 Enum       Name
+   //                 Enum         Name                                             Lua types
 #  define LUA_ARG_TYPE_TABLE \
-   LUA_ARG_TYPE_ITEM( BOOL,        "Boolean"                                      ) \
-   LUA_ARG_TYPE_ITEM( INT,         "Integer"                                      ) \
-   LUA_ARG_TYPE_ITEM( INT_GE0,     "Integer >= 0"                                 ) \
-   LUA_ARG_TYPE_ITEM( INTS,        "One or more integers"                         ) \
-   LUA_ARG_TYPE_ITEM( INTx,        "Zero or more integers"                        ) \
-   LUA_ARG_TYPE_ITEM( NUM,         "Number"                                       ) \
-   LUA_ARG_TYPE_ITEM( NUM_GE0,     "Number >= 0"                                  ) \
-   LUA_ARG_TYPE_ITEM( STR,         "String"                                       ) \
-   LUA_ARG_TYPE_ITEM( STRS,        "One or more strings"                          ) \
-   LUA_ARG_TYPE_ITEM( PT,          "Lua point"                                    ) \
-   LUA_ARG_TYPE_ITEM( SIMPLE_LINE, "Pair of Lua points (singly or in table)"      ) \
-   LUA_ARG_TYPE_ITEM( LINE,        "Two or more Lua points (singly or in table)"  ) \
-   LUA_ARG_TYPE_ITEM( POLY,        "Three or more Lua points (singly or in table)") \
-   LUA_ARG_TYPE_ITEM( TABLE,       "Lua table"                                    ) \
-   LUA_ARG_TYPE_ITEM( ITEM,        "Item Object"                                  ) \
-   LUA_ARG_TYPE_ITEM( WEAP_ENUM,   "WeaponEnum"                                   ) \
-   LUA_ARG_TYPE_ITEM( WEAP_SLOT,   "Weapon slot #"                                ) \
-   LUA_ARG_TYPE_ITEM( MOD_ENUM,    "ModuleEnum"                                   ) \
-   LUA_ARG_TYPE_ITEM( MOD_SLOT,    "Module slot #"                                ) \
-   LUA_ARG_TYPE_ITEM( TEAM_INDX,   "Team index"                                   ) \
-   LUA_ARG_TYPE_ITEM( GEOM,        "Geometry (see documentation)"                 ) \
-   LUA_ARG_TYPE_ITEM( ROBOT,       "Robot Object"                                 ) \
-   LUA_ARG_TYPE_ITEM( LEVELGEN,    "Levelgen Script"                              ) \
-   LUA_ARG_TYPE_ITEM( EVENT,       "Event"                                        ) \
-   LUA_ARG_TYPE_ITEM( MOVOBJ,      "MoveObject"                                   ) \
-   LUA_ARG_TYPE_ITEM( BFOBJ,       "BfObject (or child class)"                    ) \
-   LUA_ARG_TYPE_ITEM( ANY,         "Any combination of 0 or more arguments"       ) \
+   LUA_ARG_TYPE_ITEM( BOOL,        "Boolean",                                       BoolType   ) \
+   LUA_ARG_TYPE_ITEM( INT,         "Integer",                                       NumberType ) \
+   LUA_ARG_TYPE_ITEM( INT_GE0,     "Integer >= 0",                                  NumberType ) \
+   LUA_ARG_TYPE_ITEM( INTS,        "One or more integers",                          NumberType ) \
+   LUA_ARG_TYPE_ITEM( INTx,        "Zero or more integers",                         AnyType    ) \
+   LUA_ARG_TYPE_ITEM( NUM,         "Number",                                        NumberType ) \
+   LUA_ARG_TYPE_ITEM( NUM_GE0,     "Number >= 0",                                   NumberType ) \
+   LUA_ARG_TYPE_ITEM( STR,         "String",                                        StringType ) \
+   LUA_ARG_TYPE_ITEM( STRS,        "One or more strings",                           StringType ) \
+   LUA_ARG_TYPE_ITEM( PT,          "Lua point",                                     TableType  ) \
+   LUA_ARG_TYPE_ITEM( SIMPLE_LINE, "Pair of Lua points (singly or in table)",       TableType  ) \
+   LUA_ARG_TYPE_ITEM( LINE,        "Two or more Lua points (singly or in table)",   TableType  ) \
+   LUA_ARG_TYPE_ITEM( POLY,        "Three or more Lua points (singly or in table)", TableType  ) \
+   LUA_ARG_TYPE_ITEM( TABLE,       "Lua table",                                     TableType  ) \
+   LUA_ARG_TYPE_ITEM( ITEM,        "Item Object",                                   ObjectType ) \
+   LUA_ARG_TYPE_ITEM( WEAP_ENUM,   "WeaponEnum",                                    NumberType ) \
+   LUA_ARG_TYPE_ITEM( WEAP_SLOT,   "Weapon slot #",                                 NumberType ) \
+   LUA_ARG_TYPE_ITEM( MOD_ENUM,    "ModuleEnum",                                    NumberType ) \
+   LUA_ARG_TYPE_ITEM( MOD_SLOT,    "Module slot #",                                 NumberType ) \
+   LUA_ARG_TYPE_ITEM( TEAM_INDX,   "Team index",                                    NumberType ) \
+   LUA_ARG_TYPE_ITEM( GEOM,        "Geometry (see documentation)",                  TableType  ) \
+   LUA_ARG_TYPE_ITEM( ROBOT,       "Robot Object",                                  ObjectType ) \
+   LUA_ARG_TYPE_ITEM( LEVELGEN,    "Levelgen Script",                               ObjectType ) \
+   LUA_ARG_TYPE_ITEM( EVENT,       "Event",                                         NumberType ) \
+   LUA_ARG_TYPE_ITEM( MOVOBJ,      "MoveObject",                                    ObjectType ) \
+   LUA_ARG_TYPE_ITEM( BFOBJ,       "BfObject (or child class)",                     ObjectType ) \
+   LUA_ARG_TYPE_ITEM( ANY,         "Any combination of 0 or more arguments",        AnyType    ) \
       
 
    // Create the enum declaration
    enum LuaArgType {
-#     define LUA_ARG_TYPE_ITEM(value, b) value,
+#     define LUA_ARG_TYPE_ITEM(value, b, c) value,
          LUA_ARG_TYPE_TABLE
 #     undef LUA_ARG_TYPE_ITEM
       END      // End of list sentinel value
@@ -182,6 +182,8 @@ const char *getString(lua_State *L, S32 index, const char *defaultVal);
 
 S32 luaTableCopy(lua_State *L);
 
+#define POINT_NEW_KEY "point_new"      // Registry key for luavec.lua's point.new()
+
 void luaPushPoint(lua_State *L, F32 x, F32 y);
 void luaPushPoint(lua_State *L, const Point &pt);
 
@@ -0,0 +1,156 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "LuaProfiler.h"
+
+#include "tnlLog.h"
+#include "tnlPlatform.h"
+
+#include <stdio.h>
+
+namespace Zap
+{
+
+// Statics
+bool LuaProfiler::mRunning = false;
+S64 LuaProfiler::mLastSampleTime = 0;
+map<string, F64> LuaProfiler::mStacks;
+Vector<string> LuaProfiler::mScripts;
+
+
+// Static method
+void LuaProfiler::start()
+{
+   mStacks.clear();
+   mRunning = true;
+   mLastSampleTime = Platform::getHighPrecisionTimerValue();
+}
+
+
+// Static method -- writes one "frame;frame;frame microseconds" line per stack
+bool LuaProfiler::stop(const string &filename)
+{
+   mRunning = false;
+
+   FILE *file = fopen(filename.c_str(), "w");
+   if(!file)
+   {
+      logprintf(LogConsumer::LogError, "Could not write Lua profile to %s", filename.c_str());
+      return false;
+   }
+
+   for(map<string, F64>::const_iterator it = mStacks.begin(); it != mStacks.end(); it++)
+      if(it->second >= 1)
+         fprintf(file, "%s %.0f\n", it->first.c_str(), it->second);
+
+   fclose(file);
+   mStacks.clear();
+
+   return true;
+}
+
+
+// Static method
+bool LuaProfiler::isRunning()
+{
+   return mRunning;
+}
+
+
+// Static method -- scripts can run inside one another (events fired from a binding, for example), so we keep
+// a stack of them; each sample is filed under the innermost one.  Calls must be paired with leaveScript().
+void LuaProfiler::enterScript(const string &scriptName)
+{
+   if(mRunning && mScripts.size() > 0)
+      charge(mScripts.last());      // Whatever the outer script did since its last sample
+   else
+      mLastSampleTime = Platform::getHighPrecisionTimerValue();
+
+   mScripts.push_back(scriptName);
+}
+
+
+// Static method -- the Lua stack has already unwound by the time we get here, so the tail end of the run is
+// charged to the script itself
+void LuaProfiler::leaveScript()
+{
+   if(mScripts.size() == 0)
+      return;
+
+   if(mRunning)
+      charge(mScripts.last());
+
+   mScripts.pop_back();
+}
+
+
+// Static method -- called from LuaScriptRunner's count hook
+void LuaProfiler::sample(lua_State *L)
+{
+   if(mRunning && mScripts.size() > 0)
+      charge(getStack(L, 0));
+}
+
+
+// Static method -- called when Lua calls into one of our bindings; charges the Lua code that led up to the call
+void LuaProfiler::enterBinding(lua_State *L)
+{
+   if(mRunning && mScripts.size() > 0)
+      charge(getStack(L, 1));      // Skip the binding's own frame
+}
+
+
+// Static method -- the time since enterBinding() was spent in C++, so charge it to the binding's frame
+void LuaProfiler::leaveBinding(lua_State *L)
+{
+   if(mRunning && mScripts.size() > 0)
+      charge(getStack(L, 0));
+}
+
+
+// Builds the folded stack for whatever is running in L, outermost frame first
+string LuaProfiler::getStack(lua_State *L, S32 skipLevels)
+{
+   lua_Debug ar;
+   S32 levels = 0;
+
+   while(lua_getstack(L, levels, &ar))
+      levels++;
+
+   string stack = mScripts.last();
+
+   for(S32 i = levels - 1; i >= skipLevels; i--)
+   {
+      if(!lua_getstack(L, i, &ar) || !lua_getinfo(L, "Sn", &ar))
+         continue;
+
+      const char *name = ar.name ? ar.name : "?";
+
+      char frame[256];
+      if(ar.what[0] == 'C')
+         dSprintf(frame, sizeof(frame), ";%s [C]", name);
+      else if(ar.what[0] == 'm')
+         dSprintf(frame, sizeof(frame), ";main (%s)", ar.short_src);
+      else
+         dSprintf(frame, sizeof(frame), ";%s (%s:%d)", name, ar.short_src, ar.linedefined);
+
+      stack += frame;
+   }
+
+   return stack;
+}
+
+
+// Adds the time since the last sample to stack, and starts a new sample
+void LuaProfiler::charge(const string &stack)
+{
+   S64 now = Platform::getHighPrecisionTimerValue();
+
+   mStacks[stack] += Platform::getHighPrecisionMilliseconds(now - mLastSampleTime) * 1000;
+   mLastSampleTime = now;
+}
+
+
+}
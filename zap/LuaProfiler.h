@@ -0,0 +1,58 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _LUAPROFILER_H_
+#define _LUAPROFILER_H_
+
+#include "LuaInc.h"
+
+#include "tnlTypes.h"
+#include "tnlVector.h"
+
+#include <string>
+#include <map>
+
+using namespace std;
+using namespace TNL;
+
+namespace Zap
+{
+
+// A cheap sampling profiler for our Lua scripts.  It piggybacks on the count hook in LuaScriptRunner; every
+// time the hook fires, the time since the previous sample is charged to the Lua stack that is running.  Time
+// spent inside C++ bindings (findVisibleObjects, getWaypoint, etc.) is measured directly and charged to the
+// binding, as a child of the Lua function that called it.
+//
+// Results are written in the "folded stacks" format used by flamegraph.pl and friends: one line per stack,
+// frames separated by semicolons, followed by a space and the number of microseconds spent there.
+class LuaProfiler
+{
+private:
+   static bool mRunning;
+   static S64 mLastSampleTime;
+   static map<string, F64> mStacks;       // Folded stack --> microseconds
+   static Vector<string> mScripts;        // Scripts currently running, innermost last
+
+   static string getStack(lua_State *L, S32 skipLevels);
+   static void charge(const string &stack);
+
+public:
+   static void start();
+   static bool stop(const string &filename);    // Returns false if the results could not be written
+   static bool isRunning();
+
+   static void enterScript(const string &scriptName);
+   static void leaveScript();
+
+   static void sample(lua_State *L);
+
+   static void enterBinding(lua_State *L);
+   static void leaveBinding(lua_State *L);
+};
+
+
+}
+
+#endif
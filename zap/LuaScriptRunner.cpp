@@ -12,6 +12,7 @@
 #include "GeomUtils.h"
 #include "Level.h"
 #include "LuaModule.h"
+#include "LuaProfiler.h"
 #include "ServerGame.h"
 #include "ship.h"
 #include "WallItem.h"
@@ -24,9 +25,16 @@
 #include "GameSettings.h"
 
 #include "stringUtils.h"
+#include "Md5Utils.h"
+
+#include <sys/stat.h>
 
 #include <clipper.hpp>
 
+extern "C" {
+#include <luajit.h>            // For luaJIT_setmode
+}
+
 #include "tnlLog.h"            // For logprintf
 #include "tnlRandom.h"
 
@@ -44,8 +52,24 @@ namespace Zap
 // Declare and Initialize statics:
 lua_State *LuaScriptRunner::L = NULL;
 string LuaScriptRunner::mScriptingDir;
+string LuaScriptRunner::mBytecodeCacheDir;
+
+list<string> LuaScriptRunner::mCachedScripts;
+map<string, list<string>::iterator> LuaScriptRunner::mCachedScriptIndex;
 
-deque<string> LuaScriptRunner::mCachedScripts;
+U32 LuaScriptRunner::mInstructionBudget = 0;
+U32 LuaScriptRunner::mTimeBudget = 0;
+U64 LuaScriptRunner::mInstructionCount = 0;
+U64 LuaScriptRunner::mInstructionLimit = 0;
+Vector<LuaScriptRunner *> LuaScriptRunner::mRunningScripts;
+
+lua_Alloc LuaScriptRunner::mDefaultAlloc = NULL;
+void *LuaScriptRunner::mDefaultAllocData = NULL;
+LuaScriptRunner::AllocationStats LuaScriptRunner::mAllocationStats;
+LuaScriptRunner::ScriptUsage *LuaScriptRunner::mCurrentUsage = NULL;
+S32 LuaScriptRunner::mGcPause = 200;      // Lua's defaults
+S32 LuaScriptRunner::mGcStepMul = 200;
+bool LuaScriptRunner::mJitWasOn = true;
 
 void LuaScriptRunner::clearScriptCache()
 {
@@ -54,6 +78,21 @@ void LuaScriptRunner::clearScriptCache()
 		deleteScript(mCachedScripts.front().c_str());
 		mCachedScripts.pop_front();
 	}
+
+	mCachedScriptIndex.clear();
+}
+
+
+void LuaScriptRunner::setBytecodeCacheDir(const string &dir)
+{
+   if(dir != "" && !makeSureFolderExists(dir))
+   {
+      logprintf(LogConsumer::LogWarning, "Could not create script cache folder %s; scripts will be compiled from source", dir.c_str());
+      mBytecodeCacheDir = "";
+      return;
+   }
+
+   mBytecodeCacheDir = dir;
 }
 
 
@@ -70,9 +109,24 @@ LuaScriptRunner::LuaScriptRunner()
    for(S32 i = 0; i < EventManager::EventTypes; i++)
       mSubscriptions[i] = false;
 
+   // Spread scripts evenly over the tick groups
+   mTickGroup = mNextScriptId % EventManager::TickGroups;
+
    mScriptId = "script" + itos(mNextScriptId++);
    mScriptType = ScriptTypeInvalid;
 
+   mUsage.calls = 0;
+   mUsage.time = 0;
+   mUsage.instructions = 0;
+   mUsage.allocated = 0;
+   mUsage.overruns = 0;
+   mUsage.deferredTicks = 0;
+
+   mThrottledTicks = 0;
+   mDeferredTickTime = 0;
+
+   mRunningScripts.push_back(this);
+
    LUAW_CONSTRUCTOR_INITIALIZATIONS;
 }
 
@@ -92,6 +146,16 @@ LuaScriptRunner::~LuaScriptRunner()
    // And delete the script's environment table from the Lua instance
    deleteScript(getScriptId());
 
+   if(mCurrentUsage == &mUsage)
+      mCurrentUsage = NULL;
+
+   for(S32 i = 0; i < mRunningScripts.size(); i++)
+      if(mRunningScripts[i] == this)
+      {
+         mRunningScripts.erase_fast(i);
+         break;
+      }
+
    LUAW_DESTRUCTOR_CLEANUP;
 }
 
@@ -116,9 +180,15 @@ void LuaScriptRunner::shutdown()
 {
    if(L)
    {
+      // LuaJIT only tears down its memory arena if its own allocator is still in place
+      lua_setallocf(L, mDefaultAlloc, mDefaultAllocData);
       lua_close(L);
       L = NULL;
    }
+
+   // Cached chunks lived in L's registry, so they are gone now too
+   mCachedScripts.clear();
+   mCachedScriptIndex.clear();
 }
 
 
@@ -128,6 +198,257 @@ const char *LuaScriptRunner::getScriptId()
 }
 
 
+S32 LuaScriptRunner::getTickGroup() const
+{
+   return mTickGroup;
+}
+
+
+const LuaScriptRunner::ScriptUsage &LuaScriptRunner::getUsage() const
+{
+   return mUsage;
+}
+
+
+// Static method
+void LuaScriptRunner::setScriptBudgets(U32 instructionBudget, U32 timeBudget)
+{
+   mInstructionBudget = instructionBudget;
+   mTimeBudget = timeBudget;
+
+   updateHook();
+}
+
+
+// Static method
+void LuaScriptRunner::updateHook()
+{
+   if(!L)
+      return;
+
+   // The count hook slows the interpreter down a bit, so only install it when we need it.  Note that LuaJIT
+   // doesn't call hooks from compiled traces, so instruction counts are a lower bound.
+   bool needHook = mInstructionBudget > 0 || LuaProfiler::isRunning();
+   lua_sethook(L, countInstructions, needHook ? LUA_MASKCOUNT : 0, InstructionHookInterval);
+}
+
+
+// Static method -- asks jit.status(), as there's no C API for it
+bool LuaScriptRunner::isJitOn()
+{
+   lua_getfield(L, LUA_REGISTRYINDEX, "_LOADED");
+   lua_getfield(L, -1, "jit");
+
+   bool on = false;
+
+   if(lua_istable(L, -1))
+   {
+      lua_getfield(L, -1, "status");
+      if(lua_pcall(L, 0, 1, 0) == 0)
+         on = lua_toboolean(L, -1);
+      lua_pop(L, 1);    // Result or error message
+   }
+
+   lua_pop(L, 2);       // jit and _LOADED
+   return on;
+}
+
+
+// Static method
+void LuaScriptRunner::startProfiling()
+{
+   bool restarting = LuaProfiler::isRunning();
+
+   LuaProfiler::start();
+
+   // Compiled traces never call the hook, so hot loops would vanish from the profile; run interpreted instead
+   if(L)
+   {
+      if(!restarting)
+         mJitWasOn = isJitOn();
+
+      luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_FLUSH);   // Throw away existing traces...
+      luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_OFF);     // ...and don't record any new ones
+   }
+
+   updateHook();
+}
+
+
+// Static method
+bool LuaScriptRunner::isProfiling()
+{
+   return LuaProfiler::isRunning();
+}
+
+
+// Static method
+bool LuaScriptRunner::stopProfiling(const string &filename)
+{
+   bool ok = LuaProfiler::stop(filename);
+
+   if(L && mJitWasOn)
+      luaJIT_setmode(L, 0, LUAJIT_MODE_ENGINE | LUAJIT_MODE_ON);
+
+   updateHook();
+
+   return ok;
+}
+
+
+// Static method
+void LuaScriptRunner::setGcParams(S32 pause, S32 stepMul)
+{
+   mGcPause = pause;
+   mGcStepMul = stepMul;
+
+   if(L)
+   {
+      lua_gc(L, LUA_GCSETPAUSE, mGcPause);
+      lua_gc(L, LUA_GCSETSTEPMUL, mGcStepMul);
+   }
+}
+
+
+S32 LuaScriptRunner::getGcPause()
+{
+   return mGcPause;
+}
+
+
+S32 LuaScriptRunner::getGcStepMul()
+{
+   return mGcStepMul;
+}
+
+
+const LuaScriptRunner::AllocationStats &LuaScriptRunner::getAllocationStats()
+{
+   return mAllocationStats;
+}
+
+
+// Wraps LuaJIT's allocator so we can keep statistics and charge allocations to the script that is running.  LuaJIT
+// won't accept a replacement allocator on 64-bit systems (it needs memory in the low 2GB), so we pass the actual
+// work through to its own allocator, which already keeps size-binned free lists.
+void *LuaScriptRunner::allocate(void *userData, void *ptr, size_t oldSize, size_t newSize)
+{
+   if(!ptr)
+      oldSize = 0;
+
+   void *result = mDefaultAlloc(mDefaultAllocData, ptr, oldSize, newSize);
+
+   if(newSize > 0 && !result)    // Failed; nothing changed
+      return NULL;
+
+   if(!ptr && newSize > 0)
+      mAllocationStats.allocs++;
+   else if(ptr && newSize == 0)
+      mAllocationStats.frees++;
+
+   S64 delta = S64(newSize) - S64(oldSize);
+
+   mAllocationStats.bytesInUse += delta;
+   if(mAllocationStats.bytesInUse > mAllocationStats.peakBytes)
+      mAllocationStats.peakBytes = mAllocationStats.bytesInUse;
+
+   // Only growth is charged; the GC frees whatever it likes, whenever it likes, regardless of who's running
+   if(mCurrentUsage && delta > 0)
+      mCurrentUsage->allocated += delta;
+
+   return result;
+}
+
+
+// Count hook, installed when an instruction budget is set or the profiler is running
+void LuaScriptRunner::countInstructions(lua_State *L, lua_Debug *ar)
+{
+   mInstructionCount += InstructionHookInterval;
+
+   if(LuaProfiler::isRunning())
+      LuaProfiler::sample(L);
+
+   if(mInstructionLimit > 0 && mInstructionCount > mInstructionLimit)
+   {
+      mInstructionLimit = 0;     // Don't fire again while the error unwinds
+      luaL_error(L, "Script exceeded its instruction budget of %d", mInstructionBudget * HardBudgetMultiplier);
+   }
+}
+
+
+// Called after a budgeted handler returns; scripts that went over budget have their next few onTicks deferred
+void LuaScriptRunner::checkBudget(F64 elapsed, U64 instructions)
+{
+   F64 overTime = mTimeBudget > 0 ? elapsed / mTimeBudget : 0;
+   F64 overInstructions = mInstructionBudget > 0 ? F64(instructions) / mInstructionBudget : 0;
+   F64 over = max(overTime, overInstructions);
+
+   if(over <= 1)
+      return;
+
+   mUsage.overruns++;
+   mThrottledTicks = S32(over) < MaxThrottleTicks ? S32(over) : MaxThrottleTicks;
+
+   // Report the first overrun, then every so often after that, so a chronic offender doesn't flood the log
+   if(mUsage.overruns == 1 || mUsage.overruns % 100 == 0)
+      logprintf(LogConsumer::ServerFilter, "%s %s went over its budget (%.1f ms, %llu instructions); %d overruns so far",
+                getErrorMessagePrefix(), extractFilename(mScriptName).c_str(), elapsed, (unsigned long long)instructions,
+                mUsage.overruns);
+}
+
+
+bool LuaScriptRunner::deferTick(U32 deltaT)
+{
+   if(mThrottledTicks <= 0)
+      return false;
+
+   mThrottledTicks--;
+   mDeferredTickTime += deltaT;
+   mUsage.deferredTicks++;
+
+   return true;
+}
+
+
+U32 LuaScriptRunner::getDeferredTickTime()
+{
+   U32 deferred = mDeferredTickTime;
+   mDeferredTickTime = 0;
+
+   return deferred;
+}
+
+
+static S32 QSORT_CALLBACK usesMoreTimeSort(LuaScriptRunner **a, LuaScriptRunner **b)
+{
+   F64 timeA = (*a)->getUsage().time;
+   F64 timeB = (*b)->getUsage().time;
+
+   return timeA > timeB ? -1 : (timeA < timeB ? 1 : 0);
+}
+
+
+// Static method
+void LuaScriptRunner::getScriptStats(Vector<string> &lines, S32 count)
+{
+   Vector<LuaScriptRunner *> scripts = mRunningScripts;
+   scripts.sort(usesMoreTimeSort);
+
+   for(S32 i = 0; i < scripts.size() && i < count; i++)
+   {
+      const ScriptUsage &usage = scripts[i]->mUsage;
+
+      char line[256];
+      dSprintf(line, sizeof(line), "%s %s: %u calls, %.0f ms, %llu instr, %llu KB allocated, %u overruns, %u deferred",
+               scripts[i]->getErrorMessagePrefix(), extractFilename(scripts[i]->mScriptName).c_str(), usage.calls,
+               usage.time, (unsigned long long)usage.instructions, (unsigned long long)(usage.allocated / 1024), usage.overruns,
+               usage.deferredTicks);
+
+      lines.push_back(line);
+   }
+}
+
+
 // Load the script, execute the chunk to get it in memory, then run its main() function
 // Return false if there was an error, true if not
 bool LuaScriptRunner::runScript(bool cacheScript)
@@ -226,8 +547,6 @@ bool LuaScriptRunner::loadScript(bool cacheScript)
    if(mScriptName == "")
       return true;
 
-   static const S32 MAX_CACHE_SIZE = 16;
-
    // On a dedicated server, we'll always cache our scripts; on a regular server, we'll cache script except when the user is testing
    // from the editor.  In that case, we'll want to see script changes take place immediately, and we're willing to pay a small
    // performance penalty on level load to get that.
@@ -242,30 +561,25 @@ bool LuaScriptRunner::loadScript(bool cacheScript)
          loadCompileScript(mScriptName.c_str());
       else  
       {
-         bool found = false;
-
          // Check if script is in our cache
-         S32 cacheSize = (S32)mCachedScripts.size();
+         map<string, list<string>::iterator>::iterator it = mCachedScriptIndex.find(mScriptName);
 
-         for(S32 i = 0; i < cacheSize; i++)
-            if(mCachedScripts[i] == mScriptName)
-            {
-               found = true;
-               break;
-            }
-
-         if(!found)     // Script is not (yet) cached
+         if(it != mCachedScriptIndex.end())
+            mCachedScripts.splice(mCachedScripts.begin(), mCachedScripts, it->second);    // Mark as most recently used
+         else           // Script is not (yet) cached
          {
-            if(cacheSize > MAX_CACHE_SIZE)
+            if((S32)mCachedScripts.size() >= MaxCachedScripts)
             {
-               // Remove oldest script from the cache
-               deleteScript(mCachedScripts.front().c_str());
-               mCachedScripts.pop_front();
+               // Remove least recently used script from the cache
+               deleteScript(mCachedScripts.back().c_str());
+               mCachedScriptIndex.erase(mCachedScripts.back());
+               mCachedScripts.pop_back();
             }
 
             // Load new script into cache using full name as registry key
             loadCompileSaveScript(mScriptName.c_str(), mScriptName.c_str());
-            mCachedScripts.push_back(mScriptName);
+            mCachedScripts.push_front(mScriptName);
+            mCachedScriptIndex[mScriptName] = mCachedScripts.begin();
          }
 
          lua_getfield(L, LUA_REGISTRYINDEX, mScriptName.c_str());    // Load script from cache
@@ -329,7 +643,7 @@ bool LuaScriptRunner::runMain(const Vector<string> &args)
 
 
 // Returns true if there was an error, false if everything ran ok
-bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
+bool LuaScriptRunner::runCmd(const char *function, S32 returnValues, bool enforceBudget)
 {
    try 
    {
@@ -347,7 +661,40 @@ bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
          lua_insert(L, 1);                                      // -- _stackTracer, function, <<args>>
       }
 
+      // Handlers can fire events of their own, so save the outer handler's limit and restore it when we're done
+      U64 outerInstructionLimit = mInstructionLimit;
+      ScriptUsage *outerUsage = mCurrentUsage;
+      U64 startInstructions = mInstructionCount;
+      S64 startTime = Platform::getHighPrecisionTimerValue();
+
+      mCurrentUsage = &mUsage;
+
+      if(enforceBudget && mInstructionBudget > 0)
+      {
+         U64 limit = mInstructionCount + U64(mInstructionBudget) * HardBudgetMultiplier;
+         if(mInstructionLimit == 0 || limit < mInstructionLimit)
+            mInstructionLimit = limit;
+      }
+
+      bool profiling = LuaProfiler::isRunning();
+      if(profiling)
+         LuaProfiler::enterScript(extractFilename(mScriptName));
+
       S32 error = lua_pcall(L, args, returnValues, -2 - args);  // -- _stackTracer, <<return values>>
+
+      if(profiling)
+         LuaProfiler::leaveScript();
+
+      mInstructionLimit = outerInstructionLimit;
+      mCurrentUsage = outerUsage;
+
+      F64 elapsed = Platform::getHighPrecisionMilliseconds(Platform::getHighPrecisionTimerValue() - startTime);
+      U64 instructions = mInstructionCount - startInstructions;
+
+      mUsage.calls++;
+      mUsage.time += elapsed;
+      mUsage.instructions += instructions;
+
       if(error)
       {
          string msg = lua_tostring(L, -1);
@@ -356,6 +703,9 @@ bool LuaScriptRunner::runCmd(const char *function, S32 returnValues)
          throw LuaException("In method " + string(function) +"():\n" + msg);
       }
 
+      if(enforceBudget)
+         checkBudget(elapsed, instructions);
+
       lua_remove(L, 1);    // Remove _stackTracer               // -- <<return values>>
 
       // Do not clear stack -- caller probably wants <<return values>>
@@ -394,8 +744,20 @@ bool LuaScriptRunner::startLua(const string &scriptingDir)
       if(!L)
          throw LuaException("Could not instantiate the Lua interpreter.");
 
+      // Route allocations through our accounting wrapper; shutdown() puts LuaJIT's allocator back
+      mDefaultAlloc = lua_getallocf(L, &mDefaultAllocData);
+      lua_setallocf(L, allocate, NULL);
+
+      mAllocationStats.allocs = 0;
+      mAllocationStats.frees = 0;
+      mAllocationStats.bytesInUse = lua_gc(L, LUA_GCCOUNT, 0) * 1024 + lua_gc(L, LUA_GCCOUNTB, 0);
+      mAllocationStats.peakBytes = mAllocationStats.bytesInUse;
+
       configureNewLuaInstance(L);   // Throws any errors it encounters
 
+      setScriptBudgets(mInstructionBudget, mTimeBudget);   // Install the instruction counting hook, if needed
+      setGcParams(mGcPause, mGcStepMul);
+
       return true;
    }
 
@@ -442,6 +804,12 @@ void LuaScriptRunner::configureNewLuaInstance(lua_State *L)
    // Load our vector library
    loadCompileRunHelper("luavec.lua");
 
+   // Keep a copy of point.new so luaPushPoint doesn't have to look it up for every point
+   lua_getglobal(L, "point");                           // -- point
+   lua_getfield(L, -1, "new");                          // -- point, point.new
+   lua_setfield(L, LUA_REGISTRYINDEX, POINT_NEW_KEY);   // -- point
+   lua_pop(L, 1);                                       // -- <<empty stack>>
+
    // Load our helper functions and store copies of the compiled code in the registry where we can use them for starting new scripts
    loadCompileSaveHelper("robot_helper_functions.lua",    ROBOT_HELPER_FUNCTIONS_KEY);
    loadCompileSaveHelper("levelgen_helper_functions.lua", LEVELGEN_HELPER_FUNCTIONS_KEY);
@@ -490,8 +858,92 @@ void LuaScriptRunner::loadCompileScript(const char *filename)
    // LUA_ERRSYNTAX: syntax error during pre-compilation;  [[ err == 3 ]]
    // LUA_ERRMEM: memory allocation error.  [[ err == 4 ]]
 
-   if(filename[0] != '\0' && luaL_loadfile(L, filename) != 0)
+   if(filename[0] == '\0')
+      return;
+
+   string cacheFile, sourceKey;
+
+   if(mBytecodeCacheDir != "")
+   {
+      struct stat st;
+      if(stat(filename, &st) == 0)
+      {
+         // Path + mtime + size + contents; hashing the source is far cheaper than parsing it
+         sourceKey = string(filename) + "|" + itos((S64)st.st_mtime) + "|" + itos((S64)st.st_size) + "|" + 
+                     Md5::getHashFromFile(filename) + "|" + LUA_RELEASE;
+         cacheFile = joindir(mBytecodeCacheDir, Md5::getHashFromString(filename) + ".luac");
+
+         if(loadBytecodeFromDisk(filename, cacheFile, sourceKey))
+            return;
+      }
+   }
+
+   if(luaL_loadfile(L, filename) != 0)
       throw LuaException("Error compiling script " + string(filename) + "\n" + string(lua_tostring(L, -1)));
+
+   if(cacheFile != "")
+      saveBytecodeToDisk(cacheFile, sourceKey);
+}
+
+
+// Bytecode cache files are a single line holding the key of the source they were compiled from, followed by the bytecode itself
+static const string BytecodeCacheHeader = "BFLUAC1 ";
+
+// Tries to load a previously compiled version of filename; on success leaves the chunk on the stack and returns true
+bool LuaScriptRunner::loadBytecodeFromDisk(const string &filename, const string &cacheFile, const string &sourceKey)
+{
+   FILE *f = fopen(cacheFile.c_str(), "rb");
+   if(!f)
+      return false;
+
+   string contents;
+   char buffer[4096];
+   size_t bytesRead;
+
+   while((bytesRead = fread(buffer, 1, sizeof(buffer), f)) > 0)
+      contents.append(buffer, bytesRead);
+
+   fclose(f);
+
+   string header = BytecodeCacheHeader + sourceKey + "\n";
+
+   if(contents.compare(0, header.length(), header) != 0)     // Source has changed, or file is from an older format
+      return false;
+
+   string chunkName = "@" + filename;     // Same name luaL_loadfile would use, so error messages are unchanged
+   if(luaL_loadbuffer(L, contents.data() + header.length(), contents.length() - header.length(), chunkName.c_str()) != 0)
+   {
+      lua_pop(L, 1);       // Bytecode from a different Lua build, probably; just compile from source
+      return false;
+   }
+
+   return true;
+}
+
+
+static int writeBytecode(lua_State *L, const void *data, size_t size, void *userData)
+{
+   static_cast<string *>(userData)->append(static_cast<const char *>(data), size);
+   return 0;
+}
+
+
+// Dump the chunk on top of the stack to cacheFile; failures are not fatal, the script just gets recompiled next time
+void LuaScriptRunner::saveBytecodeToDisk(const string &cacheFile, const string &sourceKey)
+{
+   string bytecode;
+   if(lua_dump(L, writeBytecode, &bytecode) != 0)
+      return;
+
+   FILE *f = fopen(cacheFile.c_str(), "wb");
+   if(!f)
+      return;
+
+   string header = BytecodeCacheHeader + sourceKey + "\n";
+
+   fwrite(header.data(), 1, header.length(), f);
+   fwrite(bytecode.data(), 1, bytecode.length(), f);
+   fclose(f);
 }
 
 
@@ -967,6 +1419,7 @@ void LuaScriptRunner::setGlobalObjectArrays(lua_State *L)
       METHOD(CLASS, findAllObjects,        ARRAYDEF({{ INTx, END }, { END }}), 2 ) \
       METHOD(CLASS, findAllObjectsInArea,  ARRAYDEF({{ PT, PT, INTS, END }}), 1 ) \
       METHOD(CLASS, addItem,               ARRAYDEF({{ BFOBJ, END }}), 1 )  \
+      METHOD(CLASS, addItems,              ARRAYDEF({{ TABLE, END }}), 1 )  \
       METHOD(CLASS, getGameInfo,           ARRAYDEF({{ END }}), 1 )         \
       METHOD(CLASS, getPlayerCount,        ARRAYDEF({{ END }}), 1 )         \
       METHOD(CLASS, subscribe,             ARRAYDEF({{ EVENT, END }}), 1 )  \
@@ -1225,6 +1678,32 @@ S32 LuaScriptRunner::lua_findAllObjectsInArea(lua_State *L)
 }
 
 
+// Adds obj to the game or editor, as appropriate.  Returns true if a wall was added.
+bool LuaScriptRunner::addItemToLevel(BfObject *obj)
+{
+   // Silently ignore illegal items when being run from the editor.  For the moment, if mGame is not a server, then
+   // we are running from the editor.  This could conceivably change, but for the moment it seems to hold true.
+   if(!getLuaGame()->isServer() && !obj->canAddToEditor())
+      return false;
+
+   // Some objects require special handling
+   if(obj->getObjectTypeNumber() == PolyWallTypeNumber)
+   {
+      if(mLuaGame)
+      {
+         obj->addToGame(mLuaGame, mLevel);
+         obj->onGeomChanged();
+      }
+   }
+   else if(obj->getObjectTypeNumber() == WallItemTypeNumber)
+      mLevel->addWallItem(static_cast<WallItem *>(obj), mLuaGame);
+   else
+      obj->addToGame(getLuaGame(), mLevel);
+
+   return isWallType(obj->getObjectTypeNumber());
+}
+
+
 /**
  * @luafunc LuaScriptRunner::addItem(BfObject obj)
  *
@@ -1246,27 +1725,61 @@ S32 LuaScriptRunner::lua_addItem(lua_State *L)
    lua_pop(L, 1);
 
    if(obj)
+      addItemToLevel(obj);
+
+   return 0;
+}
+
+/**
+ * @luafunc LuaScriptRunner::addItems(table objs)
+ *
+ * @brief Add a table of BfObjects to the game or editor in one go.
+ *
+ * @descr This works like calling addItem() on each object, but wall geometry
+ * is only rebuilt once, after all the objects have been added.  Levelgens that
+ * create many walls should use this instead of addItem().
+ *
+ * @param objs A table of BfObjects to be added
+ */
+S32 LuaScriptRunner::lua_addItems(lua_State *L)
+{
+   checkArgList(L, functionArgs, luaClassName, "addItems");
+
+   TNLAssert(getLuaGame() != NULL, "Game must not be NULL!");
+   TNLAssert(mLevel != NULL, "Grid Database must not be NULL!");
+
+   // Collect and check everything before adding anything, so a bad entry raises its error without leaving the
+   // level half-built and the batch still open
+   Vector<BfObject *> objs;
+
+   S32 count = (S32)lua_objlen(L, 1);
+   for(S32 i = 1; i <= count; i++)
    {
-      // Silently ignore illegal items when being run from the editor.  For the moment, if mGame is not a server, then
-      // we are running from the editor.  This could conceivably change, but for the moment it seems to hold true.
-      if(getLuaGame()->isServer() || obj->canAddToEditor())
-      {
-         // Some objects require special handling
-         if(obj->getObjectTypeNumber() == PolyWallTypeNumber)
-         {
-            if(mLuaGame)
-            {
-               obj->addToGame(mLuaGame, mLevel);
-               obj->onGeomChanged();
-            }
-         }
-         else if(obj->getObjectTypeNumber() == WallItemTypeNumber)
-            mLevel->addWallItem(static_cast<WallItem *>(obj), mLuaGame);
-         else
-            obj->addToGame(getLuaGame(), mLevel);
-      }
+      lua_rawgeti(L, 1, i);                              // -- table, obj
+      objs.push_back(luaW_check<BfObject>(L, -1));
+      lua_pop(L, 1);                                     // -- table
    }
 
+   lua_pop(L, 1);                                        // -- <<empty stack>>
+
+   bool modifiedWalls = false;
+
+   mLevel->beginBatchGeomUpdate();
+
+   for(S32 i = 0; i < objs.size(); i++)
+      if(objs[i] && addItemToLevel(objs[i]))
+         modifiedWalls = true;
+
+   // Rebuild wall edges once for the whole batch, so engineered items can mount to the new walls.  The editor
+   // rebuilds all its geometry after a plugin runs, so there is nothing to do there.
+   Vector<const WallSegment *> wallSegments;
+   Vector<Point> wallEdgePoints;
+
+   if(modifiedWalls && getLuaGame()->isServer())
+      mLevel->getWallSegments(wallSegments);
+
+   mLevel->endBatchGeomUpdate(mLevel, wallSegments, wallEdgePoints, wallSegments.size() > 0);
+
    return 0;
 }
 
@@ -13,7 +13,8 @@
 #include "tnl.h"
 #include "tnlVector.h"
 
-#include <deque>
+#include <list>
+#include <map>
 #include <string>
 
 using namespace std;
@@ -46,10 +47,39 @@ class MenuItem;
 class LuaScriptRunner
 {
 
+public:
+   // Resources consumed by a script over its lifetime
+   struct ScriptUsage
+   {
+      U32 calls;                 // Number of handler calls
+      F64 time;                  // Total wall time, in ms
+      U64 instructions;          // Approximate; only counted when an instruction budget is set
+      U64 allocated;             // Bytes allocated while this script was running.  Scripts share one Lua state, so the GC's
+                                 // frees can't be traced back to a script and aren't counted; informational only
+      U32 overruns;              // Number of calls that went over budget
+      U32 deferredTicks;         // Number of onTick events skipped while throttled
+   };
+
+   // Allocation counts for L, as seen by our allocator
+   struct AllocationStats
+   {
+      U64 allocs;
+      U64 frees;
+      S64 bytesInUse;
+      S64 peakBytes;
+   };
+
 private:
-   static deque<string> mCachedScripts;
+   static const S32 MaxCachedScripts = 64;
+
+   static list<string> mCachedScripts;                                  // Most recently used first
+   static map<string, list<string>::iterator> mCachedScriptIndex;       // Lets us find a script's place in the list quickly
 
    static string mScriptingDir;
+   static string mBytecodeCacheDir;    // Where compiled scripts are saved between runs; empty if disk caching disabled
+
+   static bool loadBytecodeFromDisk(const string &filename, const string &cacheFile, const string &sourceKey);
+   static void saveBytecodeToDisk(const string &cacheFile, const string &sourceKey);
 
    void setLuaArgs(const Vector<string> &args);
    static void setModulePath();
@@ -61,6 +91,32 @@ private:
 
    void pushStackTracer();      // Put error handler function onto the stack
 
+   // Per-script resource budgets, applied to event handlers
+   static const S32 InstructionHookInterval = 1000;   // Count hook fires every this many VM instructions
+   static const S32 HardBudgetMultiplier = 20;        // Handlers using this many times their instruction budget are aborted
+   static const S32 MaxThrottleTicks = 8;             // Longest an over-budget script will have its onTick deferred
+
+   static U32 mInstructionBudget;      // Instructions per handler call; 0 means don't count
+   static U32 mTimeBudget;             // Milliseconds per handler call; 0 means no limit
+   static U64 mInstructionCount;       // Running count of instructions executed by all scripts
+   static U64 mInstructionLimit;       // Abort the running handler when mInstructionCount passes this; 0 for no limit
+   static Vector<LuaScriptRunner *> mRunningScripts;   // Every live script, for /scriptstats
+
+   static lua_Alloc mDefaultAlloc;     // LuaJIT's own allocator, which does the real work
+   static void *mDefaultAllocData;
+   static AllocationStats mAllocationStats;
+   static ScriptUsage *mCurrentUsage;  // Usage of the script currently running, so allocations can be charged to it
+   static S32 mGcPause;
+   static S32 mGcStepMul;
+   static bool mJitWasOn;              // JIT state before profiling turned it off, so we can put it back
+
+   static void *allocate(void *userData, void *ptr, size_t oldSize, size_t newSize);
+
+   static void countInstructions(lua_State *L, lua_Debug *ar);
+   static void updateHook();
+   static bool isJitOn();
+   void checkBudget(F64 elapsed, U64 instructions);
+
    static void setEnums(lua_State *L);                       // Set a whole slew of enum values that we want the scripts to have access to
    static void setGlobalObjectArrays(lua_State *L);          // And some objects
    static void logErrorHandler(const char *msg, const char *prefix);
@@ -87,6 +143,11 @@ protected:
 
    string mScriptId;             // Unique id for this script
    ScriptType mScriptType;
+   S32 mTickGroup;               // Which group of TickEvent subscribers we belong to
+   ScriptUsage mUsage;
+
+   S32 mThrottledTicks;          // How many more onTick events to defer because we went over budget
+   U32 mDeferredTickTime;        // Time accumulated by deferred onTick events, added to the next one we run
 
    bool mSubscriptions[EventManager::EventTypes];  // Keep track of which events we're subscribed to for rapid unsubscription upon death or destruction
 
@@ -105,6 +166,8 @@ protected:
 
    static S32 findObjectById(lua_State *L, const Vector<DatabaseObject *> *objects);
 
+   bool addItemToLevel(BfObject *obj);
+
 
 // Sets a var in the script's environment to give access to the caller's "this" obj, with the var name "name".
 // Basically sets the "bot", "levelgen", and "plugin" vars.
@@ -132,6 +195,16 @@ public:
    virtual ~LuaScriptRunner();      // Destructor
 
    static void clearScriptCache();
+   static void setBytecodeCacheDir(const string &dir);   // Pass "" to disable the on-disk bytecode cache
+   static void setScriptBudgets(U32 instructionBudget, U32 timeBudget);   // Pass 0 to disable either
+   static void setGcParams(S32 pause, S32 stepMul);                       // See LUA_GCSETPAUSE and LUA_GCSETSTEPMUL
+   static S32 getGcPause();
+   static S32 getGcStepMul();
+   static const AllocationStats &getAllocationStats();
+   static void getScriptStats(Vector<string> &lines, S32 count);          // Describe the count biggest consumers of time
+   static void startProfiling();
+   static bool isProfiling();
+   static bool stopProfiling(const string &filename);                     // Writes folded stacks for flamegraph.pl
 
    virtual const char *getErrorMessagePrefix();
 
@@ -148,9 +221,14 @@ public:
    bool loadScript(bool cacheScript);  // Loads script from file into a Lua chunk, then runs it
    bool runScript(bool cacheScript);   // Load the script, execute the chunk to get it in memory, then run its main() function
 
-   bool runCmd(const char *function, S32 returnValues);
+   bool runCmd(const char *function, S32 returnValues, bool enforceBudget = false);
+
+   bool deferTick(U32 deltaT);         // True if this onTick should be skipped because we're over budget
+   U32 getDeferredTickTime();          // Returns and clears time skipped while throttled
+   const ScriptUsage &getUsage() const;
 
    const char *getScriptId();
+   S32 getTickGroup() const;
    static bool loadFunction(lua_State *L, const char *scriptId, const char *functionName);
    bool loadAndRunGlobalFunction(lua_State *L, const char *key, ScriptContext context);
 
@@ -191,6 +269,7 @@ public:
    S32 lua_findObjectById(lua_State *L);
 
    S32 lua_addItem(lua_State *L);
+   S32 lua_addItems(lua_State *L);
 
    S32 lua_getGameInfo(lua_State *L);
    S32 lua_getPlayerCount(lua_State *L);
@@ -52,6 +52,7 @@ extern "C"
 
 #include "LuaBase.h"   
 #include "LuaException.h"   
+#include "LuaProfiler.h"
 
 #include <string>
 #include <vector>
@@ -1245,7 +1246,16 @@ int luaW_doMethod(lua_State *L)
    if(w) 
    {
       lua_remove(L, 1);
-      return (w->*methodName)(L);
+
+      if(!LuaProfiler::isRunning())
+         return (w->*methodName)(L);
+
+      // Profiling; bracket the call so the time gets charged to the binding rather than the script
+      LuaProfiler::enterBinding(L);
+      int results = (w->*methodName)(L);
+      LuaProfiler::leaveBinding(L);
+
+      return results;
    }
 
    lua_pushnil(L);
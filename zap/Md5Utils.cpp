@@ -121,6 +121,12 @@ void IncrementalHasher::add(const string &line)
 }
 
 
+void IncrementalHasher::add(const char *data, size_t len)
+{
+   md5_process(&mHashState, reinterpret_cast<const unsigned char *>(data), (unsigned long)len);
+}
+
+
 // Return the final computed hash
 string IncrementalHasher::getHash()
 {
@@ -26,6 +26,7 @@ private:
 public:
    IncrementalHasher();
    void add(const string &line);
+   void add(const char *data, size_t len);
    string getHash();
 };
 
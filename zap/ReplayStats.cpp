@@ -0,0 +1,344 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#include "ReplayStats.h"
+
+#include "GameRecorder.h"
+#include "ClientGame.h"
+#include "ClientInfo.h"
+#include "FontManager.h"
+#include "UIManager.h"
+#include "gameType.h"
+#include "Level.h"
+#include "ship.h"
+#include "stringUtils.h"
+#include "tnlAsyncWriter.h"
+
+#include <math.h>
+
+#ifndef TNL_OS_WIN32
+#  include <unistd.h>
+#  include <sys/wait.h>
+#endif
+
+namespace Zap
+{
+
+ReplayStatsPlayback::ReplayStatsPlayback(ClientGame *game, const char *filename) : Parent(game, filename)
+{
+   mClientGame = game;
+}
+
+
+ReplayStatsPlayback::PlayerStats &ReplayStatsPlayback::getPlayer(const StringTableEntry &name)
+{
+   for(S32 i = 0; i < mPlayers.size(); i++)
+      if(mPlayers[i].name == name)
+         return mPlayers[i];
+
+   PlayerStats stats;
+   stats.name = name;
+   stats.team = GameType::TeamNotSpecified;
+   stats.score = 0;
+   stats.kills = 0;
+   stats.deaths = 0;
+   stats.suicides = 0;
+   stats.flagPickups = 0;
+   stats.flagCarryTime = 0;
+
+   mPlayers.push_back(stats);
+   return mPlayers.last();
+}
+
+
+void ReplayStatsPlayback::onKillReported(const StringTableEntry &victim, const StringTableEntry &killer, const StringTableEntry &killerDescr)
+{
+   getPlayer(victim).deaths++;
+
+   if(killer == victim)
+      getPlayer(victim).suicides++;
+   else if(killer)
+      getPlayer(killer).kills++;
+}
+
+
+// Looks over the game as it stands every SampleInterval
+void ReplayStatsPlayback::sample(U32 timeDelta)
+{
+   const Vector<RefPtr<ClientInfo> > &clientInfos = *mClientGame->getClientInfos();
+
+   for(S32 i = 0; i < clientInfos.size(); i++)
+   {
+      PlayerStats &stats = getPlayer(clientInfos[i]->getName());
+      stats.team  = clientInfos[i]->getTeamIndex();
+      stats.score = clientInfos[i]->getScore();
+   }
+
+   Level *level = mClientGame->getLevel();
+
+   // Where everyone is
+   const U8 shipTypes[] = { PlayerShipTypeNumber, RobotShipTypeNumber };
+   for(U32 i = 0; i < ARRAYSIZE(shipTypes); i++)
+   {
+      const Vector<DatabaseObject *> *ships = level->findObjects_fast(shipTypes[i]);
+      for(S32 j = 0; j < ships->size(); j++)
+      {
+         Ship *ship = static_cast<Ship *>(ships->get(j));
+         if(ship->isDestroyed())
+            continue;
+
+         Point pos = ship->getActualPos();
+         mHeatmap[std::make_pair(S32(floor(pos.x / HeatmapCellSize)), S32(floor(pos.y / HeatmapCellSize)))]++;
+      }
+   }
+
+   // Who has the flags
+   const Vector<DatabaseObject *> *flags = level->findObjects_fast(FlagTypeNumber);
+   for(S32 i = 0; i < flags->size(); i++)
+   {
+      FlagItem *flag = static_cast<FlagItem *>(flags->get(i));
+      Ship *ship = flag->getMount();
+      ClientInfo *clientInfo = ship ? ship->getClientInfo() : NULL;
+      StringTableEntry carrier = clientInfo ? clientInfo->getName() : StringTableEntry();
+
+      S32 index = -1;
+      for(S32 j = 0; j < mFlagCarriers.size(); j++)
+         if(mFlagCarriers[j].flag.getPointer() == flag)
+         {
+            index = j;
+            break;
+         }
+
+      if(index == -1)
+      {
+         FlagCarrier flagCarrier;
+         flagCarrier.flag = flag;
+         mFlagCarriers.push_back(flagCarrier);
+         index = mFlagCarriers.size() - 1;
+      }
+
+      if(carrier)
+      {
+         PlayerStats &stats = getPlayer(carrier);
+         stats.flagCarryTime += timeDelta;
+
+         if(carrier != mFlagCarriers[index].carrier)
+            stats.flagPickups++;
+      }
+
+      mFlagCarriers[index].carrier = carrier;
+   }
+}
+
+
+void ReplayStatsPlayback::run()
+{
+   while(!isAtEnd())
+   {
+      processMoreData(SampleInterval);
+      sample(SampleInterval);
+   }
+}
+
+
+bool ReplayStatsPlayback::writeJson(const string &filename, const string &recordingName)
+{
+   FILE *f = fopen(filename.c_str(), "w");
+   if(!f)
+      return false;
+
+   GameType *gameType = mClientGame->getGameType();
+
+   fprintf(f, "{\n\t\"recording\": \"%s\",\n\t\"level\": \"%s\",\n\t\"gameType\": \"%s\",\n\t\"duration\": %d,\n",
+              sanitizeForJson(recordingName.c_str()).c_str(),
+              gameType ? sanitizeForJson(gameType->getLevelName().c_str()).c_str() : "",
+              gameType ? gameType->getGameTypeName() : "", mTotalTime);
+
+   fprintf(f, "\t\"teams\": [");
+   for(S32 i = 0; i < mClientGame->getTeamCount(); i++)
+      fprintf(f, "%s\n\t\t{ \"name\": \"%s\", \"score\": %d }", i == 0 ? "" : ",",
+                 sanitizeForJson(mClientGame->getTeamName(i).getString()).c_str(), mClientGame->getTeam(i)->getScore());
+
+   fprintf(f, "\n\t],\n\t\"players\": [");
+   for(S32 i = 0; i < mPlayers.size(); i++)
+   {
+      const PlayerStats &stats = mPlayers[i];
+      fprintf(f, "%s\n\t\t{ \"name\": \"%s\", \"team\": %d, \"score\": %d, \"kills\": %d, \"deaths\": %d, \"suicides\": %d, "
+                 "\"flagPickups\": %d, \"flagCarryTime\": %d }", i == 0 ? "" : ",",
+                 sanitizeForJson(stats.name.getString()).c_str(), stats.team, stats.score, stats.kills, stats.deaths,
+                 stats.suicides, stats.flagPickups, stats.flagCarryTime);
+   }
+
+   // Heatmap cells are [x, y, samples], with x and y in units of cellSize
+   fprintf(f, "\n\t],\n\t\"heatmap\": {\n\t\t\"cellSize\": %d,\n\t\t\"sampleInterval\": %d,\n\t\t\"cells\": [",
+              HeatmapCellSize, SampleInterval);
+
+   bool first = true;
+   for(std::map<std::pair<S32, S32>, U32>::const_iterator it = mHeatmap.begin(); it != mHeatmap.end(); it++)
+   {
+      fprintf(f, "%s[%d, %d, %d]", first ? "" : ", ", it->first.first, it->first.second, it->second);
+      first = false;
+   }
+
+   fprintf(f, "]\n\t}\n}\n");
+
+   fclose(f);
+   return true;
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Processes every step-th recording starting with first, and returns the number we wrote stats for
+static S32 processRecordings(const Vector<string> &recordings, S32 first, S32 step, const string &outputDir)
+{
+   GameSettingsPtr settings = GameSettingsPtr(new GameSettings());
+   FontManager::initialize(settings.get(), false);    // ClientGame needs fonts, but only the built-in ones
+
+   Address addr;
+   S32 processed = 0;
+
+   for(S32 i = first; i < recordings.size(); i += step)
+   {
+      ClientGame *game = new ClientGame(addr, settings, new UIManager());    // Deletes the UIManager and playback
+      ReplayStatsPlayback *playback = new ReplayStatsPlayback(game, recordings[i].c_str());
+
+      if(!playback->isValid())
+      {
+         printf("Skipping %s: not a recording, or recorded by an incompatible version\n", recordings[i].c_str());
+         delete playback;
+         delete game;
+         continue;
+      }
+
+      game->setConnectionToServer(playback);
+      playback->run();
+
+      string name = extractFilename(recordings[i]);
+      if(playback->writeJson(joindir(outputDir, name + ".json"), name))
+         processed++;
+      else
+         printf("Could not write stats for %s\n", recordings[i].c_str());
+
+      delete game;
+   }
+
+   return processed;
+}
+
+
+#ifndef TNL_OS_WIN32
+
+// Recordings share global state (the net string table, RPC routing, and so on), so each worker is a forked copy
+// of this process with its own.  Workers report how many they processed through a pipe.  Returns -1 if we
+// couldn't set up the pipe, in which case nothing has been processed.
+static S32 processRecordingsInWorkers(const Vector<string> &recordings, S32 workers, const string &outputDir)
+{
+   int fds[2];
+   if(pipe(fds) != 0)
+      return -1;
+
+   // A forked child only gets the thread that called fork(), so the log can't be left to the writer thread
+   AsyncWriteStream::stopWriterThread();
+   fflush(NULL);        // Or the children will write whatever's buffered again
+
+   Vector<pid_t> pids;
+
+   for(S32 i = 0; i < workers; i++)
+   {
+      pid_t pid = fork();
+
+      if(pid == 0)
+      {
+         close(fds[0]);
+         S32 processed = processRecordings(recordings, i, workers, outputDir);
+         ssize_t written = write(fds[1], &processed, sizeof(processed));
+         (void)written;
+         fflush(NULL);
+         _exit(0);
+      }
+
+      if(pid < 0)
+         break;
+
+      pids.push_back(pid);
+   }
+
+   close(fds[1]);
+
+   S32 processed = 0;
+   S32 count;
+   while(read(fds[0], &count, sizeof(count)) == sizeof(count))
+      processed += count;
+
+   close(fds[0]);
+
+   for(S32 i = 0; i < pids.size(); i++)
+      waitpid(pids[i], NULL, 0);
+
+   // If we couldn't start them all, do what the missing workers would have done here
+   Vector<string> leftovers;
+   for(S32 i = pids.size(); i < workers; i++)
+      for(S32 j = i; j < recordings.size(); j += workers)
+         leftovers.push_back(recordings[j]);
+
+   if(leftovers.size() > 0)
+      processed += processRecordings(leftovers, 0, 1, outputDir);
+
+   return processed;
+}
+
+
+static S32 getCpuCount()
+{
+   long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   return cpus > 0 ? S32(cpus) : 1;
+}
+
+#endif
+
+
+// Each recording is run by a separate worker process where we can fork; on Windows they run one after another
+void writeReplayStats(const Vector<string> &args)
+{
+   const string &outputDir = args[0];
+   if(!makeSureFolderExists(outputDir))
+   {
+      printf("Could not create output folder %s\n", outputDir.c_str());
+      return;
+   }
+
+   const string extList[] = { GameRecorderServer::buildGameRecorderExtension() };
+
+   Vector<string> recordings;
+   for(S32 i = 1; i < args.size(); i++)
+   {
+      Vector<string> files;
+      if(getFilesFromFolder(args[i], files, extList, ARRAYSIZE(extList)))
+      {
+         for(S32 j = 0; j < files.size(); j++)
+            recordings.push_back(joindir(args[i], files[j]));
+      }
+      else
+         recordings.push_back(args[i]);
+   }
+
+   S32 processed = -1;
+
+#ifndef TNL_OS_WIN32
+   S32 workers = getMin(getCpuCount(), recordings.size());
+   if(workers > 1)
+      processed = processRecordingsInWorkers(recordings, workers, outputDir);
+#endif
+
+   if(processed < 0)
+      processed = processRecordings(recordings, 0, 1, outputDir);
+
+   printf("Wrote stats for %d of %d recordings\n", processed, recordings.size());
+}
+
+
+}
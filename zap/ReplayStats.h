@@ -0,0 +1,67 @@
+//------------------------------------------------------------------------------
+// Copyright Chris Eykamp
+// See LICENSE.txt for full copyright information
+//------------------------------------------------------------------------------
+
+#ifndef _REPLAYSTATS_H_
+#define _REPLAYSTATS_H_
+
+#include "GameRecorderPlayback.h"
+#include "flagItem.h"
+
+#include <map>
+
+namespace Zap
+{
+
+// Plays a recorded game through as fast as it will decode, with nothing drawn, keeping track of who did what
+class ReplayStatsPlayback : public GameRecorderPlayback
+{
+   typedef GameRecorderPlayback Parent;
+
+   struct PlayerStats
+   {
+      StringTableEntry name;
+      S32 team;
+      S32 score;
+      S32 kills;
+      S32 deaths;
+      S32 suicides;
+      S32 flagPickups;
+      U32 flagCarryTime;
+   };
+
+   struct FlagCarrier
+   {
+      SafePtr<FlagItem> flag;
+      StringTableEntry carrier;
+   };
+
+   ClientGame *mClientGame;
+   Vector<PlayerStats> mPlayers;
+   Vector<FlagCarrier> mFlagCarriers;
+   std::map<std::pair<S32, S32>, U32> mHeatmap;    // Ship samples by heatmap cell
+
+   PlayerStats &getPlayer(const StringTableEntry &name);
+   void sample(U32 timeDelta);
+
+public:
+   static const U32 SampleInterval = 100;          // Milliseconds of recording between samples
+   static const S32 HeatmapCellSize = 100;
+
+   ReplayStatsPlayback(ClientGame *game, const char *filename);
+
+   void onKillReported(const StringTableEntry &victim, const StringTableEntry &killer, const StringTableEntry &killerDescr);
+
+   void run();
+   bool writeJson(const string &filename, const string &recordingName);
+};
+
+
+// Runs every recording named in args (files or folders) through ReplayStatsPlayback, writing a JSON file of stats
+// for each into the folder in args[0].  Uses a worker process per CPU where it can.
+void writeReplayStats(const Vector<string> &args);
+
+}
+
+#endif
@@ -15,6 +15,15 @@
 namespace Zap
 {
 
+// Constructor
+RobotManager::TeamVisibilitySnapshot::TeamVisibilitySnapshot()
+{
+   valid = false;
+   time = 0;
+   objectRevision = 0;
+}
+
+
 // Contsructor --> Warning: game may not be fully-formed... do not access any members/functions in this constructor
 RobotManager::RobotManager(ServerGame *game, GameSettingsPtr settings)
 {
@@ -36,6 +45,7 @@ RobotManager::~RobotManager()
 void RobotManager::onLevelChanged()
 {
    mManagerActive = true;    
+   mTeamVisibility.clear();
 }
 
 
@@ -390,6 +400,85 @@ void RobotManager::deleteAllBots()
 }
 
 
+// Queries each bot's visible area separately, so teammates at opposite ends of the map don't drag in everything
+// between them.  Later queries reuse the first one's query id, so objects seen by several bots are only added once.
+void RobotManager::buildTeamVisibilitySnapshot(S32 teamIndex, TeamVisibilitySnapshot &snapshot)
+{
+   Level *level = mGame->getLevel();
+
+   snapshot.areas.clear();
+
+   for(S32 i = 0; i < mRobots.size(); i++)
+   {
+      if(mRobots[i]->getTeam() != teamIndex)
+         continue;
+
+      Point pos = mRobots[i]->getActualPos();
+      Rect rect(pos, pos);
+      rect.expand(mGame->computePlayerVisArea(mRobots[i]));
+
+      snapshot.areas.push_back(rect);
+   }
+
+   static Vector<DatabaseObject *> found;
+   found.clear();
+
+   for(S32 i = 0; i < snapshot.areas.size(); i++)
+      level->findObjects((TestFunc)isAnyObjectType, found, snapshot.areas[i], i > 0);
+
+   snapshot.objects.resize(found.size());
+   for(S32 i = 0; i < found.size(); i++)
+      snapshot.objects[i] = static_cast<BfObject *>(found[i]);
+
+   snapshot.time = mGame->getCurrentTime();
+   snapshot.objectRevision = level->getObjectRevision();
+   snapshot.valid = snapshot.areas.size() > 0;
+}
+
+
+// Serves a bot's findVisibleObjects query from its team's snapshot, filtering by type and by the bot's own visible
+// area.  The snapshot is retaken each game tick, and whenever objects have been added or removed since it was taken.
+// Objects that move into view mid-tick show up on the next tick.  Returns false if the snapshot can't answer (bot is
+// on a special team, or its view isn't inside any of the snapshot's areas); the caller should then query the level
+// directly.
+bool RobotManager::findTeamVisibleObjects(const Robot *robot, const ObjectTypeMask &types, const Rect &queryRect,
+                                          Vector<DatabaseObject *> &fillVector)
+{
+   S32 teamIndex = robot->getTeam();
+
+   if(teamIndex < 0)
+      return false;
+
+   if(teamIndex >= mTeamVisibility.size())
+      mTeamVisibility.resize(teamIndex + 1);
+
+   TeamVisibilitySnapshot &snapshot = mTeamVisibility[teamIndex];
+
+   if(!snapshot.valid || snapshot.time != mGame->getCurrentTime() ||
+         snapshot.objectRevision != mGame->getLevel()->getObjectRevision())
+      buildTeamVisibilitySnapshot(teamIndex, snapshot);
+
+   bool covered = false;
+
+   for(S32 i = 0; i < snapshot.areas.size() && !covered; i++)
+      covered = snapshot.areas[i].contains(queryRect.min) && snapshot.areas[i].contains(queryRect.max);
+
+   if(!covered)
+      return false;
+
+   for(S32 i = 0; i < snapshot.objects.size(); i++)
+   {
+      BfObject *obj = snapshot.objects[i];
+
+      // Deleted objects have their type changed to DeletedTypeNumber, so the type test skips them too
+      if(obj && types.test(obj->getObjectTypeNumber()) && obj->getExtent().intersects(queryRect))
+         fillVector.push_back(obj);
+   }
+
+   return true;
+}
+
+
 void RobotManager::clearMoves()
 {
    for(S32 i = 0; i < mRobots.size(); i++)
@@ -397,4 +486,12 @@ void RobotManager::clearMoves()
 }
 
 
+void RobotManager::clearMoves(S32 tickGroup)
+{
+   for(S32 i = 0; i < mRobots.size(); i++)
+      if(mRobots[i]->getTickGroup() == tickGroup)
+         mRobots[i]->clearMove();
+}
+
+
 } 
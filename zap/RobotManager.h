@@ -10,7 +10,12 @@
 #include "ClientInfo.h"       // For ClientClass enum
 #include "TeamConstants.h"    // For NO_TEAM def
 
+#include "Rect.h"
+
 #include "tnlTypes.h"
+#include "tnlNetBase.h"       // For SafePtr
+
+#include <bitset>
 
 using namespace std;
 using namespace TNL;
@@ -20,11 +25,31 @@ namespace Zap
   
 class ServerGame;
 class Robot;
+class BfObject;
+class DatabaseObject;
+
+typedef bitset<256> ObjectTypeMask;    // One bit per object type number
 
 class RobotManager
 {
 private:
+   // Everything visible to the bots on a team, gathered once per game tick and shared by that team's
+   // findVisibleObjects calls.  SafePtrs, because objects can be deleted mid-tick.
+   struct TeamVisibilitySnapshot
+   {
+      TeamVisibilitySnapshot();
+
+      bool valid;
+      U32 time;                                 // Game time when the snapshot was taken
+      U32 objectRevision;                       // Level's object revision at that point
+      Vector<Rect> areas;                       // Each team bot's visible area
+      Vector<SafePtr<BfObject> > objects;       // Everything in those areas, each object once
+   };
+
    Vector<Robot *> mRobots;      // Grand master list of all robots in the current game
+   Vector<TeamVisibilitySnapshot> mTeamVisibility;
+
+   void buildTeamVisibilitySnapshot(S32 teamIndex, TeamVisibilitySnapshot &snapshot);
 
    bool mManagerActive;          // True when the manager is active
    bool mAutoLevelTeams;         // When true, bots will be added/removed to make sure all teams are even
@@ -70,7 +95,11 @@ public:
 
    void deleteAllBots();
 
+   bool findTeamVisibleObjects(const Robot *robot, const ObjectTypeMask &types, const Rect &queryRect,
+                               Vector<DatabaseObject *> &fillVector);
+
    void clearMoves();
+   void clearMoves(S32 tickGroup);     // Only clear moves for bots in specified tick group
 };
 
 }
@@ -19,6 +19,7 @@
 #include "LevelSource.h"
 #include "LevelDatabase.h"
 #include "Level.h"
+#include "LevelPreloader.h"
 #include "WallItem.h"
 
 #include "gameObjectRender.h"
@@ -116,12 +117,16 @@ ServerGame::ServerGame(const Address &address, GameSettingsPtr settings, LevelSo
    mStutterSleepTimer.reset(stutter);
    mAccumulatedSleepTime = 0;
 
-   botControlTickTimer.reset(BotControlTickInterval);
+   mBotTickAccumulator = 0;
+   mNextBotTickGroup = 0;
+   for(S32 i = 0; i < EventManager::TickGroups; i++)
+      mBotTickGroupElapsed[i] = 0;
 
    mLevelSwitchTimer.setPeriod(LevelSwitchTime);
    GameManager::setHostingModePhase(GameManager::NotHosting);
 
    mGameRecorderServer = NULL;
+   mLevelPreloader = new LevelPreloader();
 }
 
 
@@ -141,6 +146,8 @@ ServerGame::~ServerGame()
 
    if(mGameRecorderServer)
       delete mGameRecorderServer;
+
+   delete mLevelPreloader;
 }
 
 
@@ -596,9 +603,28 @@ void ServerGame::cycleLevel(S32 nextLevel)
 #endif
 
    TNLAssert(getGameType(), "Expect to have a GameType here!");
-   getGameType()->mBotZoneCreationFailed = !BotNavMeshZone::buildBotMeshZones(mLevel->getBotZoneDatabase(), mLevel->getBotZoneList(),
-                                                                              getWorldExtents(), barrierList, turretList,
-                                                                              forceFieldProjectorList, teleporterData, triangulate);
+
+   // Levelgens can add walls and such, so we can only reuse zones for levels that don't have any
+   bool zonesCacheable = getGameType()->getScriptName() == "" && getSettings()->getSetting<string>(IniKey::GlobalLevelScript) == "";
+
+   if(zonesCacheable && mLevelCache.hasZones)
+   {
+      mLevelCache.createZones(mLevel->getBotZoneDatabase(), mLevel->getBotZoneList(), triangulate);
+      getGameType()->mBotZoneCreationFailed = false;
+   }
+   else
+   {
+      getGameType()->mBotZoneCreationFailed = !BotNavMeshZone::buildBotMeshZones(mLevel->getBotZoneDatabase(), mLevel->getBotZoneList(),
+                                                                                 getWorldExtents(), barrierList, turretList,
+                                                                                 forceFieldProjectorList, teleporterData, triangulate);
+
+      if(zonesCacheable && !getGameType()->mBotZoneCreationFailed)
+         mLevelCache.storeZones(mLevel->getBotZoneList());
+   }
+
+   mLevelCache.write(mLevel->getHash());     // Does nothing if we didn't add anything new
+   mBotPathPlanner.prepare(&mLevel->getBotZoneList());     // Cached paths refer to the old level's zones
+
    // Clear team info for all clients
    resetAllClientTeams();
 
@@ -621,7 +647,7 @@ void ServerGame::cycleLevel(S32 nextLevel)
       if(connection)
       {
          connection->setObjectMovedThisGame(false);
-         connection->activateGhosting();                 // Tell clients we're done sending objects and are ready to start playing
+         mGhostingScheduler.queue(connection);           // Tell clients we're done sending objects and are ready to start playing
       }
    }
 
@@ -692,7 +718,16 @@ bool ServerGame::loadNextLevel(S32 nextLevel)
 // Returns true if the level is successfully loaded, false if it wasn't
 bool ServerGame::loadLevel()
 {
-   mLevel = boost::shared_ptr<Level>(mLevelSource->getLevel(mCurrentLevelIndex));
+   mLevelCache.clear();
+
+   // Use the level we loaded during the scoreboard, if it's the right one; its cache entry comes along with it
+   Level *level = mLevelPreloader->takeLevel(mLevelSource->findLevelFile(mCurrentLevelIndex), mLevelCache);
+   bool preloaded = level != NULL;
+
+   if(!level)
+      level = mLevelSource->getLevel(mCurrentLevelIndex);
+
+   mLevel = boost::shared_ptr<Level>(level);
 
    TNLAssert(!mLevel->getAddedToGame(), "Can't reuse Levels!");
 
@@ -715,8 +750,16 @@ bool ServerGame::loadLevel()
       addWallItem(static_cast<WallItem *>(walls[i]), NULL);        // Just does this --> Barrier::constructBarriers(this, *wallItem->getOutline(), false, wallItem->getWidth());
 
 
-   Vector<Point> points;
-   mLevel->buildWallEdgeGeometry(points);
+   if(!preloaded)
+      mLevelCache.read(mLevel->getHash());
+
+   // Level::finishLoading() already took the edges from the cache if they were there; if not, save the ones it built
+   if(!mLevelCache.hasWallEdges)
+   {
+      Vector<Point> points;
+      mLevel->getWallEdgeGeometry(points);
+      mLevelCache.setWallEdges(points);
+   }
 
 
    const Vector<DatabaseObject *> objects = *mLevel->findObjects_fast();
@@ -1270,6 +1313,19 @@ void ServerGame::removeClient(ClientInfo *clientInfo)
 }
 
 
+// Starts ghosting the level to connection, now if there's bandwidth to spare, otherwise once some other clients are done
+void ServerGame::queueGhosting(GameConnection *connection)
+{
+   mGhostingScheduler.queue(connection);
+}
+
+
+GhostingScheduler *ServerGame::getGhostingScheduler()
+{
+   return &mGhostingScheduler;
+}
+
+
 // Loop through all our bots and start their interpreters, delete those that sqawk
 // Only called from GameType::onLevelLoaded()
 void ServerGame::startAllBots()
@@ -1314,6 +1370,13 @@ Robot *ServerGame::findBot(const char *id)
 }
 
 
+bool ServerGame::findTeamVisibleObjects(const Robot *robot, const ObjectTypeMask &types, const Rect &queryRect,
+                                        Vector<DatabaseObject *> &fillVector)
+{
+   return mRobotManager.findTeamVisibleObjects(robot, types, queryRect, fillVector);
+}
+
+
 void ServerGame::removeBot(Robot *robot)
 {
    mRobotManager.removeBot(robot);
@@ -1453,13 +1516,15 @@ void ServerGame::idle(U32 timeDelta)
 
    mSettings->getBanList()->updateKickList(timeDelta);   // Unban players who's bans have expired
 
+   mGhostingScheduler.idle(getGameType(), timeDelta);    // Start ghosting to anyone waiting, if there's room
+
    // Periodically update our status on the master, so they know what we're doing...
    if(mMasterUpdateTimer.update(timeDelta))
       updateStatusOnMaster();
 
    // If we have a data transfer going on, process it
    if(!dataSender.isDone())
-      dataSender.sendNextLine();
+      dataSender.sendNextChunks();
 
    // Play any sounds server might have made... (this is only for special alerts such as player joined or left)
    // (No music or voice on server!)
@@ -1514,21 +1579,37 @@ void ServerGame::idle(U32 timeDelta)
    // Compute it here to save recomputing it for every robot and other method that relies on it.
    computeWorldObjectExtents();
 
-   U32 botControlTickElapsed = botControlTickTimer.getElapsed();
+   // Bots and levelgens take turns by tick group, so each still gets onTick every BotControlTickInterval,
+   // but a large crowd of bots no longer runs its scripts all in the same frame
+   for(S32 i = 0; i < EventManager::TickGroups; i++)
+      mBotTickGroupElapsed[i] += timeDelta;
+
+   mBotTickAccumulator += timeDelta;
 
-   if(botControlTickTimer.update(timeDelta))
+   // On a slow frame, catch up by firing several groups, but never the same group twice
+   for(S32 i = 0; i < EventManager::TickGroups && mBotTickAccumulator >= BotTickGroupInterval; i++)
    {
-      // Clear all old bot moves, so that if the bot does nothing, it doesn't just continue with what it was doing before
-      mRobotManager.clearMoves();
+      S32 group = mNextBotTickGroup;
+      mNextBotTickGroup = (mNextBotTickGroup + 1) % EventManager::TickGroups;
+
+      // Clear old bot moves, so that if the bot does nothing, it doesn't just continue with what it was doing before
+      mRobotManager.clearMoves(group);
 
       // Fire TickEvent, in case anyone is listening
-      EventManager::get()->fireEvent(EventManager::TickEvent, botControlTickElapsed + timeDelta);
+      EventManager::get()->fireTickEvent(mBotTickGroupElapsed[group], group);
 
-      botControlTickTimer.reset();
+      mBotTickGroupElapsed[group] = 0;
+      mBotTickAccumulator -= BotTickGroupInterval;
    }
+
+   if(mBotTickAccumulator > BotControlTickInterval)      // Don't let a long stall build up a backlog
+      mBotTickAccumulator = 0;
    
    const Vector<DatabaseObject *> *gameObjects = mLevel->findObjects_fast();
 
+   // Kills, zone crossings and messages generated while objects idle are handed to batch handlers together, below
+   EventManager::get()->beginEventBatch();
+
    // Visit each game object, handling moves and running its idle method
    for(S32 i = gameObjects->size() - 1; i >= 0; i--)
    {
@@ -1549,8 +1630,15 @@ void ServerGame::idle(U32 timeDelta)
    TNLAssert(getGameType(), "Expect a GameType here!");
    getGameType()->idle(BfObject::ServerIdleMainLoop, timeDelta);
 
+   EventManager::get()->endEventBatch();     // Before processDeleteList(), so objects in the events are still around
+
    processDeleteList(timeDelta);
 
+   mBotPathPlanner.buildNextHopTable();      // A few rows per tick, until it's done
+
+   if(mLevelSwitchTimer.getCurrent() > 0)
+      mLevelPreloader->idle(LevelPreloadTimeSlice);
+
    // Load a new level if the time is out on the current one
    if(mLevelSwitchTimer.update(timeDelta))
    {
@@ -1893,6 +1981,24 @@ bool ServerGame::startHosting()
 void ServerGame::gameEnded()
 {
    mLevelSwitchTimer.reset();
+   preloadNextLevel();
+}
+
+
+// Start reading the next level while the scoreboard is showing; loadLevel() will pick it up when the time comes
+void ServerGame::preloadNextLevel()
+{
+   // Levels on a hosted server arrive from the hoster, not from disk
+   if(mHostOnServer || mLevelSource->getLevelCount() == 0)
+      return;
+
+   // Settle on the next level now, so a random pick doesn't change between here and cycleLevel()
+   mNextLevel = getAbsoluteLevelIndex(mNextLevel);
+
+   string filename = mLevelSource->findLevelFile(mNextLevel);
+
+   if(filename != "")
+      mLevelPreloader->start(filename, getSecondaryThread());
 }
 
 
@@ -2006,6 +2112,12 @@ GridDatabase &ServerGame::getBotZoneDatabase() const
 }
 
 
+AStar &ServerGame::getBotPathPlanner()
+{
+   return mBotPathPlanner;
+}
+
+
 // Returns ID of zone containing specified point
 U16 ServerGame::findZoneContaining(const Point &p) const
 {
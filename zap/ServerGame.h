@@ -10,6 +10,9 @@
 
 #include "BotNavMeshZone.h"
 #include "dataConnection.h"
+#include "EventManager.h"        // For TickGroups
+#include "GhostingScheduler.h"
+#include "LevelCache.h"
 #include "LevelSource.h"         // For LevelSourcePtr def
 #include "LevelSpecifierEnum.h"
 #include "RobotManager.h"
@@ -31,6 +34,7 @@ class ItemSpawn;
 struct LevelInfo;
 
 class GameRecorderServer;
+class LevelPreloader;
 
 static const string UploadPrefix = "upload_";
 static const string DownloadPrefix = "download_";
@@ -45,6 +49,8 @@ private:
       UpdateServerWhenHostGoesEmpty = FOUR_SECONDS, // How many seconds when host on server when server goes empty or not empty
       CheckServerStatusTime = FIVE_SECONDS,       // If it did not send updates, recheck after ms
       BotControlTickInterval = 33,                // Interval for how often should we let bots fire the onTick event (ms)
+      BotTickGroupInterval = BotControlTickInterval / EventManager::TickGroups,  // Time between successive tick groups (ms)
+      LevelPreloadTimeSlice = 5,                  // How long we'll spend parsing the next level each tick, during the scoreboard (ms)
    };
 
    bool mTestMode;                        // True if being tested from editor
@@ -70,6 +76,8 @@ private:
    Timer mTimeToSuspend;
 
    GameRecorderServer *mGameRecorderServer;
+   LevelPreloader *mLevelPreloader;       // Loads the next level while the end-of-game scoreboard is up
+   LevelCache mLevelCache;                // Wall edges and bot zones for the current level, saved from an earlier visit
 
    string mOriginalName;
    string mOriginalDescr;
@@ -93,6 +101,8 @@ private:
    U32 mAccumulatedSleepTime;
 
    RobotManager mRobotManager;
+   GhostingScheduler mGhostingScheduler;  // Decides when each client's ghosting starts
+   AStar mBotPathPlanner;                 // Shared by all bots; path cache is cleared when the bot zones are rebuilt
 
    Vector<LuaLevelGenerator *> mLevelGens;
    Vector<LuaLevelGenerator *> mLevelGenDeleteList;
@@ -113,6 +123,7 @@ private:
    void cleanUp();
    bool loadNextLevel(S32 nextLevel);                 // Find the next valid level, and load it with loadLevel()
    bool loadLevel();                                  // Load the level pointed to by mCurrentLevelIndex
+   void preloadNextLevel();                           // Start loading the level we'll play after this one
    void runLevelGenScript(const string &scriptName);  // Run any levelgens specified by the level or in the INI
 
    AbstractTeam *getNewTeam();
@@ -120,7 +131,9 @@ private:
    RefPtr<NetEvent> mSendLevelInfoDelayNetInfo;
    Timer mSendLevelInfoDelayCount;
 
-   Timer botControlTickTimer;
+   U32 mBotTickAccumulator;                           // Time since the last tick group fired
+   U32 mBotTickGroupElapsed[EventManager::TickGroups];  // Time since each tick group last fired
+   S32 mNextBotTickGroup;
 
    LuaGameInfo *mGameInfo;
 
@@ -168,6 +181,8 @@ public:
 
    void addClient(ClientInfo *clientInfo);
    void removeClient(ClientInfo *clientInfo);
+   void queueGhosting(GameConnection *connection);
+   GhostingScheduler *getGhostingScheduler();
 
    void setShuttingDown(bool shuttingDown, U16 time, GameConnection *who, StringPtr reason);  
 
@@ -201,6 +216,8 @@ public:
    void deleteBot(S32 i);
    void deleteAllBots();
    Robot *findBot(const char *id);
+   bool findTeamVisibleObjects(const Robot *robot, const ObjectTypeMask &types, const Rect &queryRect,
+                               Vector<DatabaseObject *> &fillVector);
    void moreBots();
    void fewerBots();
    void kickSingleBotFromLargestTeamWithBots();
@@ -266,6 +283,7 @@ public:
    // BotNavMeshZone management
    const Vector<BotNavMeshZone *> &getBotZoneList() const;
    GridDatabase &getBotZoneDatabase() const;
+   AStar &getBotPathPlanner();
 
    U16 findZoneContaining(const Point &p) const;
 
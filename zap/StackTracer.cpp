@@ -16,6 +16,8 @@
 #  include <cxxabi.h>
 #endif
 
+#include "tnlLog.h"
+
 #include <stdio.h>
 #include <signal.h>
 
@@ -150,6 +152,9 @@ static void abortHandler(S32 signum)
       fprintf(stderr, "Caught signal %d\n", signum);
  
    printStackTrace();
+
+   // Our log files are written from another thread; make sure the last lines before the crash get there
+   TNL::LogConsumer::flushAll();
  
    // If you caught one of the above signals, it is likely you just 
    // want to quit your program right now.
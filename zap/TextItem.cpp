@@ -399,8 +399,9 @@ F32 TextItem::getUpdatePriority(GhostConnection *connection, U32 updateMask, S32
    F32 basePriority = Parent::getUpdatePriority(connection, updateMask, updateSkips);
 
    // Lower priority for initial update.  This is to work around network-heavy loading of levels
-   // with many TextItems, which will stall the client and prevent you from moving your ship
-   if(isInitialUpdate())
+   // with many TextItems, which will stall the client and prevent you from moving your ship.  The full update
+   // mask marks the initial update here; isInitialUpdate() is only set while packUpdate() runs.
+   if(updateMask == 0xFFFFFFFF)
       return basePriority - 1000.f;
 
    // Normal priority otherwise so Geom changes are immediately visible to all clients
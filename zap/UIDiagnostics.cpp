@@ -19,6 +19,7 @@
 
 #include "GameManager.h"
 #include "ServerGame.h"          
+#include "LuaScriptRunner.h"
 
 #include "Colors.h"
 #include "gameObjectRender.h"    // For drawCircle in badge rendering below
@@ -627,6 +628,14 @@ void DiagnosticUserInterface::render() const
       }
 
       ypos += textsize + gap;
+
+      const LuaScriptRunner::AllocationStats &luaStats = LuaScriptRunner::getAllocationStats();
+
+      drawCenteredStringPair2Colf(ypos, textsize, true, "Lua Memory:", "%lldKB (peak %lldKB)", 
+                                  (long long)(luaStats.bytesInUse / 1024), (long long)(luaStats.peakBytes / 1024));
+      drawCenteredStringPair2Colf(ypos, textsize, false, "Lua GC Pause/Step:", "%d%%/%d%%", 
+                                  LuaScriptRunner::getGcPause(), LuaScriptRunner::getGcStepMul());
+      ypos += textsize + gap;
       
 
       // Dump out names of loaded levels...
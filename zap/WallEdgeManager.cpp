@@ -85,6 +85,14 @@ void WallEdgeManager::rebuildEdgesWithClipper(const Vector<WallSegment const *>
    // Run clipper --> fills wallEdgePoints from wallSegments
    clipAllWallEdges(wallSegments, wallEdgePoints);
 
+   setEdges(wallEdgePoints);
+}
+
+
+// Replace our edges with ones made from wallEdgePoints, which come in pairs, one per edge.  Lets us reuse edges
+// clipped earlier, without running clipper again.
+void WallEdgeManager::setEdges(const Vector<Point> &wallEdgePoints)
+{
    // Create a WallEdge object from the clipped wall geometry.  We'll add it to the WallEdgeDatabase, which will 
    // delete the object when it is ulitmately removed.
    mWallEdgeDatabase.removeEverythingFromDatabase();    // Remove the old edges
@@ -97,6 +105,23 @@ void WallEdgeManager::rebuildEdgesWithClipper(const Vector<WallSegment const *>
 }
 
 
+// The reverse of setEdges()
+void WallEdgeManager::getEdges(Vector<Point> &wallEdgePoints) const
+{
+   const Vector<DatabaseObject *> *edges = mWallEdgeDatabase.findObjects_fast();
+
+   wallEdgePoints.clear();
+   wallEdgePoints.reserve(edges->size() * 2);
+
+   for(S32 i = 0; i < edges->size(); i++)
+   {
+      WallEdge *edge = static_cast<WallEdge *>(edges->get(i));
+      wallEdgePoints.push_back(*edge->getStart());
+      wallEdgePoints.push_back(*edge->getEnd());
+   }
+}
+
+
 //// Find the associated segment(s) and mark them as selected (or not)
 //void WallEdgeManager::onWallGeomChanged(GridDatabase *gameObjectDatabase, BfObject *wall, bool selected, S32 serialNumber)
 //{
@@ -60,6 +60,8 @@ public:
 
    //void rebuildEdges(GridDatabase *database);
    void rebuildEdges(const Vector<WallSegment const *> &wallSegments, Vector<Point> &wallEdgePoints);
+   void setEdges(const Vector<Point> &wallEdgePoints);
+   void getEdges(Vector<Point> &wallEdgePoints) const;
    static void buildWallSegmentEdgesAndPoints(DatabaseObject *object);
 
 
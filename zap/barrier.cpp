@@ -9,8 +9,10 @@
 #include "gameObjectRender.h"
 #include "GeomUtils.h"
 #include "Level.h"
+#include "PolyWall.h"
 #include "WallItem.h"      // For WallSegment def
 
+#include "tnlBitStream.h"
 #include "tnlLog.h"
 
 #include <cmath>
@@ -230,6 +232,130 @@ void Barrier::constructPolyWalls(Game *game, const Vector<Point> &verts)
 }
 
 
+static void writeWallPoints(BitStream &stream, const Vector<Point> &points)
+{
+   stream.write(U32(points.size()));
+
+   for(S32 i = 0; i < points.size(); i++)
+      points[i].write(&stream);
+}
+
+
+static bool readWallPoints(BitStream &stream, U32 streamSize, Vector<Point> &points)
+{
+   U32 count;
+   stream.read(&count);
+
+   // Don't let a bad count have us allocating more points than the stream could possibly hold
+   if(!stream.isValid() || U64(count) * sizeof(F32) * 2 > streamSize - stream.getBytePosition())
+      return false;
+
+   points.resize(count);
+   for(U32 i = 0; i < count; i++)
+      points[i].read(&stream);
+
+   return stream.isValid();
+}
+
+
+// Server only -- packs the same walls GameType used to send one by one with s2cAddWalls and s2cAddPolyWalls
+// static method
+void Barrier::packWallGeometry(const Level *level, Vector<U8> &geometry)
+{
+   BitStream stream;
+
+   const Vector<DatabaseObject *> *walls = level->findObjects_fast(WallItemTypeNumber);
+   const Vector<DatabaseObject *> *polyWalls = level->findObjects_fast(PolyWallTypeNumber);
+
+   // 0-point walls would have cleared the client's walls in the old scheme, so they've never been sent
+   U32 wallCount = 0;
+   for(S32 i = 0; i < walls->size(); i++)
+      if(walls->get(i)->getVertCount() != 0)
+         wallCount++;
+
+   stream.write(wallCount);
+
+   for(S32 i = 0; i < walls->size(); i++)
+      if(walls->get(i)->getVertCount() != 0)
+      {
+         writeWallPoints(stream, *walls->get(i)->getOutline());
+         stream.write((F32)static_cast<WallItem *>(walls->get(i))->getWidth());
+      }
+
+   U32 polyWallCount = 0;
+   for(S32 i = 0; i < polyWalls->size(); i++)
+      if(polyWalls->get(i)->getVertCount() != 0)
+         polyWallCount++;
+
+   stream.write(polyWallCount);
+
+   for(S32 i = 0; i < polyWalls->size(); i++)
+      if(polyWalls->get(i)->getVertCount() != 0)
+         writeWallPoints(stream, *static_cast<PolyWall *>(polyWalls->get(i))->getOutline());
+
+   geometry.resize(stream.getBytePosition());
+   memcpy(geometry.address(), stream.getBuffer(), geometry.size());
+}
+
+
+// Client only -- replaces all walls in the game with the ones in geometry.  If geometry is damaged, leaves the
+// existing walls alone and returns false.
+// static method
+bool Barrier::unpackWallGeometry(Game *game, const Vector<U8> &geometry)
+{
+   BitStream stream((U8 *)geometry.address(), geometry.size());
+
+   U32 wallCount, polyWallCount;
+
+   stream.read(&wallCount);
+   if(!stream.isValid() || wallCount > (U32)geometry.size())
+      return false;
+
+   Vector<Vector<Point> > wallVerts(wallCount);
+   Vector<F32> wallWidths(wallCount);
+   wallVerts.resize(wallCount);
+   wallWidths.resize(wallCount);
+
+   for(U32 i = 0; i < wallCount; i++)
+   {
+      if(!readWallPoints(stream, geometry.size(), wallVerts[i]))
+         return false;
+
+      stream.read(&wallWidths[i]);
+   }
+
+   stream.read(&polyWallCount);
+   if(!stream.isValid() || polyWallCount > (U32)geometry.size())
+      return false;
+
+   Vector<Vector<Point> > polyWallVerts(polyWallCount);
+   polyWallVerts.resize(polyWallCount);
+
+   for(U32 i = 0; i < polyWallCount; i++)
+      if(!readWallPoints(stream, geometry.size(), polyWallVerts[i]))
+         return false;
+
+   if(!stream.isValid())
+      return false;
+
+   game->deleteObjects((TestFunc)isWallType);
+
+   for(U32 i = 0; i < wallCount; i++)
+      constructBarriers(game, wallVerts[i], wallWidths[i]);
+
+   for(U32 i = 0; i < polyWallCount; i++)
+   {
+      if(polyWallVerts[i].size() < 3)
+         continue;
+
+      PolyWall *polywall = new PolyWall(polyWallVerts[i]);
+      polywall->addToGame(game, game->getLevel());
+   }
+
+   return true;
+}
+
+
 // Server only -- fills points
 void Barrier::getBufferForBotZone(F32 bufferRadius, Vector<Point> &points) const
 {
@@ -83,6 +83,10 @@ public:
    static void constructBarriers (Game *game, const Vector<Point> &verts, F32 width);
    static void constructPolyWalls(Game *game, const Vector<Point> &verts);
 
+   // Lets the server send all of a level's walls in one lump, rather than an RPC apiece
+   static void packWallGeometry(const Level *level, Vector<U8> &geometry);
+   static bool unpackWallGeometry(Game *game, const Vector<U8> &geometry);
+
    void renderLayer(S32 layerIndex);                                          // Renders barrier fill barrier-by-barrier
    static void renderEdges(const GameSettings *settings, S32 layerIndex);     // Renders all edges in one pass
 
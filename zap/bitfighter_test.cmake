@@ -5,9 +5,13 @@ option(BITFIGHTER_COVERAGE "Add coverage information to the test executable and
 
 set(TEST_SOURCES
 	${CMAKE_SOURCE_DIR}/bitfighter_test/LevelFilesForTesting.cpp
+	${CMAKE_SOURCE_DIR}/bitfighter_test/TestAsyncWriter.cpp
 	${CMAKE_SOURCE_DIR}/bitfighter_test/TestColor.cpp
+	${CMAKE_SOURCE_DIR}/bitfighter_test/TestCompression.cpp
+	${CMAKE_SOURCE_DIR}/bitfighter_test/TestDataConnection.cpp
 	${CMAKE_SOURCE_DIR}/bitfighter_test/TestEditor.cpp
 	${CMAKE_SOURCE_DIR}/bitfighter_test/TestGame.cpp
+	${CMAKE_SOURCE_DIR}/bitfighter_test/TestGameRecorder.cpp
 	${CMAKE_SOURCE_DIR}/bitfighter_test/TestGameType.cpp
 	${CMAKE_SOURCE_DIR}/bitfighter_test/TestGameUserInterface.cpp
 	${CMAKE_SOURCE_DIR}/bitfighter_test/TestGeomUtils.cpp
@@ -31,6 +31,9 @@ ControlObjectConnection::ControlObjectConnection()
    mObjectMovedThisGame = false;
    mIsBusy = false;
    mNeedReplayMoves = false;
+
+   mViewpoint.valid = false;
+   mViewpoint.isShip = false;
 }
 
 
@@ -72,6 +75,28 @@ BfObject *ControlObjectConnection::getControlObject() const
 }
 
 
+const ControlObjectConnection::Viewpoint &ControlObjectConnection::getViewpoint() const
+{
+   return mViewpoint;
+}
+
+
+// Called on the server before each packet's ghost updates are prioritized and written
+void ControlObjectConnection::updateViewpoint()
+{
+   mViewpoint.valid = controlObject.isValid();
+   if(!mViewpoint.valid)
+      return;
+
+   mViewpoint.center = controlObject->getExtent().getCenter();
+   mViewpoint.vel = controlObject->getVel();
+   mViewpoint.isShip = isShipType(controlObject->getObjectTypeNumber());
+
+   if(mViewpoint.isShip)
+      mViewpoint.visArea = controlObject->getGame()->computePlayerVisArea(static_cast<Ship *>(controlObject.getPointer()));
+}
+
+
 U32 ControlObjectConnection::getControlCRC()
 {
    PacketStream stream;
@@ -178,6 +203,8 @@ void ControlObjectConnection::writePacket(BitStream *bstream, PacketNotify *noti
          mServerPosition = controlObject->getPos();
       }
 
+      updateViewpoint();
+
       // We only compress points relative if we know that the
       // remote side has a copy of the control object already
       mCompressPointsRelative = bstream->writeFlag(ghostIndex != -1);
@@ -346,7 +373,9 @@ bool ControlObjectConnection::getObjectMovedThisGame()
 }
 
 
-void ControlObjectConnection::writeCompressedPoint(const Point &p, BitStream *stream)
+// Points out of view range can be sent to the nearest multiple of quantization (rounded down to 2, 4, 8 or 16) when
+// the caller doesn't need them exact; points on screen are always exact
+void ControlObjectConnection::writeCompressedPoint(const Point &p, BitStream *stream, U32 quantization)
 {
    if(!mCompressPointsRelative)
    {
@@ -367,6 +396,23 @@ void ControlObjectConnection::writeCompressedPoint(const Point &p, BitStream *st
    {
       stream->writeRangedU32(dx, 0, maxx);
       stream->writeRangedU32(dy, 0, maxy);
+      return;
+   }
+
+   U32 stepBits = 0;
+   while(stepBits < 4 && (2U << stepBits) <= quantization)
+      stepBits++;
+
+   S32 step = 1 << stepBits;
+   S32 cx = (S32) floor((delta.x + CoarsePointRange) / step + 0.5f);
+   S32 cy = (S32) floor((delta.y + CoarsePointRange) / step + 0.5f);
+   S32 maxc = CoarsePointRange * 2 / step;
+
+   if(stream->writeFlag(stepBits > 0 && cx >= 0 && cx <= maxc && cy >= 0 && cy <= maxc))
+   {
+      stream->writeInt(stepBits - 1, 2);
+      stream->writeRangedU32(cx, 0, maxc);
+      stream->writeRangedU32(cy, 0, maxc);
    }
    else
    {
@@ -394,6 +440,16 @@ void ControlObjectConnection::readCompressedPoint(Point &p, BitStream *stream)
       Point delta(dx, dy);
       p = mServerPosition + delta;
    }
+   else if(stream->readFlag())
+   {
+      S32 step = 1 << (stream->readInt(2) + 1);
+      S32 maxc = CoarsePointRange * 2 / step;
+
+      F32 dx = F32(S32(stream->readRangedU32(0, maxc)) * step - CoarsePointRange);
+      F32 dy = F32(S32(stream->readRangedU32(0, maxc)) * step - CoarsePointRange);
+
+      p = mServerPosition + Point(dx, dy);
+   }
    else
    {
       stream->read(&p.x);
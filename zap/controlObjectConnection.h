@@ -44,6 +44,7 @@ private:
    enum {
       MaxPendingMoves = 63,
       MaxMoveTimeCredit = 512,
+      CoarsePointRange = 16384,     // Quantized points this far from our ship are sent in steps, not as raw floats
    };
 
 
@@ -65,6 +66,23 @@ private:
 
    void onGotNewMove(const Move &move);
 
+public:
+   // Where the client sees the game from, worked out once per packet rather than by every ghost's
+   // getUpdatePriority() and getInterestTier()
+   struct Viewpoint
+   {
+      bool valid;          // False when there's no control object
+      bool isShip;
+      Point center;        // Of the control object's extent
+      Point vel;
+      Point visArea;       // Only set for ships
+   };
+
+private:
+   Viewpoint mViewpoint;
+
+   void updateViewpoint();
+
 protected:
    bool mIsBusy;
    bool mNeedReplayMoves;
@@ -75,6 +93,7 @@ public:
 
    void setControlObject(BfObject *theObject);
    BfObject *getControlObject() const;
+   const Viewpoint &getViewpoint() const;
    U32 getControlCRC();
 
    virtual void addPendingMove(Move *theMove);
@@ -99,7 +118,7 @@ public:
 
    bool isDataToTransmit();
 
-   void writeCompressedPoint(const Point &p, BitStream *stream);
+   void writeCompressedPoint(const Point &p, BitStream *stream, U32 quantization = 1);
    void readCompressedPoint(Point &p, BitStream *stream);
 
    void addTimeSinceLastMove(U32 time);
@@ -7,6 +7,7 @@
 #include "ServerGame.h"
 #include "gameNetInterface.h"             // for GetGame() through GameNetInterface
 
+#include "Compression.h"
 #include "Md5Utils.h"
 #include "stringUtils.h"
 
@@ -101,7 +102,7 @@ void transferResource(GameSettings *settings, const string &addr, const string &
       if(dataConn && dataConn->isEstablished())
       {
          if(!dataConn->mDataSender.isDone())
-            dataConn->mDataSender.sendNextLine();
+            dataConn->mDataSender.sendNextChunks();
 
          started = true;
       }
@@ -146,8 +147,9 @@ DataSendable::~DataSendable()
 DataSender::DataSender()
 {
    mDone = true;
-   mLineCtr = 0;
-   mFileType = INVALID_RESOURCE_TYPE;
+   mStarted = false;
+   mSentPos = 0;
+   mAckedPos = 0;
 }
 
 // Destructor
@@ -162,8 +164,14 @@ bool DataSender::isDone()
    return mDone;
 }
 
-// For readability
-#define MAX_CHUNK_LEN HuffmanStringProcessor::MAX_SENDABLE_LINE_LENGTH
+
+void DataSender::cancel()
+{
+   mDone = true;
+   mData.clear();       // Liberate some memory
+   mChecksum = "";
+}
+
 
 SenderStatus DataSender::initialize(DataSendable *connection, FolderManager *folderManager, string filename, FileType fileType)
 {
@@ -172,90 +180,287 @@ SenderStatus DataSender::initialize(DataSendable *connection, FolderManager *fol
    if(fullname == "")
       return COULD_NOT_FIND_FILE;
 
-   //ifstream file;
-   //file.open(fullname.c_str());
-   FILE *file = fopen(fullname.c_str(), "r");
+   return initialize(connection, fullname, DataConnection::MaxFileSize, U8(fileType));
+}
+
+
+SenderStatus DataSender::initialize(DataSendable *connection, const string &filename, U32 maxSize, U8 type)
+{
+   FILE *file = fopen(filename.c_str(), "rb");
 
-   //if(!file.is_open())
    if(!file)
       return COULD_NOT_OPEN_FILE;
 
-   // Allocate a buffer
-   //char *buffer = new char[MAX_CHUNK_LEN + 1];      // 255 for data, + 1 for terminator
-   char buffer[MAX_CHUNK_LEN + 1];      // 255 for data, + 1 for terminator
-   U32 size;
+   fseek(file, 0, SEEK_END);
+   long size = ftell(file);
+   fseek(file, 0, SEEK_SET);
 
-   // We'll read the file in 255 char chunks; this is the largest string we can send, and we want to be as large as possible to get
-   // maximum benefit of the string compression that occurs during the transmission process.
-   /*
-   while(!file.eof() && mLines.size() * MAX_CHUNK_LEN < MAX_LEVEL_FILE_LENGTH)
+   if(size > (long)maxSize)
    {
-      file.read(buffer, MAX_CHUNK_LEN);
-      if(file.gcount() > 0)
-      {
-         buffer[file.gcount()] = '\0';     // Null terminate
-         mLines.push_back(buffer); 
-      }
+      fclose(file);
+      return FILE_TOO_LONG;
    }
-   file.close();
-   */
 
-   const U32 MAX_LEVEL_FILE_LENGTH = 256 * 1024;     // 256K -- Need some limit to avoid overflowing server; arbitrary value
+   Vector<U8> buffer(size);
+   buffer.resize(size);
 
-   size = fread(buffer, 1, MAX_CHUNK_LEN, file);
+   bool ok = size > 0 && fread(buffer.address(), 1, size, file) == (size_t)size;
+   fclose(file);
 
-   while(size > 0 && mLines.size() * MAX_CHUNK_LEN < MAX_LEVEL_FILE_LENGTH)
-   {
-       buffer[size] = 0;           // Null terminate
-       mLines.push_back(buffer);
-       size = fread(buffer, 1, MAX_CHUNK_LEN, file);
-   }
+   if(!ok)                          // Read nothing
+      return COULD_NOT_OPEN_FILE;
 
-   fclose(file);
+   return initialize(connection, buffer.address(), size, type);
+}
 
-   //delete[] buffer;
 
-   // Not exactly accurate -- if final line is only a few bytes, it will count as 255; but since our limit is arbitrary, it matters not
-   if(mLines.size() * MAX_CHUNK_LEN >= MAX_LEVEL_FILE_LENGTH)
-   {
-      mLines.clear();
-      return FILE_TOO_LONG;
-   }
+// Anything we were already sending is dropped -- the receiver will put aside what it has of it
+SenderStatus DataSender::initialize(DataSendable *connection, const U8 *data, U32 size, U8 type)
+{
+   cancel();
 
-   if(mLines.size() == 0)          // Read nothing
+   if(!compressBuffer(data, size, mData))
       return COULD_NOT_OPEN_FILE;
 
+   Md5::IncrementalHasher hasher;
+   hasher.add((const char *)data, size);
+   mChecksum = hasher.getHash();
+
    mConnection = dynamic_cast<Object *>(connection);
-   mFileType = fileType;
    mDone = false;
-   mLineCtr = 0;
+   mStarted = false;
+   mSentPos = 0;
+   mAckedPos = 0;
+
+   connection->s2rBeginTransfer(type, mChecksum.c_str(), size, mData.size());
+
    return STATUS_OK;
 }
 
-#undef MAX_CHUNK_LEN
 
+// Enough to cover a couple of round trips at the rate the connection is sending, so we never sit waiting on an ack,
+// but never so much that we bury everything else the connection has to say
+U32 DataSender::getWindowSize(NetConnection *connection)
+{
+   F32 seconds = (connection->getRoundTripTime() + 100) * 0.001f;
+   U32 window = U32(connection->getSendBandwidth() * seconds * 2);
+
+   return getMin(getMax(window, MinWindowSize), MaxWindowSize);
+}
 
-// Send next line of our file
-void DataSender::sendNextLine()
+
+// Send as many chunks as our window allows; runs every tick
+void DataSender::sendNextChunks()
 {
    DataSendable *connection = dynamic_cast<DataSendable *>(mConnection.getPointer());
    if(!connection)
-      mDone = true;
+      cancel();
 
-   if(mDone)
+   if(mDone || !mStarted)
       return;
 
-   if(mLineCtr < mLines.size())
+   U32 window = getWindowSize(dynamic_cast<NetConnection *>(mConnection.getPointer()));
+
+   while(mSentPos < U32(mData.size()) && mSentPos - mAckedPos < window)
    {
-      connection->s2rSendLine(mLines[mLineCtr].c_str());
-      mLineCtr++;
+      U32 size = getMin(ChunkSize, mData.size() - mSentPos);
+
+      ByteBuffer *chunk = new ByteBuffer(mData.address() + mSentPos, size);
+      chunk->takeOwnership();
+
+      connection->s2rSendData(mSentPos, ByteBufferPtr(chunk));
+      mSentPos += size;
    }
-   else
+}
+
+
+// The first ack tells us where to start, which will be somewhere other than 0 if the receiver has part of our data
+// left over from an earlier attempt
+bool DataSender::acknowledge(DataSendable *connection, const char *checksum, U32 offset)
+{
+   if(mDone || connection != dynamic_cast<DataSendable *>(mConnection.getPointer()) || mChecksum != checksum)
+      return false;
+
+   offset = getMin(offset, U32(mData.size()));
+
+   if(!mStarted)
    {
-      connection->s2rCommandComplete(STATUS_OK);
-      mDone = true;
-      mLines.clear();      // Liberate some memory
+      mStarted = true;
+      mSentPos = offset;
    }
+
+   mAckedPos = getMax(mAckedPos, offset);
+
+   if(mAckedPos < U32(mData.size()))
+      return false;
+
+   cancel();
+   return true;
+}
+
+
+F32 DataSender::getProgress()
+{
+   if(mDone || mData.size() == 0)
+      return 0;
+
+   return F32(mAckedPos) / mData.size();
+}
+
+
+////////////////////////////////////////
+////////////////////////////////////////
+
+// Statics
+Vector<DataReceiver::PartialTransfer> DataReceiver::mPartialTransfers;
+
+
+// Constructor
+DataReceiver::DataReceiver()
+{
+   mActive = false;
+   mType = 0;
+   mSize = 0;
+   mCompressedSize = 0;
+   mLastAckPos = 0;
+}
+
+
+// Destructor -- keep what we've got so far, in case our connection comes back and offers it again
+DataReceiver::~DataReceiver()
+{
+   putAside();
+}
+
+
+void DataReceiver::putAside()
+{
+   if(mActive && mData.size() > 0 && !isComplete())
+   {
+      if(mPartialTransfers.size() >= MaxPartialTransfers)
+         mPartialTransfers.erase(0);      // Oldest
+
+      mPartialTransfers.push_back(PartialTransfer());
+
+      PartialTransfer &partial = mPartialTransfers.last();
+      partial.checksum = mChecksum;
+      partial.compressedSize = mCompressedSize;
+      partial.data = mData;
+   }
+
+   cancel();
+}
+
+
+bool DataReceiver::begin(U8 type, const string &checksum, U32 size, U32 compressedSize, U32 maxSize)
+{
+   putAside();
+
+   // Compressed data can be a little bigger than the original, if the original didn't compress well
+   if(size > maxSize || compressedSize > maxSize + maxSize / 8 + 1024 || compressedSize == 0)
+      return false;
+
+   mActive = true;
+   mType = type;
+   mChecksum = checksum;
+   mSize = size;
+   mCompressedSize = compressedSize;
+
+   for(S32 i = 0; i < mPartialTransfers.size(); i++)
+      if(mPartialTransfers[i].checksum == checksum && mPartialTransfers[i].compressedSize == compressedSize)
+      {
+         mData = mPartialTransfers[i].data;
+         mPartialTransfers.erase(i);
+         break;
+      }
+
+   mLastAckPos = mData.size();
+
+   return true;
+}
+
+
+// Data arrives in order, so anything that doesn't pick up exactly where we left off is left over from something else
+bool DataReceiver::addData(U32 offset, const ByteBuffer &data)
+{
+   if(!mActive || offset != U32(mData.size()) || offset + data.getBufferSize() > mCompressedSize)
+      return false;
+
+   mData.resize(offset + data.getBufferSize());
+   memcpy(mData.address() + offset, data.getBuffer(), data.getBufferSize());
+
+   if(!isComplete() && U32(mData.size()) - mLastAckPos < AckInterval)
+      return false;
+
+   mLastAckPos = mData.size();
+   return true;
+}
+
+
+bool DataReceiver::isActive()
+{
+   return mActive;
+}
+
+
+bool DataReceiver::isComplete()
+{
+   return mActive && U32(mData.size()) == mCompressedSize;
+}
+
+
+bool DataReceiver::finish(Vector<U8> &data)
+{
+   bool ok = isComplete() && uncompressBuffer(mData.address(), mData.size(), mSize, data) && U32(data.size()) == mSize;
+
+   if(ok)
+   {
+      Md5::IncrementalHasher hasher;
+      hasher.add((const char *)data.address(), data.size());
+      ok = hasher.getHash() == mChecksum;
+   }
+
+   if(!ok)
+      data.clear();
+
+   cancel();
+   return ok;
+}
+
+
+void DataReceiver::cancel()
+{
+   mActive = false;
+   mData.clear();
+   mChecksum = "";
+   mLastAckPos = 0;
+}
+
+
+U8 DataReceiver::getType()
+{
+   return mType;
+}
+
+
+const string &DataReceiver::getChecksum()
+{
+   return mChecksum;
+}
+
+
+U32 DataReceiver::getReceivedSize()
+{
+   return mData.size();
+}
+
+
+F32 DataReceiver::getProgress()
+{
+   if(!mActive || mCompressedSize == 0)
+      return 0;
+
+   return F32(mData.size()) / mCompressedSize;
 }
 
 
@@ -272,6 +477,8 @@ DataConnection::DataConnection(GameSettings *settings, ActionType action, string
    mPassword = password;
 
    mOutputFile = NULL;
+
+   setFixedRateParameters(MinPacketPeriod, MinPacketPeriod, MaxBandwidth, MaxBandwidth);
 }
 
 
@@ -283,6 +490,8 @@ DataConnection::DataConnection(GameSettings *settings, const Nonce &clientId)
    mAction = REQUEST_CURRENT_LEVEL;
    mFileType = INVALID_RESOURCE_TYPE;
    mOutputFile = NULL;
+
+   setFixedRateParameters(MinPacketPeriod, MinPacketPeriod, MaxBandwidth, MaxBandwidth);
 }
 
 // Destructor
@@ -292,6 +501,19 @@ DataConnection::~DataConnection()
 }
 
 
+// The server does its sending through ServerGame, so the transfer can be driven from its idle loop
+DataSender *DataConnection::getDataSender()
+{
+   if(isInitiator())
+      return &mDataSender;
+
+   TNLAssert(dynamic_cast<GameNetInterface *>(getInterface()), "Not a GameNetInterface");
+   TNLAssert(((GameNetInterface *)getInterface())->getGame()->isServer(), "Not a ServerGame");
+
+   return &static_cast<ServerGame *>(((GameNetInterface *)getInterface())->getGame())->dataSender;
+}
+
+
 // static method
 string DataConnection::getErrorMessage(SenderStatus stat, const string &filename)
 {
@@ -378,7 +600,7 @@ TNL_IMPLEMENT_RPC(DataConnection, c2sSendOrRequestFile,
       if(mOutputFile) 
          fclose((FILE*)mOutputFile);
 
-      mOutputFile = fopen(strictjoindir(folder, filename.getString()).c_str(), "w");
+      mOutputFile = fopen(strictjoindir(folder, filename.getString()).c_str(), "wb");
 
       if(!mOutputFile)
       {
@@ -408,15 +630,61 @@ TNL_IMPLEMENT_RPC(DataConnection, s2cOkToSend, (), (),
 }
 
 
+// << DataSendable >>
+// Sender is about to start sending -- this gets run on the receiving end
+TNL_IMPLEMENT_RPC(DataConnection, s2rBeginTransfer, (U8 type, StringPtr checksum, U32 size, U32 compressedSize), 
+                  (type, checksum, size, compressedSize), 
+                  NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirAny, 0)
+{
+   if(!mOutputFile)
+      return;
+
+   if(!mDataReceiver.begin(type, checksum.getString(), size, compressedSize, MaxFileSize))
+   {
+      logprintf("Incoming file is too big");
+      disconnect(ReasonError, "File is too big");
+      return;
+   }
+
+   r2sAcknowledgeData(checksum, mDataReceiver.getReceivedSize());    // Tells sender where to start
+}
+
+
 // << DataSendable >>
 // Send a chunk of the file -- this gets run on the receiving end       
-TNL_IMPLEMENT_RPC(DataConnection, s2rSendLine, (StringPtr line), (line), 
+TNL_IMPLEMENT_RPC(DataConnection, s2rSendData, (U32 offset, ByteBufferPtr data), (offset, data), 
                   NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirAny, 0)
 {
-   if(mOutputFile)
-      fwrite(line.getString(), 1, strlen(line.getString()), mOutputFile);
-      //mOutputFile.write(line.getString(), strlen(line.getString()));
-   // else... what?
+   if(!mDataReceiver.addData(offset, *data.getPointer()))
+      return;
+
+   string checksum = mDataReceiver.getChecksum();
+
+   if(mDataReceiver.isComplete())
+   {
+      Vector<U8> fileData;
+      if(!mDataReceiver.finish(fileData))
+      {
+         logprintf("File was damaged in transit");
+         disconnect(ReasonError, "File was damaged in transit");
+         return;
+      }
+
+      if(mOutputFile)
+         fwrite(fileData.address(), 1, fileData.size(), mOutputFile);
+   }
+
+   r2sAcknowledgeData(checksum.c_str(), offset + data->getBufferSize());
+}
+
+
+// << DataSendable >>
+// Receiver tells us how much it has -- this gets run on the sending end
+TNL_IMPLEMENT_RPC(DataConnection, r2sAcknowledgeData, (StringPtr checksum, U32 offset), (checksum, offset), 
+                  NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirAny, 0)
+{
+   if(getDataSender()->acknowledge(this, checksum.getString(), offset))
+      s2rCommandComplete(STATUS_OK);
 }
 
 
@@ -458,7 +726,7 @@ void DataConnection::onConnectionEstablished()
          //mOutputFile.open(strictjoindir(folder, mFilename).c_str());
          if(mOutputFile) 
             fclose(mOutputFile);
-         mOutputFile = fopen(strictjoindir(folder, mFilename).c_str(), "w");
+         mOutputFile = fopen(strictjoindir(folder, mFilename).c_str(), "wb");
          if(!mOutputFile)
          {
             logprintf("Problem opening file %s for writing", strictjoindir(folder, mFilename).c_str());
@@ -54,8 +54,9 @@ public:
    DataSendable();           // Constructor
    virtual ~DataSendable();  // Destructor
 
-   TNL_DECLARE_RPC_INTERFACE(s2rSendLine, (StringPtr line));      // Send a chunk of data
-   TNL_DECLARE_RPC_INTERFACE(s2rCommandComplete, (RangedU32<0,SENDER_STATUS_COUNT> status));   // Signal that data has been sent
+   TNL_DECLARE_RPC_INTERFACE(s2rBeginTransfer, (U8 type, StringPtr checksum, U32 size, U32 compressedSize));   // Announce data
+   TNL_DECLARE_RPC_INTERFACE(s2rSendData, (U32 offset, ByteBufferPtr data));             // Send a chunk of data
+   TNL_DECLARE_RPC_INTERFACE(r2sAcknowledgeData, (StringPtr checksum, U32 offset));      // Tell sender how much we have
 };
 
 
@@ -65,26 +66,85 @@ public:
 class GameSettings;
 class FolderManager;
 
+// Compresses a file and feeds it to a DataSendable connection a window at a time, with the window sized to what the
+// connection can carry.  The receiver acknowledges data as it arrives, and tells us where to start from, so a
+// transfer that was cut short by a dropped connection can pick up where it left off.
 class DataSender 
 {
 private:
    bool mDone;
-   S32 mLineCtr;
-   Vector<string> mLines;           // Store strings because storing char * will cause problems when source string is gone
+   bool mStarted;                   // Set once the receiver has told us where to start
+   Vector<U8> mData;                // Compressed data
+   string mChecksum;                // Hash of the uncompressed data, which also identifies the transfer
+   U32 mSentPos;
+   U32 mAckedPos;
    SafePtr<Object> mConnection;     // need to use SafePtr, as it is possible that a player disconnect making it no longer valid
-   FileType mFileType;
+
+   U32 getWindowSize(NetConnection *connection);
 
 public:
+   static const U32 ChunkSize = 512;               // Events larger than a packet don't get sent at all
+   static const U32 MinWindowSize = 16 * 1024;
+   static const U32 MaxWindowSize = 256 * 1024;
+
    DataSender();        // Constructor
    virtual ~DataSender();
 
    SenderStatus initialize(DataSendable *connection, FolderManager *folderManager, string filename, FileType fileType);   
+   SenderStatus initialize(DataSendable *connection, const string &filename, U32 maxSize, U8 type);
+   SenderStatus initialize(DataSendable *connection, const U8 *data, U32 size, U8 type);
 
    bool isDone();
-   void sendNextLine();
+   void cancel();
+   void sendNextChunks();
+   bool acknowledge(DataSendable *connection, const char *checksum, U32 offset);    // Returns true when everything has arrived
+   F32 getProgress();
 };
 
 
+// The receiving end of a DataSender.  Transfers that don't finish are put aside when the receiver goes away, keyed by
+// their checksum, so if the same data is offered again, we can ask for just the part we're missing.
+class DataReceiver
+{
+private:
+   struct PartialTransfer
+   {
+      string checksum;
+      U32 compressedSize;
+      Vector<U8> data;
+   };
+
+   static Vector<PartialTransfer> mPartialTransfers;
+   static const S32 MaxPartialTransfers = 4;
+
+   bool mActive;
+   U8 mType;
+   string mChecksum;
+   U32 mSize;
+   U32 mCompressedSize;
+   Vector<U8> mData;                // Compressed data received so far
+   U32 mLastAckPos;
+
+   void putAside();
+
+public:
+   static const U32 AckInterval = 4 * 1024;     // Must be well under DataSender::MinWindowSize
+
+   DataReceiver();      // Constructor
+   virtual ~DataReceiver();
+
+   bool begin(U8 type, const string &checksum, U32 size, U32 compressedSize, U32 maxSize);
+   bool addData(U32 offset, const ByteBuffer &data);     // Returns true if we should acknowledge
+   bool isActive();
+   bool isComplete();
+   bool finish(Vector<U8> &data);   // Uncompresses and verifies the data; the transfer is over either way
+   void cancel();
+
+   U8 getType();
+   const string &getChecksum();
+   U32 getReceivedSize();
+   F32 getProgress();
+};
 ////////////////////////////////////////
 ////////////////////////////////////////
 
@@ -97,11 +157,13 @@ private:
    string mFilename;          
    string mPassword;          // Password supplied by user
    FILE *mOutputFile;         // Where we'll save any incoming data
+   DataReceiver mDataReceiver;
 
    Nonce mClientId;           // When called from an active connection, client ID can be used to deterimine if player
                               // has sufficient permissions
 
    bool connectionsAllowed();
+   DataSender *getDataSender();
 
    GameSettings *mSettings;
 
@@ -117,9 +179,18 @@ public:
 
    static string getErrorMessage(SenderStatus stat, const string &filename);
 
+   static const U32 MaxFileSize = 256 * 1024;      // Need some limit to avoid overflowing server; arbitrary value
+
+   // We have the connection to ourselves, so let it run as fast as TNL allows
+   static const U32 MinPacketPeriod = 20;
+   static const U32 MaxBandwidth = 65535;
+
    // These from the DataSendable interface class
-   TNL_DECLARE_RPC(s2rSendLine, (StringPtr line));
-   TNL_DECLARE_RPC(s2rCommandComplete, (RangedU32<0,SENDER_STATUS_COUNT> status));
+   TNL_DECLARE_RPC(s2rBeginTransfer, (U8 type, StringPtr checksum, U32 size, U32 compressedSize));
+   TNL_DECLARE_RPC(s2rSendData, (U32 offset, ByteBufferPtr data));
+   TNL_DECLARE_RPC(r2sAcknowledgeData, (StringPtr checksum, U32 offset));
+
+   TNL_DECLARE_RPC(s2rCommandComplete, (RangedU32<0,SENDER_STATUS_COUNT> status));   // Signal that data has been sent
 
    TNL_DECLARE_RPC(s2cOkToSend, ());
 
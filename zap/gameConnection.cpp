@@ -86,8 +86,6 @@ void GameConnection::initialize()
 
    switchedTeamCount = 0;
    mSendableFlags = 0;
-   mDataBuffer = NULL;
-   mDataBufferLevelGen = NULL;
    mUploadIndex = -1;
 
    mWrongPasswordCount = 0;
@@ -131,7 +129,6 @@ GameConnection::~GameConnection()
    }
 
    delete mLevelSource;
-   delete mDataBuffer;
 }
 
 
@@ -157,6 +154,7 @@ ServerGame *GameConnection::getServerGame()
 void GameConnection::resetConnectionStatus()
 {  
    mReadyForRegularGhosts = false;
+   mWallOfferPending = false;
    mWantsScoreboardUpdates = false;
 }
 
@@ -307,6 +305,7 @@ TNL_IMPLEMENT_RPC(GameConnection, s2cTeamsLocked, (bool locked), (locked),
 
 
 const U32 maxDataBufferSize = 1024*1024*8;  // 8 MB
+const U32 maxDownloadSize = 1024*1024*256;   // Game recordings can get big
 
 void GameConnection::submitPassword(const char *password)
 {
@@ -1621,7 +1620,9 @@ void GameConnection::ReceivedRecordedGameplay(const U8 *filedata, U32 filedatasi
 }
 
 
-TNL_IMPLEMENT_RPC(GameConnection, s2rSendDataParts, (U8 type, ByteBufferPtr data), (type, data), 
+// << DataSendable >>
+TNL_IMPLEMENT_RPC(GameConnection, s2rBeginTransfer, (U8 type, StringPtr checksum, U32 size, U32 compressedSize), 
+                  (type, checksum, size, compressedSize), 
                   NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirAny, 0)
 {
    // Abort early if user can't upload
@@ -1629,53 +1630,79 @@ TNL_IMPLEMENT_RPC(GameConnection, s2rSendDataParts, (U8 type, ByteBufferPtr data
                          (mSettings->getSetting<YesNo>(IniKey::AllowAdminMapUpload) && mClientInfo->isAdmin())))
       return;
 
-   ByteBuffer *&dataBuffer = (type & 2 ? mDataBufferLevelGen : mDataBuffer);
+   // Clients only upload levels
+   if(!isInitiator() && type != TransmissionLevelFile)
+      return;
 
-   if(dataBuffer)
-   {
-      if(dataBuffer->getBufferSize() < maxDataBufferSize || isInitiator())  // Limit memory consumption (no limit on clients due to how big game recordings can be)
-         dataBuffer->appendBuffer(*data.getPointer());
-   }
-   else
+   if(!mDataReceiver.begin(type, checksum.getString(), size, compressedSize, isInitiator() ? maxDownloadSize : maxDataBufferSize))
    {
-      dataBuffer = new ByteBuffer(*data.getPointer());
-      dataBuffer->takeOwnership();
+      if(isInitiator())
+         s2cDisplayErrorMessage_remote("!!! File is too big to download");
+      else
+         s2cDisplayErrorMessage("!!! Upload failed -- file is too big");
+      return;
    }
 
-   if((type & TransmissionDone) && mDataBuffer && mDataBuffer->getBufferSize() != 0)
+   r2sAcknowledgeData(checksum, mDataReceiver.getReceivedSize());    // Tells sender where to start
+}
+
+
+// << DataSendable >>
+TNL_IMPLEMENT_RPC(GameConnection, s2rSendData, (U32 offset, ByteBufferPtr data), (offset, data), 
+                  NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirAny, 0)
+{
+   if(!mDataReceiver.addData(offset, *data.getPointer()))
+      return;
+
+   r2sAcknowledgeData(mDataReceiver.getChecksum().c_str(), mDataReceiver.getReceivedSize());
+
+   if(mDataReceiver.isComplete())
+      receivedTransfer();
+}
+
+
+// << DataSendable >>
+TNL_IMPLEMENT_RPC(GameConnection, r2sAcknowledgeData, (StringPtr checksum, U32 offset), (checksum, offset), 
+                  NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirAny, 0)
+{
+   mDataSender.acknowledge(this, checksum.getString(), offset);
+}
+
+
+void GameConnection::receivedTransfer()
+{
+   U8 type = mDataReceiver.getType();
+
+   Vector<U8> data;
+   if(!mDataReceiver.finish(data) || data.size() == 0)
    {
-      if(type & TransmissionRecordedGame)
-         ReceivedRecordedGameplay(mDataBuffer->getBuffer(), mDataBuffer->getBufferSize());
-      else if(mDataBufferLevelGen)
-         ReceivedLevelFile(mDataBuffer->getBuffer(), mDataBuffer->getBufferSize(), 
-                           mDataBufferLevelGen->getBuffer(), mDataBufferLevelGen->getBufferSize());
+      if(isInitiator())
+         s2cDisplayErrorMessage_remote("!!! Download failed -- file was damaged");
       else
-         ReceivedLevelFile(mDataBuffer->getBuffer(), mDataBuffer->getBufferSize(), NULL, 0);
+         s2cDisplayErrorMessage("!!! Upload failed -- file was damaged");
+      return;
    }
 
-   if(type & TransmissionDone)
+   if(type == TransmissionRecordedGame)
    {
-      if(mDataBuffer)
-      {
-         delete mDataBuffer;
-         mDataBuffer = NULL;
-      }
-
-      if(mDataBufferLevelGen)
-      {
-         delete mDataBufferLevelGen;
-         mDataBufferLevelGen = NULL;
-      }
+      ReceivedRecordedGameplay(data.address(), data.size());
+      return;
    }
-}
 
+   // Level size, little-endian, then the level, then the levelgen
+   U32 levelSize = 0;
+   for(U32 i = 0; i < 4 && i < U32(data.size()); i++)
+      levelSize |= U32(data[i]) << (i * 8);
 
-TNL_IMPLEMENT_RPC(GameConnection, s2rTransferFileSize, (U32 size), (size), 
-                  NetClassGroupGameMask, RPCGuaranteedOrdered, RPCDirAny, 0)
-{
-   mReceiveTotalSize = size;
+   if(data.size() < 4 || levelSize == 0 || levelSize > U32(data.size()) - 4)
+      return;
+
+   U32 levelGenSize = data.size() - 4 - levelSize;
+
+   ReceivedLevelFile(data.address() + 4, levelSize, levelGenSize ? data.address() + 4 + levelSize : NULL, levelGenSize);
 }
 
+
 static S32 QSORT_CALLBACK numberAlphaSort(string *a, string *b)
 {
    int aNum = atoi(a->c_str());
@@ -1729,195 +1756,73 @@ TNL_IMPLEMENT_RPC(GameConnection, s2cSetFilename, (string filename), (filename),
    mFileName = filename;
 }
 
+// Sends the level and its levelgen as a single transfer
 bool GameConnection::TransferLevelFile(const char *filename)
 {
-   BitStream s;
-   const U32 partsSize = 512;   // max 1023, limited by ByteBufferSizeBitSize value of 10
+   string level;
+   if(!readFile(filename, level) || level.size() == 0)
+      return false;
 
-   FILE *f = fopen(filename, "rb");
+   LevelInfo levelInfo;
+   LevelSource::getLevelInfoFromCodeChunk(level.substr(0, 8192), levelInfo);
 
-   if(f)
-   {
-      U32 size = partsSize;
-      const U32 DATAARRAYSIZE = 8192;
-      U8 *data = new U8[DATAARRAYSIZE];
-      U32 totalTransferSize = 0;
-      size = fread(data, 1, DATAARRAYSIZE, f);
+   string levelGen;
 
-      mPendingTransferData.resize(0);
+   if(levelInfo.mScriptFileName.c_str()[0] != 0)
+   {
+      FolderManager *folderManager = mSettings->getFolderManager();
+      string filename1 = strictjoindir(folderManager->getLevelDir(), levelInfo.mScriptFileName);
 
-      if(size <= 0 || size > DATAARRAYSIZE)
+      // Script line missing ".levelgen"?
+      if(!readFile(filename1, levelGen) && !readFile(filename1 + ".levelgen", levelGen) && isInitiator())  // isClient
       {
-         fclose(f);
-         delete[] data;
+         s2cDisplayErrorMessage_remote("Unable to find LevelGen");
          return false;
       }
+   }
 
-      LevelInfo levelInfo;
-      LevelSource::getLevelInfoFromCodeChunk(string((char*)data, size), levelInfo);
-
-      for(U32 i = 0; i < size; i += partsSize)
-      {
-         ByteBuffer *bytebuffer = new ByteBuffer(&data[i], min(partsSize, size - i));
-         bytebuffer->takeOwnership();
-         mPendingTransferData.push_back(bytebuffer);
-         totalTransferSize += bytebuffer->getBufferSize();
-      }
-      delete[] data;
-
-      size = (size == DATAARRAYSIZE ? partsSize : 0);
-      while(size == partsSize)
-      {
-         ByteBuffer *bytebuffer = new ByteBuffer(512);
-
-         size = (U32)fread(bytebuffer->getBuffer(), 1, bytebuffer->getBufferSize(), f);
-
-         if(size != partsSize)
-            bytebuffer->resize(size);
-
-         mPendingTransferData.push_back(bytebuffer);
-         totalTransferSize += size;
-      }
-      fclose(f);
-
-      U32 pendingleveltransfer = mPendingTransferData.size();
-
-      if(levelInfo.mScriptFileName.c_str()[0] != 0)
-      {
-         FolderManager *folderManager = mSettings->getFolderManager();
-         string filename1 = strictjoindir(folderManager->getLevelDir(), levelInfo.mScriptFileName);
-         f = fopen(filename1.c_str(), "rb");
-
-         if(!f)
-         {
-            filename1 += ".levelgen"; // Script line missing ".levelgen"?
-            f = fopen(filename1.c_str(), "rb");
-            if(!f)
-            {
-               if(isInitiator()) // isClient
-               {
-                  s2cDisplayErrorMessage_remote("Unable to find LevelGen");
-
-                  // Vector deleteAndClear doesn't work for SafePtr on OSX, so we do it the
-                  // old-fashioned way
-                  for(S32 i = 0; i < mPendingTransferData.size(); i++)
-                     delete mPendingTransferData[i].getPointer();
-                  mPendingTransferData.clear();
-
-                  return false;
-               }
-            }
-         }
-      }
-      else
-         f = NULL;
-
-      if(f)
-      {
-         U32 size = partsSize;
-         while(size == partsSize)
-         {
-            ByteBuffer *bytebuffer = new ByteBuffer(512);
-
-            size = (U32)fread(bytebuffer->getBuffer(), 1, bytebuffer->getBufferSize(), f);
+   Vector<U8> data(4 + level.size() + levelGen.size());
+   data.resize(4 + level.size() + levelGen.size());
 
-            if(size != partsSize)
-               bytebuffer->resize(size);
+   // Level size, little-endian, so the receiver can split them apart again
+   for(U32 i = 0; i < 4; i++)
+      data[i] = U8(level.size() >> (i * 8));
 
-            mPendingTransferData.push_back(bytebuffer);
-            totalTransferSize += size;
-         }
-         fclose(f);
-      }
+   memcpy(data.address() + 4, level.c_str(), level.size());
+   if(levelGen.size() > 0)
+      memcpy(data.address() + 4 + level.size(), levelGen.c_str(), levelGen.size());
 
-      s2rTransferFileSize(totalTransferSize);
-      for(U32 i=0; i < pendingleveltransfer; i++)
-         s2rSendDataParts(TransmissionLevelFile, ByteBufferPtr(mPendingTransferData[i]));
-      for(U32 i=pendingleveltransfer; i < U32(mPendingTransferData.size()); i++)
-         s2rSendDataParts(TransmissionLevelGenFile, ByteBufferPtr(mPendingTransferData[i]));
-
-      s2rSendDataParts(TransmissionDone, ByteBufferPtr(new ByteBuffer(0)));
-      return true;
-   }
-
-   return false;
+   return mDataSender.initialize(this, data.address(), data.size(), TransmissionLevelFile) == STATUS_OK;
 }
 
+
 bool GameConnection::TransferRecordedGameplay(const char *filename)
 {
-   BitStream s;
-   const U32 partsSize = 512;   // max 1023, limited by ByteBufferSizeBitSize value of 10
-
-   FILE *f = fopen(filename, "rb");
-
-   if(f)
-   {
-      mPendingTransferData.resize(0);
-      U32 totalTransferSize = 0;
-
-      U32 size = partsSize;
-      while(size == partsSize)
-      {
-         ByteBuffer *bytebuffer = new ByteBuffer(512);
-
-         size = (U32)fread(bytebuffer->getBuffer(), 1, bytebuffer->getBufferSize(), f);
-
-         if(size != partsSize)
-            bytebuffer->resize(size);
-
-         mPendingTransferData.push_back(bytebuffer);
-         totalTransferSize += size;
-      }
-      fclose(f);
+   s2cSetFilename(filename);
 
-      if(mPendingTransferData.size() == 0)
-      {
-         if(!isInitiator())
-            s2cDisplayErrorMessage("Recorded file is empty");
-         return false;
-      }
-
-      s2cSetFilename(filename);
-      s2rTransferFileSize(totalTransferSize);
-      for(U32 i=0; i < U32(mPendingTransferData.size()) - 1; i++)
-         s2rSendDataParts(TransmissionRecordedGame, ByteBufferPtr(mPendingTransferData[i]));
+   SenderStatus status = mDataSender.initialize(this, filename, maxDownloadSize, TransmissionRecordedGame);
 
-      s2rSendDataParts(TransmissionRecordedGame | TransmissionDone, ByteBufferPtr(new ByteBuffer(0)));
+   if(status == STATUS_OK)
       return true;
-   }
-   else
-      if(!isInitiator())
+
+   if(!isInitiator())
+   {
+      if(status == FILE_TOO_LONG)
+         s2cDisplayErrorMessage("Recorded file is too big");
+      else
          s2cDisplayErrorMessage("Unable to read recorded file");
+   }
 
    return false;
 }
 
 
-
-
-
 F32 GameConnection::getFileProgressMeter()
 {
-   if(mPendingTransferData.size())
-   {
-      // Sent data becomes NULL, which we can use to see the upload progress.
-      S32 numberOfNull = 0;
-      for(S32 i = 0; i < mPendingTransferData.size(); i++)
-         if(mPendingTransferData[i].isNull())
-            numberOfNull++;
-      if(numberOfNull == mPendingTransferData.size())
-         mPendingTransferData.resize(0); // Everything is now NULL, zero size the Vector.
-      else
-         return F32(numberOfNull+1) / (mPendingTransferData.size()+1);
-   }
-   if(mDataBuffer && mReceiveTotalSize != 0)
-   {
-      U32 size = mDataBuffer->getBufferSize();
-      if(mDataBufferLevelGen)
-         size += mDataBufferLevelGen->getBufferSize();
-      return F32(size) / mReceiveTotalSize;
-   }
-   return 0;
+   if(!mDataSender.isDone())
+      return mDataSender.getProgress();
+
+   return mDataReceiver.getProgress();
 }
 
 
@@ -2113,6 +2018,9 @@ void GameConnection::updateTimers(U32 timeDelta)
    else
       mVoteTime -= timeDelta;
 
+   if(!mDataSender.isDone())
+      mDataSender.sendNextChunks();
+
    if(isInitiator())
       updateTimers_client(timeDelta);
    else
@@ -2314,7 +2222,7 @@ void GameConnection::onConnectionEstablished_server()
    mServerGame->addClient(mClientInfo);   // This clientInfo was created by the server... it has no badge data yet
    setGhostFrom(true);
    setGhostTo(false);
-   activateGhosting();
+   mServerGame->queueGhosting(this);
    //setFixedRateParameters(minPacketSendPeriod, minPacketRecvPeriod, maxSendBandwidth, maxRecvBandwidth);  // make this client only?
 
    GameSettings *settings = mServerGame->getSettings();
@@ -2440,6 +2348,18 @@ void GameConnection::setReadyForRegularGhosts(bool ready)
 }
 
 
+bool GameConnection::isWallOfferPending()
+{
+   return mWallOfferPending;
+}
+
+
+void GameConnection::setWallOfferPending(bool pending)
+{
+   mWallOfferPending = pending;
+}
+
+
 bool GameConnection::wantsScoreboardUpdates()
 {
    return mWantsScoreboardUpdates;
@@ -40,7 +40,7 @@ class LuaPlayerInfo;
 class GameSettings;
 class LevelSource;
 
-class GameConnection: public ControlObjectConnection, public ChatCheck
+class GameConnection: public ControlObjectConnection, public ChatCheck, public DataSendable
 {
 private:
    typedef ControlObjectConnection Parent;
@@ -70,6 +70,7 @@ private:
 
    bool mWantsScoreboardUpdates;    // Indicates if client has requested scoreboard streaming (e.g. pressing Tab key)
    bool mReadyForRegularGhosts;
+   bool mWallOfferPending;          // We've offered the walls and are waiting for c2sWallGeometryStatus
 
    StringTableEntry mClientNameNonUnique; // For authentication, not unique name
 
@@ -176,12 +177,18 @@ public:
    bool isReadyForRegularGhosts();
    void setReadyForRegularGhosts(bool ready);
 
+   bool isWallOfferPending();
+   void setWallOfferPending(bool pending);
+
    bool wantsScoreboardUpdates();
    void setWantsScoreboardUpdates(bool wantsUpdates);
 
    virtual void onStartGhosting();  // Gets run when game starts
    virtual void onEndGhosting();    // Gets run when game is over
 
+   // Client only -- every kill the server tells us about comes through here, for connections that keep track
+   virtual void onKillReported(const StringTableEntry &victim, const StringTableEntry &killer, const StringTableEntry &killerDescr) { }
+
 
    // Tell UI we're waiting for password confirmation from server
    void setWaitingForPermissionsReply(bool waiting);
@@ -282,23 +289,27 @@ public:
       // U8 max!
    };
 
-   enum LevelFileTransmissionStage { // for s2rSendDataParts only
-      TransmissionLevelFile = 1,
-      TransmissionLevelGenFile = 2,
-      TransmissionDone = 4,
+   enum TransmissionType { // for s2rBeginTransfer
+      TransmissionLevelFile = 1,       // Level and its levelgen, packed by TransferLevelFile()
       TransmissionRecordedGame = 8
    };
 
    U8 mSendableFlags;
 private:
-   ByteBuffer *mDataBuffer;
-   ByteBuffer *mDataBufferLevelGen;
+   DataSender mDataSender;
+   DataReceiver mDataReceiver;
    string mFileName; // used for game recorder filename
-public:
 
+   void receivedTransfer();
+
+public:
    TNL_DECLARE_RPC(s2rSendableFlags, (U8 flags));
-   TNL_DECLARE_RPC(s2rSendDataParts, (U8 type, ByteBufferPtr data));
-   TNL_DECLARE_RPC(s2rTransferFileSize, (U32 size));
+
+   // These from the DataSendable interface class
+   TNL_DECLARE_RPC(s2rBeginTransfer, (U8 type, StringPtr checksum, U32 size, U32 compressedSize));
+   TNL_DECLARE_RPC(s2rSendData, (U32 offset, ByteBufferPtr data));
+   TNL_DECLARE_RPC(r2sAcknowledgeData, (StringPtr checksum, U32 offset));
+
    TNL_DECLARE_RPC(c2sRequestRecordedGameplay, (StringPtr file));
    TNL_DECLARE_RPC(s2cListRecordedGameplays, (Vector<string> files));
    TNL_DECLARE_RPC(s2cSetFilename, (string filename));
@@ -311,9 +322,6 @@ public:
    void sendPermissionsToClient(ClientInfo::ClientRole role, bool displayNoticeToPlayers);
 
 
-   Vector<SafePtr<ByteBuffer> > mPendingTransferData; // Only used for progress meter
-   U32 mReceiveTotalSize;
-
    bool mVoiceChatEnabled;  // server side: false when this client have set the voice volume to zero, which means don't send voice to this client
                             // client side: this can allow or disallow sending voice to server
    TNL_DECLARE_RPC(s2rVoiceChatEnable, (bool enabled));
@@ -7,12 +7,14 @@
 
 #include "BanList.h"
 #include "barrier.h"
+#include "Compression.h"
 #include "game.h"
 #include "GameRecorder.h"
 #include "IniFile.h"          // For CIniFile
 #include "Level.h"
 #include "LineEditorFilterEnum.h"
 #include "loadoutZone.h"
+#include "Md5Utils.h"
 #include "PolyWall.h"
 #include "projectile.h"       // For s2cClientJoinedTeam()
 #include "robot.h"
@@ -134,6 +136,9 @@ void GameType::initialize(Level *level, S32 winningScore)
 
    mObjectsExpected = 0;
    mGame = NULL;
+
+   mWallGeometryRevision = 0;
+   mHasWallGeometryRevision = false;
 }
 
 
@@ -1528,39 +1533,249 @@ static void markAllMountedItemsAsBeingInScope(Ship *ship, GameConnection *conn)
 }
 
 
-// Runs only on server
-void GameType::performScopeQuery(GhostConnection *connection)
+static void markAllAsBeingInScope(const Vector<SafePtr<BfObject> > &objects, GameConnection *conn)
 {
-   GameConnection *conn = (GameConnection *) connection;
-   ClientInfo *clientInfo = conn->getClientInfo();
-   BfObject *controlObject = conn->getControlObject();
+   for(S32 i = 0; i < objects.size(); i++)
+      if(objects[i])
+         conn->objectInScope(objects[i]);
+}
 
-   // Put GameType in scope, always
-   conn->objectInScope(this);   
 
-   // This may prevent scoping any ships until after ClientInfo is all received on client side. (spy bugs scopes ships)
-   if(!conn->isReadyForRegularGhosts()) 
+// Team scope bitsets are indexed by object serial number.  Serial numbers are never reused, so a bit left behind by
+// a deleted object can't be mistaken for anything else.
+static bool isMarked(const Vector<U32> &marks, const BfObject *obj)
+{
+   U32 word = U32(obj->getSerialNumber()) >> 5;
+   return word < U32(marks.size()) && (marks[word] & (1 << (obj->getSerialNumber() & 31)));
+}
+
+
+static void setMark(Vector<U32> &marks, const BfObject *obj, bool marked)
+{
+   U32 word = U32(obj->getSerialNumber()) >> 5;
+
+   if(word >= U32(marks.size()))
+   {
+      if(!marked)
+         return;
+
+      marks.resize(word + 1);
+   }
+
+   if(marked)
+      marks[word] |= 1 << (obj->getSerialNumber() & 31);
+   else
+      marks[word] &= ~(1 << (obj->getSerialNumber() & 31));
+}
+
+
+// Empties a team scope list, along with its bitset
+static void clearTeamScopeList(Vector<SafePtr<BfObject> > &list, Vector<U32> &marks)
+{
+   for(S32 i = 0; i < list.size(); i++)
+      if(list[i])
+         setMark(marks, list[i], false);
+
+   list.clear();
+}
+
+
+// Adds obj to a team scope list unless it's already there, or in the exclude list
+static void addToTeamScopeList(BfObject *obj, Vector<SafePtr<BfObject> > &list, Vector<U32> &marks,
+                               const Vector<U32> *exclude = NULL)
+{
+   if(isMarked(marks, obj) || (exclude && isMarked(*exclude, obj)))
       return;
 
-   const Vector<SafePtr<BfObject> > &scopeAlwaysList = mGame->getScopeAlwaysList();
+   setMark(marks, obj, true);
+   list.push_back(SafePtr<BfObject>(obj));
+}
+
+
+// Adds everything found, along with anything the ships among them are carrying, as that's in scope too
+static void addWithMountedItems(const Vector<DatabaseObject *> &found, Vector<SafePtr<BfObject> > &list,
+                                Vector<U32> &marks, const Vector<U32> *exclude = NULL)
+{
+   for(S32 i = 0; i < found.size(); i++)
+   {
+      BfObject *obj = static_cast<BfObject *>(found[i]);
+      addToTeamScopeList(obj, list, marks, exclude);
+
+      if(isShipType(obj->getObjectTypeNumber()))
+      {
+         Ship *ship = static_cast<Ship *>(obj);
+         for(S32 j = 0; j < ship->getMountedItemCount(); j++)
+            if(ship->getMountedItem(j))
+               addToTeamScopeList(ship->getMountedItem(j), list, marks, exclude);
+      }
+   }
+}
+
+
+// Constructor
+GameType::TeamScope::TeamScope()
+{
+   valid = false;
+   time = 0;
+   commanderViewValid = false;
+}
+
+
+// Is obj already in this team's scope?  The commander view only counts for connections with the map open.
+bool GameType::TeamScope::contains(const BfObject *obj, bool inCommanderMap) const
+{
+   return isMarked(objectMarks, obj) || (inCommanderMap && commanderViewValid && isMarked(commanderViewMarks, obj));
+}
+
+
+// Teammates see the same always-in-scope objects, spy bug views and commander's map, so these are gathered the first
+// time anyone on the team needs them each tick, rather than once for every connection.  Server only.
+GameType::TeamScope &GameType::getTeamScope(S32 teamIndex)
+{
+   if(teamIndex < 0)
+   {
+      gatherTeamScope(teamIndex, mUncachedTeamScope);
+      return mUncachedTeamScope;
+   }
+
+   if(teamIndex >= mTeamScopes.size())
+      mTeamScopes.resize(teamIndex + 1);
+
+   TeamScope &teamScope = mTeamScopes[teamIndex];
+
+   if(!teamScope.valid || teamScope.time != mGame->getCurrentTime())
+      gatherTeamScope(teamIndex, teamScope);
+
+   return teamScope;
+}
+
+
+void GameType::gatherTeamScope(S32 teamIndex, TeamScope &teamScope)
+{
+   teamScope.valid = true;
+   teamScope.time = mGame->getCurrentTime();
+   teamScope.commanderViewValid = false;
+
+   clearTeamScopeList(teamScope.objects, teamScope.objectMarks);
+   clearTeamScopeList(teamScope.commanderView, teamScope.commanderViewMarks);
 
    // Make sure the "always-in-scope" objects are actually in scope.  Hmmmmm....
+   // Mounted flags are left out; they come along with whoever is carrying them.
+   const Vector<SafePtr<BfObject> > &scopeAlwaysList = mGame->getScopeAlwaysList();
+
    for(S32 i = 0; i < scopeAlwaysList.size(); i++)
    {
       BfObject *obj = scopeAlwaysList[i];
 
-      if(!obj)
+      if(!obj || !obj->isVisibleToTeam(teamIndex))
          continue;
 
-      if(!obj->isVisibleToTeam(conn->getClientInfo()->getTeamIndex()))
+      if(obj->getObjectTypeNumber() != FlagTypeNumber || !static_cast<MountableItem *>(obj)->isMounted())
+         addToTeamScopeList(obj, teamScope.objects, teamScope.objectMarks);
+   }
+
+   // What do the spy bugs see?
+   findSpyBugView(teamIndex, NULL, fillVector);
+   addWithMountedItems(fillVector, teamScope.objects, teamScope.objectMarks);
+}
+
+
+// If we're in commander's map mode, then we can see what our teammates can see
+void GameType::gatherCommanderView(S32 teamIndex, TeamScope &teamScope)
+{
+   fillVector.clear();
+   bool sameQuery = false;  // Helps speed up by not repeatedly finding same objects
+
+   for(S32 i = 0; i < mGame->getClientCount(); i++)
+   {
+      ClientInfo *clientInfo = mGame->getClientInfo(i);
+
+      if(clientInfo->getTeamIndex() != teamIndex)      // Wrong team
+         continue;
+
+      Ship *ship = clientInfo->getShip();
+      if(!ship)            // Can happen!
+         continue;
+
+      Rect queryRect(ship->getActualPos(), ship->getActualPos());
+      queryRect.expand(Game::getScopeRange(ship->hasModule(ModuleSensor)));
+
+      TestFunc testFunc;
+      if(ship->hasModule(ModuleSensor))
+         testFunc = &isVisibleOnCmdrsMapWithSensorType;
+      else     // No sensor
+         testFunc = &isVisibleOnCmdrsMapType;
+
+      mLevel->findObjects(testFunc, fillVector, queryRect, sameQuery);
+      sameQuery = true;
+   }
+
+   for(S32 i = 0; i < fillVector.size(); i++)
+      if(!static_cast<BfObject *>(fillVector[i])->isVisibleToTeam(teamIndex))
+      {
+         fillVector.erase_fast(i);
+         i--;
+      }
+
+   addWithMountedItems(fillVector, teamScope.commanderView, teamScope.commanderViewMarks, &teamScope.objectMarks);
+   teamScope.commanderViewValid = true;
+}
+
+
+// Finds everything within range of a set of spy bugs.  With no owner, that's the spy bugs the whole team can see:
+// neutral ones, and in team games the team's own.  Outside team games, spy bugs otherwise belong to a single player,
+// so pass that player as owner to find what their own bugs see.
+void GameType::findSpyBugView(S32 teamIndex, const ClientInfo *owner, Vector<DatabaseObject *> &found)
+{
+   found.clear();
+   bool sameQuery = false;  // Helps speed up by not repeatedly finding same objects
+
+   const Vector<DatabaseObject *> *spyBugs = mLevel->findObjects_fast(SpyBugTypeNumber);
+
+   for(S32 i = spyBugs->size() - 1; i >= 0; i--)
+   {
+      SpyBug *sb = static_cast<SpyBug *>(spyBugs->get(i));
+
+      bool sees;
+      if(owner)
+         sees = sb->getTeam() != TEAM_NEUTRAL && sb->getOwner() == owner;
+      else
+         sees = sb->getTeam() == TEAM_NEUTRAL || (isTeamGame() && sb->getTeam() == teamIndex);
+
+      if(!sees)
          continue;
 
-      if(obj->getObjectTypeNumber() != FlagTypeNumber ||
-                     !((MountableItem*)(((SafePtr<BfObject> *)&obj)->getPointer()))->isMounted())
-         conn->objectInScope(obj);
+      Point pos = sb->getActualPos();
+      Rect queryRect(pos, pos);
+
+      Point scopeRange(SpyBug::SPY_BUG_RANGE, SpyBug::SPY_BUG_RANGE);
+      queryRect.expand(scopeRange);
+
+      mLevel->findObjects((TestFunc)isAnyObjectType, found, queryRect, sameQuery);
+      sameQuery = true;
    }
+}
 
 
+// Runs only on server
+void GameType::performScopeQuery(GhostConnection *connection)
+{
+   GameConnection *conn = (GameConnection *) connection;
+   ClientInfo *clientInfo = conn->getClientInfo();
+   BfObject *controlObject = conn->getControlObject();
+
+   // Put GameType in scope, always
+   conn->objectInScope(this);   
+
+   // This may prevent scoping any ships until after ClientInfo is all received on client side. (spy bugs scopes ships)
+   if(!conn->isReadyForRegularGhosts()) 
+      return;
+
+   S32 teamIndex = clientInfo->getTeamIndex();
+   TeamScope &teamScope = getTeamScope(teamIndex);
+
+   markAllAsBeingInScope(teamScope.objects, conn);
+
    // readyForRegularGhosts is set once all the RPCs from the GameType have been received and acknowledged by the client
    if(conn->isReadyForRegularGhosts() && controlObject)
    {
@@ -1570,34 +1785,16 @@ void GameType::performScopeQuery(GhostConnection *connection)
       conn->objectInScope(controlObject);    
    }
 
-   // What does the spy bug see?
-   bool sameQuery = false;  // helps speed up by not repeatedly finding same objects
-
-
-   const Vector<DatabaseObject *> *spyBugs = mLevel->findObjects_fast(SpyBugTypeNumber);
-   
-   for(S32 i = spyBugs->size()-1; i >= 0; i--)
+   // Outside team games, players' own spy bugs are theirs alone
+   if(!isTeamGame())
    {
-      SpyBug *sb = static_cast<SpyBug *>(spyBugs->get(i));
+      findSpyBugView(teamIndex, clientInfo, fillVector);
 
-      if(sb->isVisibleToPlayer(clientInfo, isTeamGame()))
+      for(S32 i = 0; i < fillVector.size(); i++)
       {
-         Point pos = sb->getActualPos();
-         Rect queryRect(pos, pos);
-
-         Point scopeRange(SpyBug::SPY_BUG_RANGE, SpyBug::SPY_BUG_RANGE);
-         queryRect.expand(scopeRange);
-
-         fillVector.clear();
-         mLevel->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect, sameQuery);
-         sameQuery = true;
-
-         for(S32 j = 0; j < fillVector.size(); j++)
-         {
-            connection->objectInScope(static_cast<BfObject *>(fillVector[j]));
-            if(isShipType(fillVector[j]->getObjectTypeNumber()))
-               markAllMountedItemsAsBeingInScope(static_cast<Ship *>(fillVector[j]), conn);
-         }
+         conn->objectInScope(static_cast<BfObject *>(fillVector[i]));
+         if(isShipType(fillVector[i]->getObjectTypeNumber()))
+            markAllMountedItemsAsBeingInScope(static_cast<Ship *>(fillVector[i]), conn);
       }
    }
 }
@@ -1625,65 +1822,45 @@ void GameType::performProxyScopeQuery(BfObject *scopeObject, ClientInfo *clientI
    //   }
    //}
 
-   // If we're in commander's map mode, then we can see what our teammates can see.  
-   // This will also scope what we can see.
-
    GameConnection *connection = clientInfo->getConnection();
    TNLAssert(connection, "NULL gameConnection!");
 
-   if(isTeamGame() && connection->isInCommanderMap())
-   {
-      S32 teamId = clientInfo->getTeamIndex();
-      fillVector.clear();
-      bool sameQuery = false;  // Helps speed up by not repeatedly finding same objects
+   S32 teamIndex = clientInfo->getTeamIndex();
+   bool inCommanderMap = isTeamGame() && connection->isInCommanderMap();
 
-      for(S32 i = 0; i < mGame->getClientCount(); i++)
-      {
-         ClientInfo *clientInfo = mGame->getClientInfo(i);
-
-         if(clientInfo->getTeamIndex() != teamId)      // Wrong team
-            continue;
+   // Players on no regular team get their scope gathered anew each time it's asked for, so only look it up if we need
+   // the commander view
+   TeamScope *teamScope = (teamIndex >= 0 || inCommanderMap) ? &getTeamScope(teamIndex) : NULL;
 
-         Ship *ship = clientInfo->getShip();
-         if(!ship)            // Can happen!
-            continue;
-
-         Rect queryRect(ship->getActualPos(), ship->getActualPos());
-         queryRect.expand(Game::getScopeRange(ship->hasModule(ModuleSensor)));
-
-         TestFunc testFunc;
-         if(scopeObject == ship)    
-            testFunc = &isAnyObjectType;
-         else
-            if(ship && ship->hasModule(ModuleSensor))
-               testFunc = &isVisibleOnCmdrsMapWithSensorType;
-            else     // No sensor
-               testFunc = &isVisibleOnCmdrsMapType;
+   // If we're in commander's map mode, then we can see what our teammates can see.  That's the same for everyone on
+   // the team, so it's only gathered once per tick.
+   if(inCommanderMap)
+   {
+      if(!teamScope->commanderViewValid)
+         gatherCommanderView(teamIndex, *teamScope);
 
-         mLevel->findObjects(testFunc, fillVector, queryRect, sameQuery);
-         sameQuery = true;
-      }
+      markAllAsBeingInScope(teamScope->commanderView, connection);
    }
-   else     // Not a team game OR not in commander's map -- Do a simple query of the objects within scope range of the ship
-   {
-      // Note that if we make mine visibility controlled by server, here's where we'd put the code
-      Point pos = scopeObject->getPos();
-      TNLAssert(dynamic_cast<Ship *>(scopeObject), "Control object is not a ship!");
-      Ship *ship = static_cast<Ship *>(scopeObject);
 
-      Rect queryRect(pos, pos);
-      queryRect.expand(Game::getScopeRange(ship->hasModule(ModuleSensor)));
+   // Whether or not we're in the commander's map, we see everything within scope range of our own ship
+   // Note that if we make mine visibility controlled by server, here's where we'd put the code
+   Point pos = scopeObject->getPos();
+   TNLAssert(dynamic_cast<Ship *>(scopeObject), "Control object is not a ship!");
+   Ship *ship = static_cast<Ship *>(scopeObject);
 
-      fillVector.clear();
-      mLevel->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect);
-   }
+   Rect queryRect(pos, pos);
+   queryRect.expand(Game::getScopeRange(ship->hasModule(ModuleSensor)));
+
+   fillVector.clear();
+   mLevel->findObjects((TestFunc)isAnyObjectType, fillVector, queryRect);
 
-   // Set object-in-scope for all objects found above
+   // Set object-in-scope for all objects found above, skipping what the team's scope already covered, along with
+   // anything it was carrying
    for(S32 i = 0; i < fillVector.size(); i++)
    {
       BfObject *obj = static_cast<BfObject *>(fillVector[i]);
 
-      if(!obj->isVisibleToTeam(connection->getClientInfo()->getTeamIndex()))
+      if(!obj->isVisibleToTeam(teamIndex) || (teamScope && teamScope->contains(obj, inCommanderMap)))
          continue;
 
       connection->objectInScope(obj);
@@ -2655,6 +2832,33 @@ void GameType::onGhostAvailable(GhostConnection *theConnection)
                    getObjectsLoaded(), mLevelHasLoadoutZone, mEngineerEnabled, 
                    mEngineerUnrestrictedEnabled, mGame->getLevelDatabaseId());
 
+   sendTeamsAndClients(theConnection);
+
+   // Offer the client the walls; the sync finishes in c2sWallGeometryStatus once it tells us whether it needs them.
+   // Recordings can't answer, so they get the walls right away.
+   if(!prepareWallGeometry())
+   {
+      sendWallsToClient();
+      finishGhostAvailable(theConnection);
+   }
+   else if(dynamic_cast<GameRecorderServer *>(theConnection))
+   {
+      s2cSendWallGeometry(mWallGeometryHash.c_str(), mWallGeometryChunks);
+      finishGhostAvailable(theConnection);
+   }
+   else
+   {
+      ((GameConnection *) theConnection)->setWallOfferPending(true);
+      s2cOfferWallGeometry(mWallGeometryHash.c_str(), theConnection->getGhostingSequence());
+   }
+
+   NetObject::setRPCDestConnection(NULL);             // Set RPCs to go to all players
+}
+
+
+// Server only -- teams, flag carriers, and clients with their teams.  Expects RPCs to be focused on theConnection.
+void GameType::sendTeamsAndClients(GhostConnection *theConnection)
+{
    for(S32 i = 0; i < mLevel->getTeamCount(); i++)
    {
       StringTableEntry name   = mLevel->getTeamName(i);
@@ -2684,16 +2888,72 @@ void GameType::onGhostAvailable(GhostConnection *theConnection)
       if(team >= 0) 
          s2cClientJoinedTeam(clientInfo->getName(), team, false);
    }
+}
 
-   sendWallsToClient();
+
+// Server only -- everything a recording needs to pick up the game mid-level, posted to recorder for it to pull
+// back out of its event queue into a keyframe.  Level info and walls don't change within a level, so they're left out.
+void GameType::sendRecordingState(GameConnection *recorder)
+{
+   NetObject::setRPCDestConnection(recorder);
+
+   sendTeamsAndClients(recorder);
+
+   for(S32 i = 0; i < mGame->getClientCount(); i++)
+      s2cSetPlayerScore(i, mGame->getClientInfo(i)->getScore());
 
+   broadcastNewRemainingTime();
+   s2cSetGameOver(mGameOver);
+
+   NetObject::setRPCDestConnection(NULL);
+
+   updateClientScoreboard(recorder);
+}
+
+
+// Server only -- the last of the sync messages, sent once the client has its walls.  Expects RPCs to be focused on
+// theConnection.
+void GameType::finishGhostAvailable(GhostConnection *theConnection)
+{
    broadcastNewRemainingTime();
    s2cSetGameOver(mGameOver);    // TODO: Is this really needed?
    TNLAssert(!mGameOver, "Is this ever true here?");     // If this assert never trips... then we can get rid of the s2c above.  4/26/2014
 
    s2cSyncMessagesComplete(theConnection->getGhostingSequence());
+}
 
-   NetObject::setRPCDestConnection(NULL);             // Set RPCs to go to all players
+
+// TNL won't reassemble a BigData event bigger than 4MB, so anything near that goes wall by wall
+static const S32 MaxWallGeometryTransferSize = 3 * 1024 * 1024;
+
+// Server only -- packs and compresses the walls, unless we've already done it for this level.  Returns false if
+// the walls need to be sent the old way.
+bool GameType::prepareWallGeometry()
+{
+   U32 revision = mLevel->getWallRevision();
+
+   if(mHasWallGeometryRevision && revision == mWallGeometryRevision)
+      return mWallGeometryChunks.size() > 0;
+
+   mWallGeometryRevision = revision;
+   mHasWallGeometryRevision = true;
+   mWallGeometryChunks.clear();
+   mWallGeometryHash = "";
+
+   Vector<U8> geometry, compressed;
+   Barrier::packWallGeometry(mLevel, geometry);
+
+   if(!compressBuffer(geometry.address(), geometry.size(), compressed) || compressed.size() > MaxWallGeometryTransferSize)
+      return false;
+
+   // The hash covers what's actually sent, so walls added by a levelgen get a key of their own
+   Md5::IncrementalHasher md5;
+   md5.add((const char *)geometry.address(), geometry.size());
+   mWallGeometryHash = md5.getHash();
+
+   splitIntoChunks(compressed, mWallGeometryChunks);
+
+   return true;
 }
 
 
@@ -2760,12 +3020,75 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cAddWalls,
    // Empty wall deletes all existing walls, called by the server at the beginning
    // of a level to remove all walls from the ClientGame
    if(!verts.size())
+   {
       mGame->deleteObjects((TestFunc)isWallType);
+
+#ifndef ZAP_DEDICATED
+      static_cast<ClientGame *>(mGame)->forgetWallGeometry();     // Walls aren't coming from the cache after all
+#endif
+   }
    else
       Barrier::constructBarriers(mGame, verts, width);
 }
 
 
+// Server tells the client which walls the level has; client checks its cache and tells us if it needs them
+GAMETYPE_RPC_S2C(GameType, s2cOfferWallGeometry, (StringPtr hash, U32 sequence), (hash, sequence))
+{
+#ifndef ZAP_DEDICATED
+   TNLAssert(dynamic_cast<ClientGame *>(mGame) != NULL, "Not a ClientGame");
+   ClientGame *clientGame = static_cast<ClientGame *>(mGame);
+
+   bool haveIt = clientGame->loadCachedWallGeometry(hash.getString());
+   c2sWallGeometryStatus(hash, sequence, haveIt);
+#endif
+}
+
+
+GAMETYPE_RPC_C2S(GameType, c2sWallGeometryStatus, (StringPtr hash, U32 sequence, bool haveIt), (hash, sequence, haveIt))
+{
+   GameConnection *source = (GameConnection *) getRPCSourceConnection();
+
+   // Only answer once per offer -- each reply can cost us a full set of walls
+   if(!source->isWallOfferPending() || sequence != source->getGhostingSequence())     // Or level has changed since we asked
+      return;
+
+   source->setWallOfferPending(false);
+
+   NetObject::setRPCDestConnection(source);
+
+   // The walls could have changed since we made the offer
+   bool clientHasWalls = haveIt && mWallGeometryHash == hash.getString();
+
+   if(!clientHasWalls)
+   {
+      if(prepareWallGeometry())
+         s2cSendWallGeometry(mWallGeometryHash.c_str(), mWallGeometryChunks);
+      else
+         sendWallsToClient();
+   }
+
+   finishGhostAvailable(source);
+
+   NetObject::setRPCDestConnection(NULL);
+}
+
+
+// All the walls in one go, replacing any the client already has
+TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cSendWallGeometry, 
+                            (StringPtr hash, Vector<ByteBufferPtr> compressedGeometry), 
+                            (          hash,                       compressedGeometry), 
+                            NetClassGroupGameMask, RPCGuaranteedOrderedBigData, RPCToGhost, 0)
+{
+#ifndef ZAP_DEDICATED
+   TNLAssert(dynamic_cast<ClientGame *>(mGame) != NULL, "Not a ClientGame");
+   ClientGame *clientGame = static_cast<ClientGame *>(mGame);
+
+   clientGame->setWallGeometry(hash.getString(), compressedGeometry);
+#endif
+}
+
+
 // Gets called multiple times as barriers are added
 TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cAddPolyWalls, 
                             (Vector<Point> verts), 
@@ -2827,6 +3150,45 @@ void GameType::processServerCommand(ClientInfo *clientInfo, const char *cmd, Vec
       else
          clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Need admin");
    }
+   else if(stricmp(cmd, "scriptstats") == 0)
+   {
+      if(clientInfo->isAdmin())
+      {
+         Vector<string> lines;
+         LuaScriptRunner::getScriptStats(lines, 5);
+
+         if(lines.size() == 0)
+            clientInfo->getConnection()->s2cDisplayMessage(0, 0, "No scripts running");
+
+         for(S32 i = 0; i < lines.size(); i++)
+            clientInfo->getConnection()->s2cDisplayMessage(0, 0, lines[i].c_str());
+      }
+      else
+         clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Need admin");
+   }
+   else if(stricmp(cmd, "luaprofile") == 0)     // Toggles the Lua profiler
+   {
+      if(clientInfo->isAdmin())
+      {
+         if(!LuaScriptRunner::isProfiling())
+         {
+            LuaScriptRunner::startProfiling();
+            clientInfo->getConnection()->s2cDisplayMessage(0, 0, "Lua profiler started; run /luaprofile again to stop it");
+         }
+         else
+         {
+            string dir = serverGame->getSettings()->getFolderManager()->getLogDir();
+            string filename = joindir(dir, "luaprofile_" + makeFilenameFromString(getLevelName().c_str()) + ".folded");
+
+            if(LuaScriptRunner::stopProfiling(filename))
+               clientInfo->getConnection()->s2cDisplayMessage(0, 0, ("Lua profile written to " + filename).c_str());
+            else
+               clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Could not write Lua profile");
+         }
+      }
+      else
+         clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Need admin");
+   }
    else
       clientInfo->getConnection()->s2cDisplayErrorMessage("!!! Invalid Command");
 }
@@ -3784,6 +4146,10 @@ TNL_IMPLEMENT_NETOBJECT_RPC(GameType, s2cScoreboardUpdate,
 
 GAMETYPE_RPC_S2C(GameType, s2cKillMessage, (StringTableEntry victim, StringTableEntry killer, StringTableEntry killerDescr), (victim, killer, killerDescr))
 {
+   GameConnection *source = (GameConnection *) getRPCSourceConnection();
+   if(source)
+      source->onKillReported(victim, killer, killerDescr);
+
    if(killer)  // Known killer, was self, robot, or another player
    {
       if(killer == victim)
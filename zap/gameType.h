@@ -22,6 +22,8 @@
 
 #include <map>
 
+#include "gtest/gtest_prod.h"
+
 
 namespace Zap
 {
@@ -98,12 +100,49 @@ private:
 
    Vector<SafePtr<MoveItem> > mCacheResendItem;  // Speed up c2sResendItemStatus
 
+   // Server only -- the level's walls, packed and compressed once for all the clients that join
+   Vector<ByteBufferPtr> mWallGeometryChunks;
+   string mWallGeometryHash;
+   U32 mWallGeometryRevision;       // Level's wall revision when we packed them, so we notice if a levelgen changes them
+   bool mHasWallGeometryRevision;
+
+   // Server only -- what a team can see, gathered once per tick and shared by every teammate's scope query.
+   // SafePtrs, because objects can be deleted between packets.  Each list comes with a bitset over object serial
+   // numbers, so it holds nothing twice and a connection can skip what the team has already given it.
+   struct TeamScope
+   {
+      TeamScope();
+
+      bool valid;
+      U32 time;                                    // Game time when gathered
+      bool commanderViewValid;                     // Only gathered once someone on the team opens the commander's map
+      Vector<SafePtr<BfObject> > objects;          // Scope-always objects the team can see, and what its spy bugs see
+      Vector<U32> objectMarks;
+      Vector<SafePtr<BfObject> > commanderView;    // What the team's ships show on the commander's map, less objects
+      Vector<U32> commanderViewMarks;
+
+      bool contains(const BfObject *obj, bool inCommanderMap) const;
+   };
+
+   Vector<TeamScope> mTeamScopes;
+   TeamScope mUncachedTeamScope;    // For anyone not on a regular team; rebuilt every time
+
+   TeamScope &getTeamScope(S32 teamIndex);
+   void gatherTeamScope(S32 teamIndex, TeamScope &teamScope);
+   void gatherCommanderView(S32 teamIndex, TeamScope &teamScope);
+   void findSpyBugView(S32 teamIndex, const ClientInfo *owner, Vector<DatabaseObject *> &found);
+
+   FRIEND_TEST(ObjectScopeTest, TeamScopeIsGatheredOncePerTick);
+
    void initialize(Level *level, S32 winningScore);
 
    void idle_client(U32 deltaT);
    void idle_server(U32 deltaT);
 
    void sendWallsToClient();
+   bool prepareWallGeometry();
+   void finishGhostAvailable(GhostConnection *theConnection);
+   void sendTeamsAndClients(GhostConnection *theConnection);
 
    void launchKillStreakTextEffects(const ClientInfo *clientInfo) const;
    void fewerBots(ClientInfo *clientInfo);
@@ -379,6 +418,10 @@ public:
    TNL_DECLARE_RPC(s2cAddWalls,     (Vector<Point> barrier, F32 width));
    TNL_DECLARE_RPC(s2cAddPolyWalls, (Vector<Point> barrier));
 
+   TNL_DECLARE_RPC(s2cOfferWallGeometry,  (StringPtr hash, U32 sequence));
+   TNL_DECLARE_RPC(c2sWallGeometryStatus, (StringPtr hash, U32 sequence, bool haveIt));
+   TNL_DECLARE_RPC(s2cSendWallGeometry,   (StringPtr hash, Vector<ByteBufferPtr> compressedGeometry));
+
    TNL_DECLARE_RPC(s2cAddTeam, (StringTableEntry teamName, F32 r, F32 g, F32 b, U32 score, bool firstTeam));
    TNL_DECLARE_RPC(s2cAddClient, (StringTableEntry clientName, bool isAuthenticated, Int<BADGE_COUNT> badges, 
                                   U16 gamesPlayed, RangedU32<0, ClientInfo::MaxKillStreakLength> killStreak,
@@ -424,6 +467,7 @@ public:
    TNL_DECLARE_RPC(s2cScoreboardUpdate, (Vector<RangedU32<0, MaxPing> > pingTimes, Vector<SignedFloat<8> > ratings));
 
    void updateClientScoreboard(GameConnection *gc);
+   void sendRecordingState(GameConnection *recorder);
 
    TNL_DECLARE_RPC(c2sChooseNextWeapon, ());
    TNL_DECLARE_RPC(c2sChoosePrevWeapon, ());
@@ -505,8 +549,6 @@ public:
    bool addBotFromClient(Vector<StringTableEntry> args);
 
    void announceTeamsLocked(bool locked);
-
-   map <pair<U16,U16>, Vector<Point> > cachedBotFlightPlans;  // cache of zone-to-zone flight plans, shared for all bots
 };
 
 #define GAMETYPE_RPC_S2C(className, methodName, args, argNames) \
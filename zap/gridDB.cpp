@@ -37,6 +37,8 @@ GridDatabase::GridDatabase()
          mBuckets[i][j].nextInBucket = NULL;
 
    mDatabaseId = getNextId();
+   mWallRevision = 0;
+   mObjectRevision = 0;
 }
 
 
@@ -149,6 +151,11 @@ void GridDatabase::addToDatabase(DatabaseObject *object)
    else if(type == WallItemTypeNumber)
       mWallitems.push_back(object);
 
+   if(isWallType(type))
+      mWallRevision++;
+
+   mObjectRevision++;
+
    //sortObjects(mAllObjects);  // problem: Barriers in-game don't have mGeometry (it is NULL)
 }
 
@@ -195,6 +202,8 @@ void GridDatabase::removeEverythingFromDatabase()
    mSpyBugs.clear();
    mPolyWalls.clear();
    mWallitems.clear();
+   mWallRevision++;
+   mObjectRevision++;
 
    mAllObjects.deleteAndClear();
 }
@@ -268,6 +277,11 @@ void GridDatabase::removeFromDatabase(DatabaseObject *object, bool deleteObject)
    else if(type == WallItemTypeNumber)
       eraseObject_fast(&mWallitems, object);
 
+   if(isWallType(type))
+      mWallRevision++;
+
+   mObjectRevision++;
+
    if(deleteObject)
       delete object;      
 }
@@ -323,7 +337,7 @@ void GridDatabase::findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVect
 }
 
 
-void GridDatabase::findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
+void GridDatabase::findObjects(const Vector<U8> &typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const
 {
    mQueryId++;    // Used to prevent the same item from being found in multiple buckets
 
@@ -742,6 +756,18 @@ bool GridDatabase::hasObjectOfType(U8 typeNumber) const
 }
 
 
+U32 GridDatabase::getWallRevision() const
+{
+   return mWallRevision;
+}
+
+
+U32 GridDatabase::getObjectRevision() const
+{
+   return mObjectRevision;
+}
+
+
 // Kind of hacky, kind of useful.  Only used by BotZones, and ony works because all zones are added at one time, the list does not change,
 // and the index of the bot zones is stored as an ID by the zone.  If we added and removed zones from our list, this would probably not
 // be a reliable way to access a specific item.  We could probably phase this out by passing pointers to zones rather than indices.
@@ -765,6 +791,9 @@ void GridDatabase::updateExtents(DatabaseObject *object, const Rect &newExtents)
 
    Rect oldExtents = object->getExtent();
 
+   if(isWallType(object->getObjectTypeNumber()))
+      mWallRevision++;
+
    minxold = S32(oldExtents.min.x) >> BucketWidthBitShift;
    minyold = S32(oldExtents.min.y) >> BucketWidthBitShift;
    maxxold = S32(oldExtents.max.x) >> BucketWidthBitShift;
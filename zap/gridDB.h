@@ -14,6 +14,8 @@
 
 #include "Rect.h"
 
+#include "gtest/gtest_prod.h"
+
 
 using namespace TNL;
 
@@ -117,12 +119,18 @@ private:
    Vector<DatabaseObject *> mPolyWalls;
    Vector<DatabaseObject *> mWallitems;
 
+   U32 mWallRevision;                  // Bumped whenever a wall is added, removed, or moved
+   U32 mObjectRevision;                // Bumped whenever anything is added or removed
+
    void findObjects(U8 typeNumber, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
-   void findObjects(Vector<U8> typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
+   void findObjects(const Vector<U8> &typeNumbers, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins) const;
    void findObjects(TestFunc testFunc, Vector<DatabaseObject *> &fillVector, const Rect *extents, const IntRect *bins, bool sameQuery = false) const;
 
    void fillBins(const Rect &extents, IntRect &bins) const;    // Helper function -- translates extents into bins to search
 
+   FRIEND_TEST(RobotTest, TeamSnapshotQueriesOncePerTick);
+   FRIEND_TEST(ObjectScopeTest, TeamScopeIsGatheredOncePerTick);
+
 public:
    enum {
       BucketRowCount = 16,    // Number of buckets per grid row, and number of rows; should be power of 2
@@ -192,6 +200,8 @@ public:
    S32 getObjectCount() const;                          // Return the number of objects currently in the database
    S32 getObjectCount(U8 typeNumber) const;             // Return the number of objects currently in the database of specified type
    bool hasObjectOfType(U8 typeNumber) const;
+   U32 getWallRevision() const;                         // Changes whenever the walls do
+   U32 getObjectRevision() const;                       // Changes whenever objects come or go
    DatabaseObject *getObjectByIndex(S32 index) const;   // Kind of hacky, kind of useful
 };
 
@@ -106,6 +106,7 @@ using namespace TNL;
 #include "Console.h"       // For access to console
 #include "BotNavMeshZone.h"
 #include "ship.h"
+#include "LevelCache.h"
 #include "LevelSource.h"
 
 #include <math.h>
@@ -1205,6 +1206,17 @@ int main(int argc, char **argv)
       exitToOs(1);
    }
 
+   if(settings->getSetting<YesNo>(IniKey::ScriptBytecodeCache))
+      LuaScriptRunner::setBytecodeCacheDir(joindir(folderManager->getRootDataDir(), "scriptcache"));
+
+   if(settings->getSetting<YesNo>(IniKey::LevelCache))
+      LevelCache::setCacheDir(joindir(folderManager->getRootDataDir(), "levelcache"));
+
+   LuaScriptRunner::setScriptBudgets(settings->getSetting<U32>(IniKey::ScriptInstructionBudget),
+                                     settings->getSetting<U32>(IniKey::ScriptTimeBudget));
+
+   LuaScriptRunner::setGcParams(settings->getSetting<S32>(IniKey::LuaGcPause), settings->getSetting<S32>(IniKey::LuaGcStepMul));
+
    setupLogging(settings->getIniSettings());    // Turns various logging options on and off
 
    Ship::computeMaxFireDelay();                 // Look over weapon info and get some ranges, which we'll need before we start sending data
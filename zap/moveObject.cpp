@@ -786,6 +786,63 @@ void MoveObject::onGeomChanged()
 }
 
 
+static const U8 PositionDeltaBits = 10;
+static const U8 VelocityDeltaBits = 10;
+
+// Sends position and velocity to the nearest unit, as differences from what the client last acked when it has
+// anything recent enough.  Objects far enough away to be sent coarsely are sent whole, as before -- unless they've
+// come to rest.  A resting object won't be sent again until it moves, so the client would keep the coarse position
+// even after the player came close enough to see it.
+void MoveObject::writeMovement(GhostConnection *connection, GhostBaseline &baseline, const Point &pos, const Point &vel,
+                               U32 maxVel, U32 quantization, BitStream *stream)
+{
+   bool resting = fabs(vel.x) < 0.5f && fabs(vel.y) < 0.5f;      // Would be sent as 0 below
+
+   if(stream->writeFlag(quantization <= 1 || resting))
+   {
+      writeBaselineValue(stream, baseline, BaselinePosX, S32(floor(pos.x + 0.5f)), PositionDeltaBits);
+      writeBaselineValue(stream, baseline, BaselinePosY, S32(floor(pos.y + 0.5f)), PositionDeltaBits);
+      writeBaselineValue(stream, baseline, BaselineVelX, S32(floor(vel.x + 0.5f)), VelocityDeltaBits);
+      writeBaselineValue(stream, baseline, BaselineVelY, S32(floor(vel.y + 0.5f)), VelocityDeltaBits);
+   }
+   else
+   {
+      ((GameConnection *) connection)->writeCompressedPoint(pos, stream, quantization);
+      writeCompressedVelocity(vel, maxVel, stream);
+
+      // The client can't reproduce these exactly, so later updates can't be coded against them
+      baseline.validMask &= ~(BIT(BaselinePosX) | BIT(BaselinePosY) | BIT(BaselineVelX) | BIT(BaselineVelY));
+   }
+}
+
+
+void MoveObject::readMovement(GhostConnection *connection, GhostBaseline &baseline, Point &pos, Point &vel, U32 maxVel,
+                              BitStream *stream)
+{
+   if(stream->readFlag())
+   {
+      pos.x = F32(readBaselineValue(stream, baseline, BaselinePosX, PositionDeltaBits));
+      pos.y = F32(readBaselineValue(stream, baseline, BaselinePosY, PositionDeltaBits));
+      vel.x = F32(readBaselineValue(stream, baseline, BaselineVelX, VelocityDeltaBits));
+      vel.y = F32(readBaselineValue(stream, baseline, BaselineVelY, VelocityDeltaBits));
+   }
+   else
+   {
+      ((GameConnection *) connection)->readCompressedPoint(pos, stream);
+      readCompressedVelocity(vel, maxVel, stream);
+
+      baseline.validMask &= ~(BIT(BaselinePosX) | BIT(BaselinePosY) | BIT(BaselineVelX) | BIT(BaselineVelY));
+   }
+}
+
+
+// Moving goes through Item::setPos, which also flags GeomMask.  Nothing below us packs it, so it's movement too.
+U32 MoveObject::getMovementMask() const
+{
+   return PositionMask | GeomMask;
+}
+
+
 void MoveObject::computeImpulseDirection(DamageInfo *damageInfo)
 {
    // Compute impulse direction
@@ -963,8 +1020,12 @@ U32 MoveItem::packUpdate(GhostConnection *connection, U32 updateMask, BitStream
 
    if(stream->writeFlag(updateMask & PositionMask))
    {
-      ((GameConnection *) connection)->writeCompressedPoint(getActualPos(), stream);
-      writeCompressedVelocity(getActualVel(), VEL_POINT_SEND_BITS, stream);
+      GhostBaseline baseline;
+      connection->packBaselineReference(stream, baseline);
+      writeMovement(connection, baseline, getActualPos(), getActualVel(), VEL_POINT_SEND_BITS,
+                    getPositionQuantization(getInterestTier(connection)), stream);
+      connection->recordBaseline(baseline);
+
       stream->writeFlag(updateMask & WarpPositionMask);     // WarpPositionMask
    }
 
@@ -984,9 +1045,12 @@ void MoveItem::unpackUpdate(GhostConnection *connection, BitStream *stream)
 
    if(stream->readFlag())                          // PositionMask
    {
-      Point pt;
+      Point pt, vel;
 
-      ((GameConnection *) connection)->readCompressedPoint(pt, stream);
+      GhostBaseline baseline;
+      connection->unpackBaselineReference(stream, baseline);
+      readMovement(connection, baseline, pt, vel, VEL_POINT_SEND_BITS, stream);
+      connection->recordBaseline(baseline);
 
       // Here, we need to set the renderPos BEFORE setting actualPos -- setting actualPos triggers a 
       // recalculation of the object's extent, which, for whatever reason, will extend from the renderPos
@@ -997,9 +1061,7 @@ void MoveItem::unpackUpdate(GhostConnection *connection, BitStream *stream)
          setRenderPos(pt);
 
       setActualPos(pt);
-
-      readCompressedVelocity(pt, VEL_POINT_SEND_BITS, stream);   
-      setActualVel(pt);
+      setActualVel(vel);
 
       positionChanged = true;
       warpToNewPosition = stream->readFlag();     // WarpPositionMask
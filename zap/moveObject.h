@@ -74,6 +74,20 @@ protected:
       FirstFreeMask    = Parent::FirstFreeMask << 2
    };
 
+   // Slots in the GhostBaseline movement is coded against
+   enum BaselineSlots {
+      BaselinePosX,
+      BaselinePosY,
+      BaselineVelX,
+      BaselineVelY,
+      FirstFreeBaselineSlot
+   };
+
+   void writeMovement(GhostConnection *connection, GhostBaseline &baseline, const Point &pos, const Point &vel,
+                      U32 maxVel, U32 quantization, BitStream *stream);
+   void readMovement(GhostConnection *connection, GhostBaseline &baseline, Point &pos, Point &vel, U32 maxVel,
+                     BitStream *stream);
+
 
 public:
    MoveObject(const Point &p = Point(0,0), float radius = 1, float mass = 1);    // Constructor
@@ -152,6 +166,8 @@ public:
 
    virtual void onGeomChanged();
 
+   virtual U32 getMovementMask() const;
+
    ///// Lua interface
    LUAW_DECLARE_CLASS(MoveObject);
 
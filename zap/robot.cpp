@@ -880,21 +880,11 @@ S32 Robot::lua_getWaypoint(lua_State *L)
    // or the path we had no longer applied to our current location
    flightPlanTo = targetZone;
 
-   // check cache for path first
-   pair<S32,S32> pathIndex = pair<S32,S32>(currentZone, targetZone);
+   ServerGame *serverGame = static_cast<ServerGame *>(getGame());
+   const Vector<BotNavMeshZone *> &zones = serverGame->getBotZoneList();  // Our pre-cached list of nav zones
 
-   const Vector<BotNavMeshZone *> &zones = static_cast<ServerGame *>(getGame())->getBotZoneList();  // Our pre-cached list of nav zones
-
-   if(getGame()->getGameType()->cachedBotFlightPlans.find(pathIndex) == getGame()->getGameType()->cachedBotFlightPlans.end())
-   {
-      // Not found so calculate flight plan
-      flightPlan = AStar::findPath(&zones, currentZone, targetZone, target);
-
-      // Add to cache
-      getGame()->getGameType()->cachedBotFlightPlans[pathIndex] = flightPlan;
-   }
-   else
-      flightPlan = getGame()->getGameType()->cachedBotFlightPlans[pathIndex];
+   // Planner checks its zone-to-zone cache before searching
+   flightPlan = serverGame->getBotPathPlanner().findPath(&zones, currentZone, targetZone, target);
 
    if(flightPlan.size() > 0)
       return returnPoint(L, flightPlan.last());
@@ -1355,8 +1345,10 @@ S32 Robot::lua_findVisibleObjects(lua_State *L)
 
    fillVector.clear();
    static Vector<U8> types;
+   static ObjectTypeMask typeMask;
 
    types.clear();
+   typeMask.reset();
 
    // We expect the stack to look like this: -- [fillTable], objType1, objType2, ...
    // We'll work our way down from the top of the stack (element -1) until we find something that is not a number.
@@ -1369,15 +1361,20 @@ S32 Robot::lua_findVisibleObjects(lua_State *L)
       // Requests for botzones have to be handled separately; not a problem, we'll just do the search here, and add them to
       // fillVector, where they'll be merged with the rest of our search results.
       if(typenum != BotNavMeshZoneTypeNumber)
+      {
          types.push_back(typenum);
+         typeMask.set(typenum);
+      }
       else
          getGame()->getBotZoneDatabase().findObjects(BotNavMeshZoneTypeNumber, fillVector, queryRect);
 
       lua_pop(L, 1);
    }
 
-   // Get other objects on screen-visible area only
-   getGame()->getLevel()->findObjects(types, fillVector, queryRect);
+   // Get other objects on screen-visible area only.  Teammates share a per-tick snapshot of their surroundings,
+   // so usually we only need to filter that rather than query the database again.
+   if(types.size() > 0 && !static_cast<ServerGame *>(getGame())->findTeamVisibleObjects(this, typeMask, queryRect, fillVector))
+      getGame()->getLevel()->findObjects(types, fillVector, queryRect);
 
 
    // We are expecting a table to be on top of the stack when we get here.  If not, we can add one.
@@ -1374,6 +1374,8 @@ void Ship::setMove(const Move &move)
 
 // Transmit ship status from server to client
 // Any changes here need to be reflected in Ship::unpackUpdate
+static const U8 EnergyDeltaBits = 8;    // In units of 32 energy, as sent
+
 U32 Ship::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *stream)
 {
    GameConnection *gameConnection = (GameConnection *) connection;
@@ -1434,6 +1436,11 @@ U32 Ship::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *str
    // Send position if this is our intial update or this ship does not represent the client that owns this ship
    bool shouldWritePosition = (updateMask & InitialMask) || gameConnection->getControlObject() != this;
 
+   // Position and energy are coded against the last update the client acked; the reference goes out with
+   // whichever comes first
+   GhostBaseline baseline;
+   bool baselineStarted = false;
+
    if(!shouldWritePosition)
    {
       // The number of writeFlags here *must* match the same number in the else statement
@@ -1449,8 +1456,11 @@ U32 Ship::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *str
          // Send position and speed  ==> use renderPos because that is the server's best guess of where a client-controlled
          //                              ship is at any given moment, even if the server hasn't heard from the client for
          //                              dseveral frames due to network delays.
-         gameConnection->writeCompressedPoint(getRenderPos(), stream);
-         writeCompressedVelocity(getRenderVel(), BoostMaxVelocity + 1, stream);
+         connection->packBaselineReference(stream, baseline);
+         baselineStarted = true;
+
+         writeMovement(connection, baseline, getRenderPos(), getRenderVel(), BoostMaxVelocity + 1,
+                       getPositionQuantization(getInterestTier(connection)), stream);
       }
       if(stream->writeFlag(updateMask & MoveMask))             // <=== TWO
          mCurrentMove.pack(stream, NULL, false);               // Send current move
@@ -1470,7 +1480,13 @@ U32 Ship::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *str
 
    if(gameConnection->mPackUnpackShipEnergyMeter)
    {
-      stream->writeRangedU32(mEnergy >> 5, 0, EnergyMax >> 5);
+      if(!baselineStarted)
+      {
+         connection->packBaselineReference(stream, baseline);
+         baselineStarted = true;
+      }
+
+      writeBaselineValue(stream, baseline, BaselineEnergy, mEnergy >> 5, EnergyDeltaBits);
       stream->writeInt(mFastRechargeTimer.getCurrent() >> 4, 9);
       stream->writeFlag(mCooldownNeeded);
       if(stream->writeFlag(mFireTimer != 0))
@@ -1478,6 +1494,9 @@ U32 Ship::packUpdate(GhostConnection *connection, U32 updateMask, BitStream *str
       stream->writeRangedU32(mLoadout.getActiveWeaponIndex(), 0, ShipWeaponCount);
    }
 
+   if(baselineStarted)
+      connection->recordBaseline(baseline);
+
    return 0;
 }
 
@@ -1504,6 +1523,9 @@ void Ship::unpackUpdate(GhostConnection *connection, BitStream *stream)
    bool wasInitialUpdate = false;
    bool playSpawnEffect  = false;
 
+   GhostBaseline baseline;
+   bool baselineStarted = false;
+
    TNLAssert(isClient(), "We are expecting a ClientGame here!");
 
    if(isInitialUpdate())
@@ -1630,12 +1652,13 @@ void Ship::unpackUpdate(GhostConnection *connection, BitStream *stream)
 
    if(stream->readFlag())     // UpdateMask
    {
-      Point p;
-      ((GameConnection *) connection)->readCompressedPoint(p, stream);
-      Parent::setActualPos(p);
+      connection->unpackBaselineReference(stream, baseline);
+      baselineStarted = true;
 
-      readCompressedVelocity(p, BoostMaxVelocity + 1, stream);
-      Parent::setActualVel(p);
+      Point p, vel;
+      readMovement(connection, baseline, p, vel, BoostMaxVelocity + 1, stream);
+      Parent::setActualPos(p);
+      Parent::setActualVel(vel);
       positionChanged = true;
    }
 
@@ -1697,7 +1720,13 @@ void Ship::unpackUpdate(GhostConnection *connection, BitStream *stream)
 
    if(((GameConnection *)connection)->mPackUnpackShipEnergyMeter)
    {
-      mEnergy = stream->readRangedU32(0, EnergyMax >> 5) << 5;
+      if(!baselineStarted)
+      {
+         connection->unpackBaselineReference(stream, baseline);
+         baselineStarted = true;
+      }
+
+      mEnergy = readBaselineValue(stream, baseline, BaselineEnergy, EnergyDeltaBits) << 5;
       mFastRechargeTimer.reset(stream->readInt(9) << 4, mFastRechargeTimer.getPeriod());
       mCooldownNeeded = stream->readFlag();
       if(stream->readFlag())
@@ -1707,6 +1736,9 @@ void Ship::unpackUpdate(GhostConnection *connection, BitStream *stream)
       setActiveWeapon(stream->readRangedU32(0, ShipWeaponCount));
    }
 
+   if(baselineStarted)
+      connection->recordBaseline(baseline);
+
 #endif
 }  // unpackUpdate
 
@@ -1738,6 +1770,20 @@ F32 Ship::getUpdatePriority(GhostConnection *connection, U32 updateMask, S32 upd
 }
 
 
+U32 Ship::getMovementMask() const
+{
+   return Parent::getMovementMask() | MoveMask;
+}
+
+
+// Other ships' positions feed our collision prediction, so they're kept sharper than most things
+U32 Ship::getPositionQuantization(InterestTier tier) const
+{
+   static const U32 quantization[InterestTierCount] = { 1, 1, 4 };
+   return quantization[tier];
+}
+
+
 void Ship::updateInterpolation()
 {
    Parent::updateInterpolation();
@@ -99,6 +99,10 @@ protected:
    bool processArguments(S32 argc, const char **argv, Level *level);
    string toLevelCode() const;
 
+   enum BaselineSlots {
+      BaselineEnergy = Parent::FirstFreeBaselineSlot,
+   };
+
 public:
    enum MaskBits {
       MoveMask            = Parent::FirstFreeMask << 0, // New user input
@@ -302,6 +306,8 @@ public:
    void updateInterpolation();
 
    F32 getUpdatePriority(GhostConnection *connection, U32 updateMask, S32 updateSkips);
+   U32 getMovementMask() const;
+   U32 getPositionQuantization(InterestTier tier) const;
 
    BfObject *isInZone(U8 zoneType) const; // Return whether the ship is currently in a zone of the specified type, and which one
    BfObject *isInAnyZone() const;         // Return whether the ship is currently in any zone, and which one
@@ -384,6 +384,62 @@ Vector<string> parseString(const string &line)
 }
 
 
+// Splits the first len chars of line into words using the same rules as parseString() above, but without any
+// copying: words are null-terminated in place, and words[i] points into line.  line must have room for a
+// terminator at line[len].
+void parseStringInPlace(char *line, S32 len, Vector<const char *> &words)
+{
+   words.clear();
+
+   S32 i = 0;
+
+   while(true)
+   {
+      while(i < len && isspace((U8)line[i]))
+         i++;
+
+      if(i == len)
+         break;
+
+      S32 start = i;
+
+      while(i < len && !isspace((U8)line[i]))
+         i++;
+
+      S32 end = i;
+
+      if(line[start] == '"')
+      {
+         // If the word doesn't close its own quotes, it runs on to the next quote, or the end of the line
+         if(line[end - 1] != '"')
+         {
+            while(i < len && line[i] != '"')
+               i++;
+
+            end = i;
+
+            if(i < len)
+               i++;        // Skip the closing quote
+         }
+
+         // Strip all quotes from both ends, as trim(item, "\"") does
+         while(end > start && line[end - 1] == '"')
+            end--;
+         while(start < end && line[start] == '"')
+            start++;
+      }
+
+      words.push_back(line + start);
+
+      // Terminating the word may clobber the char we're about to look at next
+      bool atSpace = i < len && i == end;
+      line[end] = 0;
+      if(atSpace)
+         i++;
+   }
+}
+
+
 void parseString(const string &inputString, Vector<string> &words, char seperator)
 {
    parseString(inputString.c_str(), words, seperator);
@@ -62,6 +62,7 @@ string listToString(const Vector<string> &words, const string &seperator);
 Vector<string> parseString(const string &line);
 void parseString(const char *inputString, Vector<string> &words, char seperator = ' ');
 void parseString(const string &inputString, Vector<string> &words, char seperator = ' ');
+void parseStringInPlace(char *line, S32 len, Vector<const char *> &words);
 Vector<string> parseStringAndStripLeadingSlash(const char *str);
 
 void parseComplexStringToMap(const string &inputString, map<string, string> &fillMap,
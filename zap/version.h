@@ -13,13 +13,14 @@
 #define MASTER_PROTOCOL_VERSION 8  // Change this when releasing an incompatible cm/sm protocol (must be int)
                                    // MASTER_PROTOCOL_VERSION = 4, client 015a and older (CS_PROTOCOL_VERSION <= 32) can not connect to our new master.
 
-#define CS_PROTOCOL_VERSION 39     // Change this when releasing an incompatible cs protocol (must be int)
+#define CS_PROTOCOL_VERSION 42     // Change this when releasing an incompatible cs protocol (must be int)
 // 016 = 33 
 // 017[ab] = 35
 // 018[a] = 36
 // 019 dev = 37
 // 019 = 38
 // 020 = 39
+// 021 dev = 40
 
 #define VERSION_016  3737
 #define VERSION_017  4252